@@ -17,6 +17,9 @@
 #	                      build, but which is not part of the library nor is
 #	                      run as tests.
 #
+#	BENCHMARK_SOURCE_FILES Micro-benchmarks of the core kernels. They are
+#	                      only compiled by the 'benchmarks' target.
+#
 #	PUBLIC_HEADER_FILES   List of public header files that should be
 #	                      distributed together with the library. The source
 #	                      files can of course include other files than these;
@@ -98,6 +101,7 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/utility/Event.cpp
         opm/core/utility/MonotCubicInterpolator.cpp
         opm/core/utility/NullStream.cpp
+        opm/core/utility/Profiler.cpp
         opm/core/utility/VelocityInterpolation.cpp
         opm/core/utility/WachspressCoord.cpp
         opm/core/utility/compressedToCartesian.cpp
@@ -130,6 +134,7 @@ list (APPEND TEST_SOURCE_FILES
 	tests/test_cubic.cpp
 	tests/test_event.cpp
 	tests/test_flowdiagnostics.cpp
+	tests/test_tofdiscgal.cpp
 	tests/test_nonuniformtablelinear.cpp
 	tests/test_parallelistlinformation.cpp
 	tests/test_sparsevector.cpp
@@ -151,6 +156,12 @@ list (APPEND TEST_SOURCE_FILES
 	tests/test_wellcollection.cpp
 	tests/test_pinchprocessor.cpp
 	tests/test_anisotropiceikonal.cpp
+	tests/test_small_dense.cpp
+	tests/test_profiler.cpp
+	tests/test_coarse_sys.cpp
+	tests/test_mimetic.cpp
+	tests/test_trans_tpfa.cpp
+	tests/test_transport_reorder.cpp
 	tests/test_stoppedwells.cpp
 	tests/test_relpermdiagnostics.cpp
         tests/test_norne_pvt.cpp
@@ -203,6 +214,10 @@ list (APPEND EXAMPLE_SOURCE_FILES
 	tutorials/tutorial4.cpp
 	)
 
+list (APPEND BENCHMARK_SOURCE_FILES
+	benchmarks/benchmark_kernels.cpp
+	)
+
 # originally generated with the command:
 # find attic -name '*.c*' -printf '\t%p\n' | sort
 list (APPEND ATTIC_FILES
@@ -236,6 +251,7 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/linalg/ParallelIstlInformation.hpp
         opm/core/linalg/blas_lapack.h
         opm/core/linalg/call_umfpack.h
+        opm/core/linalg/small_dense.h
         opm/core/linalg/sparse_sys.h
         opm/core/pressure/CompressibleTpfa.hpp
         opm/core/pressure/FlowBCManager.hpp
@@ -274,6 +290,7 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/props/IncompPropertiesShadow.hpp
         opm/core/props/IncompPropertiesShadow_impl.hpp
         opm/core/props/IncompPropertiesSinglePhase.hpp
+        opm/core/props/ParallelBatch.hpp
         opm/core/props/phaseUsageFromDeck.hpp
         opm/core/props/pvt/PvtPropertiesBasic.hpp
         opm/core/props/pvt/PvtPropertiesIncompFromDeck.hpp
@@ -329,6 +346,7 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/utility/MonotCubicInterpolator.hpp
         opm/core/utility/NonuniformTableLinear.hpp
         opm/core/utility/NullStream.hpp
+        opm/core/utility/Profiler.hpp
         opm/core/utility/RegionMapping.hpp
         opm/core/utility/RootFinders.hpp
         opm/core/utility/SparseVector.hpp
@@ -0,0 +1,537 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Micro-benchmarks of the core kernels on synthetic Cartesian grids.
+//
+// Accepted parameters (defaults):
+//   nx, ny, nz (100, 100, 10)  Grid dimensions.
+//   dx, dy, dz (10, 10, 5)     Cell sizes in meters.
+//   repeats (5)                Timed calls per kernel, after one warm-up call.
+//   kernels ("all")            Comma separated list of kernels to run.
+//   format ("csv")             Output format, "csv" or "json".
+//   output_file ("")           Where to write the results, stdout if empty.
+//
+// For every kernel the program reports the best and mean wall clock
+// time per call, the number of cells processed per second (based on
+// the best time) and the number of C++ heap allocations (operator
+// new) per call. Allocations made with malloc() inside the C kernels
+// are not counted.
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+#include <opm/core/utility/StopWatch.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/parser/eclipse/Units/Units.hpp>
+
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/tpfa/cfs_tpfa_residual.h>
+#include <opm/core/pressure/tpfa/compr_quant_general.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/transport/reorder/TransportSolverTwophaseReorder.hpp>
+#include <opm/core/flowdiagnostics/TofReorder.hpp>
+#include <opm/core/props/IncompPropertiesBasic.hpp>
+#include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
+#include <opm/core/simulator/BlackoilState.hpp>
+#include <opm/core/simulator/TwophaseState.hpp>
+#include <opm/core/simulator/initStateEquil.hpp>
+
+#if HAVE_DUNE_ISTL
+#include <opm/core/linalg/LinearSolverIstl.hpp>
+#endif
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseContext.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// ----------------- Allocation counting -----------------
+
+namespace
+{
+    std::atomic<long> num_allocations(0);
+}
+
+void* operator new(std::size_t size)
+{
+    ++num_allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+
+namespace
+{
+    struct BenchmarkResult
+    {
+        std::string kernel;
+        int cells;
+        int repeats;
+        double best_time;
+        double mean_time;
+        double allocs_per_call;
+    };
+
+    // Run 'kernel' once to warm up, then 'repeats' timed times.
+    // If given, 'prepare' is called untimed before every call.
+    BenchmarkResult runBenchmark(const std::string& name,
+                                 const int cells,
+                                 const int repeats,
+                                 const std::function<void()>& kernel,
+                                 const std::function<void()>& prepare = std::function<void()>())
+    {
+        if (prepare) {
+            prepare();
+        }
+        kernel();
+
+        BenchmarkResult result = { name, cells, repeats,
+                                   std::numeric_limits<double>::max(), 0.0, 0.0 };
+        long allocs = 0;
+        for (int r = 0; r < repeats; ++r) {
+            if (prepare) {
+                prepare();
+            }
+            const long allocs_before = num_allocations;
+            Opm::time::StopWatch clock;
+            clock.start();
+            kernel();
+            clock.stop();
+            allocs += num_allocations - allocs_before;
+            const double t = clock.secsSinceStart();
+            result.best_time = std::min(result.best_time, t);
+            result.mean_time += t/repeats;
+        }
+        result.allocs_per_call = double(allocs)/repeats;
+        return result;
+    }
+
+
+    void writeResults(const std::vector<BenchmarkResult>& results,
+                      const std::string& format,
+                      std::ostream& os)
+    {
+        os.precision(6);
+        if (format == "json") {
+            os << "[\n";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const BenchmarkResult& r = results[i];
+                os << "  { \"kernel\": \"" << r.kernel << "\""
+                   << ", \"cells\": " << r.cells
+                   << ", \"repeats\": " << r.repeats
+                   << ", \"best_seconds\": " << r.best_time
+                   << ", \"mean_seconds\": " << r.mean_time
+                   << ", \"cells_per_second\": " << r.cells/r.best_time
+                   << ", \"allocs_per_call\": " << r.allocs_per_call
+                   << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+            }
+            os << "]\n";
+        } else {
+            os << "kernel,cells,repeats,best_seconds,mean_seconds,cells_per_second,allocs_per_call\n";
+            for (const BenchmarkResult& r : results) {
+                os << r.kernel << ',' << r.cells << ',' << r.repeats << ','
+                   << r.best_time << ',' << r.mean_time << ','
+                   << r.cells/r.best_time << ',' << r.allocs_per_call << '\n';
+            }
+        }
+    }
+
+
+    // Three-phase dead-oil deck matching a GridManager(nx, ny, nz,
+    // dx, dy, dz) grid, with the gas-oil contact at a quarter and
+    // the oil-water contact at three quarters of the height.
+    std::string syntheticDeck(const int nx, const int ny, const int nz,
+                              const double dx, const double dy, const double dz)
+    {
+        const int nc = nx*ny*nz;
+        const double height = nz*dz;
+        std::ostringstream deck;
+        deck << "RUNSPEC\n"
+             << "WATER\nOIL\nGAS\n"
+             << "DIMENS\n" << nx << ' ' << ny << ' ' << nz << " /\n"
+             << "TABDIMS\n 1 1 40 20 1 20 /\n"
+             << "EQLDIMS\n 1 /\n"
+             << "GRID\n"
+             << "DXV\n" << nx << '*' << dx << " /\n"
+             << "DYV\n" << ny << '*' << dy << " /\n"
+             << "DZV\n" << nz << '*' << dz << " /\n"
+             << "DEPTHZ\n" << (nx + 1)*(ny + 1) << "*0.0 /\n"
+             << "PORO\n" << nc << "*0.2 /\n"
+             << "PERMX\n" << nc << "*100 /\n"
+             << "PERMY\n" << nc << "*100 /\n"
+             << "PERMZ\n" << nc << "*10 /\n"
+             << "PROPS\n"
+             << "PVDO\n100 1.0 1.0\n200 0.98 1.0\n300 0.96 1.0\n/\n"
+             << "PVDG\n100 0.05 0.01\n200 0.02 0.02\n300 0.01 0.03\n/\n"
+             << "PVTW\n200 1.0 4.0E-5 0.5 0.0 /\n"
+             << "DENSITY\n700 1000 1 /\n";
+        // Corey type tables with 21 points each.
+        const int n = 21;
+        deck << "SWOF\n";
+        for (int i = 0; i < n; ++i) {
+            const double sw = 0.2 + 0.8*i/(n - 1);
+            const double swn = (sw - 0.2)/0.8;
+            deck << sw << ' ' << swn*swn << ' ' << (1.0 - swn)*(1.0 - swn) << " 0\n";
+        }
+        deck << "/\nSGOF\n";
+        for (int i = 0; i < n; ++i) {
+            const double sg = 0.8*i/(n - 1);
+            const double sgn = sg/0.8;
+            deck << sg << ' ' << sgn*sgn << ' ' << (1.0 - sgn)*(1.0 - sgn) << " 0\n";
+        }
+        deck << "/\n"
+             << "SOLUTION\n"
+             << "EQUIL\n" << 0.5*height << " 200 " << 0.75*height << " 0 "
+             << 0.25*height << " 0 1* 1* 0 /\n"
+             << "SCHEDULE\n";
+        return deck.str();
+    }
+
+
+    // Face fluxes of a steady flow field that is divergence free in
+    // the interior of the grid: uniform in x in each row of cells, with
+    // a row dependent rate, and a weaker uniform flow in y.  The
+    // corresponding sources (positive for injection) are placed in
+    // the boundary cells.
+    void syntheticFlow(const UnstructuredGrid& grid,
+                       const int nx, const int ny,
+                       std::vector<double>& flux,
+                       std::vector<double>& src)
+    {
+        const int nc = grid.number_of_cells;
+        flux.assign(grid.number_of_faces, 0.0);
+        src.assign(nc, 0.0);
+        const double qx = 1.0e-3;
+        const double qy = 2.0e-4;
+        for (int c = 0; c < nc; ++c) {
+            const int i = c % nx;
+            const int j = (c / nx) % ny;
+            const double rate_x = qx*(1.0 + 0.5*std::sin(0.7*j));
+            if (i == 0)      { src[c] += rate_x; }
+            if (i == nx - 1) { src[c] -= rate_x; }
+            if (j == 0)      { src[c] += qy; }
+            if (j == ny - 1) { src[c] -= qy; }
+            for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                const int c1 = grid.face_cells[2*f + 1];
+                if (grid.face_cells[2*f] != c || c1 < 0) {
+                    continue;
+                }
+                if (c1 == c + 1) {
+                    flux[f] = rate_x;
+                } else if (c1 == c + nx) {
+                    flux[f] = qy;
+                }
+            }
+        }
+    }
+
+
+    bool wanted(const std::string& kernels, const std::string& name)
+    {
+        if (kernels == "all") {
+            return true;
+        }
+        std::istringstream is(kernels);
+        std::string k;
+        while (std::getline(is, k, ',')) {
+            if (k == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+} // anon namespace
+
+
+
+// ----------------- Main program -----------------
+int
+main(int argc, char** argv)
+try
+{
+    using namespace Opm;
+
+    parameter::ParameterGroup param(argc, argv);
+    const int nx = param.getDefault("nx", 100);
+    const int ny = param.getDefault("ny", 100);
+    const int nz = param.getDefault("nz", 10);
+    const double dx = param.getDefault("dx", 10.0);
+    const double dy = param.getDefault("dy", 10.0);
+    const double dz = param.getDefault("dz", 5.0);
+    const int repeats = param.getDefault("repeats", 5);
+    const std::string kernels = param.getDefault<std::string>("kernels", "all");
+    const std::string format = param.getDefault<std::string>("format", "csv");
+    const std::string output_file = param.getDefault<std::string>("output_file", "");
+    if (format != "csv" && format != "json") {
+        OPM_THROW(std::runtime_error, "Unknown output format " << format << ", use csv or json.");
+    }
+
+    GridManager grid_manager(nx, ny, nz, dx, dy, dz);
+    UnstructuredGrid& grid = *const_cast<UnstructuredGrid*>(grid_manager.c_grid());
+    const int nc = grid.number_of_cells;
+    const int nf = grid.number_of_faces;
+    const int dim = grid.dimensions;
+
+    // Heterogeneous diagonal permeability and the derived
+    // transmissibilities, shared by the pressure kernels.
+    std::vector<double> perm(nc*dim*dim, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        const double k = 100.0*prefix::milli*unit::darcy*std::exp(std::sin(0.37*c));
+        for (int d = 0; d < dim; ++d) {
+            perm[c*dim*dim + d*(dim + 1)] = (d == dim - 1) ? 0.1*k : k;
+        }
+    }
+    std::vector<double> htrans(grid.cell_facepos[nc]);
+    std::vector<double> trans(nf);
+    tpfa_htrans_compute(&grid, perm.data(), htrans.data());
+    tpfa_trans_compute(&grid, htrans.data(), trans.data());
+
+    std::vector<double> porevol(nc);
+    for (int c = 0; c < nc; ++c) {
+        porevol[c] = 0.2*grid.cell_volumes[c];
+    }
+    std::vector<double> flux;
+    std::vector<double> src;
+    syntheticFlow(grid, nx, ny, flux, src);
+
+    std::vector<BenchmarkResult> results;
+
+    // ifs_tpfa_assemble(), and solving the resulting system.
+    if (wanted(kernels, "ifs_tpfa_assemble") || wanted(kernels, "linsolver_istl")) {
+        std::shared_ptr<ifs_tpfa_data> h(ifs_tpfa_construct(&grid, NULL), ifs_tpfa_destroy);
+        if (!h) {
+            OPM_THROW(std::runtime_error, "Failed to construct ifs_tpfa assembler.");
+        }
+        const std::vector<double> totmob(nc, 1.0);
+        const std::vector<double> gpress(grid.cell_facepos[nc], 0.0);
+        ifs_tpfa_forces forces = { src.data(), NULL, NULL, totmob.data(), NULL };
+        auto assemble = [&]() {
+            ifs_tpfa_assemble(&grid, &forces, trans.data(), gpress.data(), h.get());
+        };
+        if (wanted(kernels, "ifs_tpfa_assemble")) {
+            results.push_back(runBenchmark("ifs_tpfa_assemble", nc, repeats, assemble));
+        }
+#if HAVE_DUNE_ISTL
+        if (wanted(kernels, "linsolver_istl")) {
+            assemble();
+            LinearSolverIstl linsolver(param);
+            auto solve = [&]() {
+                linsolver.solve(h->A, h->b, h->x);
+            };
+            auto reset = [&]() {
+                std::fill(h->x, h->x + h->A->m, 0.0);
+            };
+            results.push_back(runBenchmark("linsolver_istl", nc, repeats, solve, reset));
+        }
+#endif
+    }
+
+    // cfs_tpfa_res_assemble(), two phases, no wells.
+    if (wanted(kernels, "cfs_tpfa_res_assemble")) {
+        const int np = 2;
+        std::shared_ptr<cfs_tpfa_res_data> h(cfs_tpfa_res_construct(&grid, NULL, np),
+                                             cfs_tpfa_res_destroy);
+        std::shared_ptr<compr_quantities_gen> cq(compr_quantities_gen_allocate(nc, nf, np),
+                                                 compr_quantities_gen_deallocate);
+        if (!h || !cq) {
+            OPM_THROW(std::runtime_error, "Failed to construct cfs_tpfa_res assembler.");
+        }
+        for (int c = 0; c < nc; ++c) {
+            for (int i = 0; i < np*np; ++i) {
+                const bool diag = (i % (np + 1)) == 0;
+                cq->Ac [c*np*np + i] = diag ? 1.0 + 0.01*std::sin(0.1*c) : 0.0;
+                cq->dAc[c*np*np + i] = diag ? 1.0e-9 : 0.0;
+            }
+            cq->voldiscr[c] = 0.0;
+        }
+        for (int f = 0; f < nf; ++f) {
+            for (int i = 0; i < np*np; ++i) {
+                cq->Af[f*np*np + i] = (i % (np + 1)) == 0 ? 1.0 : 0.0;
+            }
+            cq->phasemobf[f*np + 0] = 0.6e3;
+            cq->phasemobf[f*np + 1] = 0.4e3;
+        }
+        const std::vector<double> zc(nc*np, 0.5);
+        const std::vector<double> gravcap_f(nf*np, 0.0);
+        const std::vector<double> cpress(nc, 200.0*unit::barsa);
+        cfs_tpfa_res_forces forces = { NULL, NULL };
+        auto assemble = [&]() {
+            cfs_tpfa_res_assemble(&grid, unit::day, &forces, zc.data(), cq.get(),
+                                  trans.data(), gravcap_f.data(), cpress.data(),
+                                  NULL, porevol.data(), h.get());
+        };
+        results.push_back(runBenchmark("cfs_tpfa_res_assemble", nc, repeats, assemble));
+    }
+
+    // compute_sequence(), Tarjan's algorithm on the upwind graph.
+    if (wanted(kernels, "compute_sequence")) {
+        std::vector<int> sequence(nc);
+        std::vector<int> components(nc + 1);
+        int ncomponents = 0;
+        auto order = [&]() {
+            compute_sequence(&grid, flux.data(), sequence.data(),
+                             components.data(), &ncomponents);
+        };
+        results.push_back(runBenchmark("compute_sequence", nc, repeats, order));
+    }
+
+    // TofReorder::solveTof() and solveTofTracer().
+    if (wanted(kernels, "tof_reorder") || wanted(kernels, "tof_reorder_tracer")) {
+        TofReorder tofsolver(grid);
+        std::vector<double> tof;
+        std::vector<double> tracer;
+        if (wanted(kernels, "tof_reorder")) {
+            auto solve = [&]() {
+                tofsolver.solveTof(flux.data(), porevol.data(), src.data(), tof);
+            };
+            results.push_back(runBenchmark("tof_reorder", nc, repeats, solve));
+        }
+        if (wanted(kernels, "tof_reorder_tracer")) {
+            // One tracer for each half of the injecting x == 0 side.
+            std::vector<int> heads[2];
+            for (int c = 0; c < nc; c += nx) {
+                heads[((c / nx) % ny) < ny/2 ? 0 : 1].push_back(c);
+            }
+            SparseTable<int> tracerheads;
+            for (int t = 0; t < 2; ++t) {
+                tracerheads.appendRow(heads[t].begin(), heads[t].end());
+            }
+            auto solve = [&]() {
+                tofsolver.solveTofTracer(flux.data(), porevol.data(), src.data(),
+                                         tracerheads, tof, tracer);
+            };
+            results.push_back(runBenchmark("tof_reorder_tracer", nc, repeats, solve));
+        }
+    }
+
+    // TransportSolverTwophaseReorder::solve(), water injected through
+    // the positive sources into an oil filled reservoir.
+    if (wanted(kernels, "transport_twophase_reorder")) {
+        const std::vector<double> rho = { 1000.0, 800.0 };
+        const std::vector<double> mu = { 1.0*prefix::centi*unit::Poise, 5.0*prefix::centi*unit::Poise };
+        IncompPropertiesBasic props(2, SaturationPropsBasic::Quadratic, rho, mu,
+                                    0.2, 100.0*prefix::milli*unit::darcy, dim, nc);
+        TransportSolverTwophaseReorder tsolver(grid, props, NULL, 1e-9, 30);
+        TwophaseState state(nc, nf);
+        state.faceflux() = flux;
+        const double dt = 10.0*unit::day;
+        auto solve = [&]() {
+            tsolver.solve(porevol.data(), src.data(), dt, state);
+        };
+        auto reset = [&]() {
+            for (int c = 0; c < nc; ++c) {
+                state.saturation()[2*c + 0] = 0.0;
+                state.saturation()[2*c + 1] = 1.0;
+            }
+        };
+        results.push_back(runBenchmark("transport_twophase_reorder", nc, repeats, solve, reset));
+    }
+
+    // Deck based kernels: SaturationPropsFromDeck::relperm(), through
+    // the black-oil properties, and initStateEquil().
+    if (wanted(kernels, "satprops_relperm") || wanted(kernels, "init_state_equil")) {
+        Parser parser;
+        ParseContext parse_context;
+        const Deck deck = parser.parseString(syntheticDeck(nx, ny, nz, dx, dy, dz), parse_context);
+        const EclipseState eclipse_state(deck, parse_context);
+        BlackoilPropertiesFromDeck props(deck, eclipse_state, grid, false);
+        const int np = props.numPhases();
+
+        if (wanted(kernels, "satprops_relperm")) {
+            std::vector<int> cells(nc);
+            std::vector<double> s(nc*np);
+            for (int c = 0; c < nc; ++c) {
+                cells[c] = c;
+                const double sw = 0.2 + 0.6*(c % 97)/96.0;
+                const double sg = 0.1*(1.0 - sw);
+                s[np*c + 0] = sw;
+                s[np*c + 1] = 1.0 - sw - sg;
+                s[np*c + 2] = sg;
+            }
+            std::vector<double> kr(nc*np);
+            std::vector<double> dkrds(nc*np*np);
+            auto evaluate = [&]() {
+                props.relperm(nc, s.data(), cells.data(), kr.data(), dkrds.data());
+            };
+            results.push_back(runBenchmark("satprops_relperm", nc, repeats, evaluate));
+        }
+
+        if (wanted(kernels, "init_state_equil")) {
+            BlackoilState state(nc, nf, np);
+            auto initialise = [&]() {
+                initStateEquil(grid, props, deck, eclipse_state, unit::gravity, state);
+            };
+            results.push_back(runBenchmark("init_state_equil", nc, repeats, initialise));
+        }
+    }
+
+    if (output_file.empty()) {
+        writeResults(results, format, std::cout);
+    } else {
+        std::ofstream os(output_file.c_str());
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Failed to open " << output_file);
+        }
+        writeResults(results, format, os);
+    }
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
@@ -22,13 +22,19 @@
 #include <opm/core/grid.h>
 #include <opm/core/utility/RootFinders.hpp>
 
-#if BOOST_HEAP_AVAILABLE
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
 
 namespace Opm
 {
 
     namespace
     {
+        /// Arity of the heap of considered cells.
+        const int heap_arity = 4;
+
         /// Euclidean (isotropic) distance.
         double distanceIso(const double v1[2],
                            const double v2[2])
@@ -70,6 +76,7 @@ namespace Opm
         cell_neighbours_ = cellNeighboursAcrossVertices(grid);
         orderCounterClockwise(grid, cell_neighbours_);
         computeGridRadius();
+        computeBuckets();
     }
 
     /// Solve the eikonal equation.
@@ -108,11 +115,11 @@ namespace Opm
         solution.resize(num_cells, inf);
         is_accepted_.clear();
         is_accepted_.resize(num_cells, false);
-        accepted_front_.clear();
+        is_front_.clear();
+        is_front_.resize(num_cells, false);
         considered_.clear();
-        considered_handles_.clear();
-        is_considered_.clear();
-        is_considered_.resize(num_cells, false);
+        heap_pos_.clear();
+        heap_pos_.resize(num_cells, -1);
 
         // 2. Move the startcells to Accepted. U_i = q(x_i)
         const int num_startcells = startcells.size();
@@ -120,7 +127,9 @@ namespace Opm
             is_accepted_[startcells[ii]] = true;
             solution[startcells[ii]] = 0.0;
         }
-        accepted_front_.insert(startcells.begin(), startcells.end());
+        for (int ii = 0; ii < num_startcells; ++ii) {
+            acceptCell(startcells[ii]);
+        }
 
         // 3. Move cells adjacent to startcells to Considered, evaluate
         //    U_i = min_{(x_j,x_k) \in NF(x_i)} G_{j,k}
@@ -129,7 +138,7 @@ namespace Opm
             const int num_nb = cell_neighbours_[scell].size();
             for (int nb = 0; nb < num_nb; ++nb) {
                 const int nb_cell = cell_neighbours_[scell][nb];
-                if (!is_accepted_[nb_cell] && !is_considered_[nb_cell]) {
+                if (!is_accepted_[nb_cell] && !isConsidered(nb_cell)) {
                     const double value = computeValue(nb_cell, metric, solution.data());
                     pushConsidered(std::make_pair(value, nb_cell));
                 }
@@ -146,45 +155,24 @@ namespace Opm
             is_accepted_[rcell] = true;
             solution[rcell] = r.first;
             popConsidered();
-            accepted_front_.insert(rcell);
-            for (auto it = accepted_front_.begin(); it != accepted_front_.end();) {
-                // Note that loop increment happens in the body of this loop.
-                const int cell = *it;
-                bool on_front = false;
-                for (auto it2 = cell_neighbours_[cell].begin(); it2 != cell_neighbours_[cell].end(); ++it2) {
-                    if (!is_accepted_[*it2]) {
-                        on_front = true;
-                        break;
-                    }
-                }
-                if (!on_front) {
-                    accepted_front_.erase(it++);
-                } else {
-                    ++it;
-                }
-            }
+            acceptCell(rcell);
 
             // 6. Recompute the value for all Considered cells within
             //    distance h * F_2/F1 from x_r. Use min of previous and new.
-            for (auto it = considered_.begin(); it != considered_.end(); ++it) {
-                const int ccell = it->second;
-                if (isClose(rcell, ccell)) {
-                    const double value = computeValueUpdate(ccell, metric, solution.data(), rcell);
-                    if (value < it->first) {
-                        // Update value for considered cell.
-                        // Note that as solution values decrease, their
-                        // goodness w.r.t. the heap comparator increase,
-                        // therefore we may safely call the increase()
-                        // modificator below.
-                        considered_.increase(considered_handles_[ccell], std::make_pair(value, ccell));
+            forEachCloseCell(rcell, [&](const int ccell) {
+                    if (isConsidered(ccell)) {
+                        const double value = computeValueUpdate(ccell, metric, solution.data(), rcell);
+                        if (value < considered_[heap_pos_[ccell]].first) {
+                            // Update value for considered cell.
+                            decreaseConsidered(std::make_pair(value, ccell));
+                        }
                     }
-                }
-            }
+                });
 
             // 7. Move cells adjacent to r from Far to Considered.
             for (auto it = cell_neighbours_[rcell].begin(); it != cell_neighbours_[rcell].end(); ++it) {
                 const int nb_cell = *it;
-                if (!is_accepted_[nb_cell] && !is_considered_[nb_cell]) {
+                if (!is_accepted_[nb_cell] && !isConsidered(nb_cell)) {
                     assert(solution[nb_cell] == inf);
                     const double value = computeValue(nb_cell, metric, solution.data());
                     pushConsidered(std::make_pair(value, nb_cell));
@@ -200,6 +188,63 @@ namespace Opm
 
 
 
+    void AnisotropicEikonal2d::acceptCell(const int cell)
+    {
+        // Only the newly accepted cell and its neighbours may change
+        // their front status: a cell is on the front if it has a
+        // non-accepted neighbour.
+        auto hasFarNeighbour = [&](const int c) {
+            for (auto it = cell_neighbours_[c].begin(); it != cell_neighbours_[c].end(); ++it) {
+                if (!is_accepted_[*it]) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        assert(is_accepted_[cell]);
+        is_front_[cell] = hasFarNeighbour(cell);
+        for (auto it = cell_neighbours_[cell].begin(); it != cell_neighbours_[cell].end(); ++it) {
+            if (is_front_[*it] && !hasFarNeighbour(*it)) {
+                is_front_[*it] = false;
+            }
+        }
+    }
+
+
+
+
+
+    template <class Op>
+    void AnisotropicEikonal2d::forEachCloseCell(const int cell, Op op) const
+    {
+        // Visit all buckets overlapping the square enclosing the
+        // disc of cells that isClose() may accept.
+        const double* x = grid_.cell_centroids + 2*cell;
+        const double radius = safety_factor_ * aniso_ratio_[cell] * grid_radius_[cell];
+        int lo[2], hi[2];
+        for (int dd = 0; dd < 2; ++dd) {
+            const double min_b = std::floor((x[dd] - radius - bucket_origin_[dd]) / bucket_size_);
+            const double max_b = std::floor((x[dd] + radius - bucket_origin_[dd]) / bucket_size_);
+            lo[dd] = int(std::max(min_b, 0.0));
+            hi[dd] = int(std::min(max_b, double(bucket_dims_[dd] - 1)));
+        }
+        for (int j = lo[1]; j <= hi[1]; ++j) {
+            for (int i = lo[0]; i <= hi[0]; ++i) {
+                const int bucket = i + bucket_dims_[0]*j;
+                for (int b = bucket_start_[bucket]; b < bucket_start_[bucket + 1]; ++b) {
+                    const int other = bucket_cells_[b];
+                    if (other != cell && isClose(cell, other)) {
+                        op(other);
+                    }
+                }
+            }
+        }
+    }
+
+
+
+
+
     bool AnisotropicEikonal2d::isClose(const int c1,
                                        const int c2) const
     {
@@ -223,7 +268,7 @@ namespace Opm
         double val = inf;
         for (int ii = 0; ii < num_nbs; ++ii) {
             const int n[2] = { nbs[ii], nbs[(ii+1) % num_nbs] };
-            if (accepted_front_.count(n[0]) && accepted_front_.count(n[1])) {
+            if (is_front_[n[0]] && is_front_[n[1]]) {
                 const double cand_val = computeFromTri(cell, n[0], n[1], metric, solution);
                 val = std::min(val, cand_val);
             }
@@ -232,7 +277,7 @@ namespace Opm
             // Failed to find two accepted front nodes adjacent to this,
             // so we go for a single-neighbour update.
             for (int ii = 0; ii < num_nbs; ++ii) {
-                if (accepted_front_.count(nbs[ii])) {
+                if (is_front_[nbs[ii]]) {
                     const double cand_val = computeFromLine(cell, nbs[ii], metric, solution);
                     val = std::min(val, cand_val);
                 }
@@ -260,7 +305,7 @@ namespace Opm
         for (int ii = 0; ii < num_nbs; ++ii) {
             const int n[2] = { nbs[ii], nbs[(ii+1) % num_nbs] };
             if ((n[0] == new_cell || n[1] == new_cell)
-                && accepted_front_.count(n[0]) && accepted_front_.count(n[1])) {
+                && is_front_[n[0]] && is_front_[n[1]]) {
                 const double cand_val = computeFromTri(cell, n[0], n[1], metric, solution);
                 val = std::min(val, cand_val);
             }
@@ -269,7 +314,7 @@ namespace Opm
             // Failed to find two accepted front nodes adjacent to this,
             // so we go for a single-neighbour update.
             for (int ii = 0; ii < num_nbs; ++ii) {
-                if (nbs[ii] == new_cell && accepted_front_.count(nbs[ii])) {
+                if (nbs[ii] == new_cell && is_front_[nbs[ii]]) {
                     const double cand_val = computeFromLine(cell, nbs[ii], metric, solution);
                     val = std::min(val, cand_val);
                 }
@@ -357,9 +402,18 @@ namespace Opm
 
 
 
+    bool AnisotropicEikonal2d::isConsidered(const int cell) const
+    {
+        return heap_pos_[cell] >= 0;
+    }
+
+
+
+
+
     const AnisotropicEikonal2d::ValueAndCell& AnisotropicEikonal2d::topConsidered() const
     {
-        return considered_.top();
+        return considered_.front();
     }
 
 
@@ -368,9 +422,9 @@ namespace Opm
 
     void AnisotropicEikonal2d::pushConsidered(const ValueAndCell& vc)
     {
-        HeapHandle h = considered_.push(vc);
-        considered_handles_[vc.second] = h;
-        is_considered_[vc.second] = true;
+        considered_.push_back(vc);
+        heap_pos_[vc.second] = considered_.size() - 1;
+        heapSiftUp(considered_.size() - 1);
     }
 
 
@@ -379,9 +433,85 @@ namespace Opm
 
     void AnisotropicEikonal2d::popConsidered()
     {
-        is_considered_[considered_.top().second] = false;
-        considered_handles_.erase(considered_.top().second);
-        considered_.pop();
+        heap_pos_[considered_.front().second] = -1;
+        const ValueAndCell last = considered_.back();
+        considered_.pop_back();
+        if (!considered_.empty()) {
+            heapPlace(0, last);
+            heapSiftDown(0);
+        }
+    }
+
+
+
+
+
+    void AnisotropicEikonal2d::decreaseConsidered(const ValueAndCell& vc)
+    {
+        // As solution values decrease, the cell can only move
+        // towards the top of the heap.
+        const int pos = heap_pos_[vc.second];
+        assert(pos >= 0);
+        assert(!(considered_[pos] < vc));
+        heapPlace(pos, vc);
+        heapSiftUp(pos);
+    }
+
+
+
+
+
+    void AnisotropicEikonal2d::heapSiftUp(int pos)
+    {
+        const ValueAndCell vc = considered_[pos];
+        while (pos > 0) {
+            const int parent = (pos - 1) / heap_arity;
+            if (!(vc < considered_[parent])) {
+                break;
+            }
+            heapPlace(pos, considered_[parent]);
+            pos = parent;
+        }
+        heapPlace(pos, vc);
+    }
+
+
+
+
+
+    void AnisotropicEikonal2d::heapSiftDown(int pos)
+    {
+        const ValueAndCell vc = considered_[pos];
+        const int size = considered_.size();
+        for (;;) {
+            const int first = heap_arity*pos + 1;
+            if (first >= size) {
+                break;
+            }
+            const int last = std::min(first + heap_arity, size);
+            int best = first;
+            for (int child = first + 1; child < last; ++child) {
+                if (considered_[child] < considered_[best]) {
+                    best = child;
+                }
+            }
+            if (!(considered_[best] < vc)) {
+                break;
+            }
+            heapPlace(pos, considered_[best]);
+            pos = best;
+        }
+        heapPlace(pos, vc);
+    }
+
+
+
+
+
+    void AnisotropicEikonal2d::heapPlace(const int pos, const ValueAndCell& vc)
+    {
+        considered_[pos] = vc;
+        heap_pos_[vc.second] = pos;
     }
 
 
@@ -426,36 +556,63 @@ namespace Opm
 
 
 
-} // namespace Opm
-
+    void AnisotropicEikonal2d::computeBuckets()
+    {
+        // Bucket size is the average grid radius, so that a bucket
+        // holds O(1) cells, enlarged if needed to keep the number of
+        // buckets proportional to the number of cells.
+        const int num_cells = grid_.number_of_cells;
+        double lo[2] = { 0.0, 0.0 };
+        double hi[2] = { 0.0, 0.0 };
+        double sum_radius = 0.0;
+        for (int cell = 0; cell < num_cells; ++cell) {
+            const double* x = grid_.cell_centroids + 2*cell;
+            for (int dd = 0; dd < 2; ++dd) {
+                lo[dd] = (cell == 0) ? x[dd] : std::min(lo[dd], x[dd]);
+                hi[dd] = (cell == 0) ? x[dd] : std::max(hi[dd], x[dd]);
+            }
+            sum_radius += grid_radius_[cell];
+        }
+        bucket_size_ = num_cells > 0 ? sum_radius / num_cells : 0.0;
+        if (bucket_size_ <= 0.0) {
+            bucket_size_ = std::max(std::max(hi[0] - lo[0], hi[1] - lo[1]), 1.0);
+        }
+        for (;;) {
+            for (int dd = 0; dd < 2; ++dd) {
+                bucket_dims_[dd] = int(std::floor((hi[dd] - lo[dd]) / bucket_size_)) + 1;
+            }
+            if (double(bucket_dims_[0]) * double(bucket_dims_[1]) <= 4.0*num_cells + 16.0) {
+                break;
+            }
+            bucket_size_ *= 2.0;
+        }
+        bucket_origin_[0] = lo[0];
+        bucket_origin_[1] = lo[1];
 
-#else // BOOST_HEAP_AVAILABLE is false
+        // Sort cells into buckets (counting sort).
+        const int num_buckets = bucket_dims_[0] * bucket_dims_[1];
+        std::vector<int> cell_bucket(num_cells);
+        bucket_start_.assign(num_buckets + 1, 0);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            const double* x = grid_.cell_centroids + 2*cell;
+            int ib[2];
+            for (int dd = 0; dd < 2; ++dd) {
+                ib[dd] = int(std::floor((x[dd] - lo[dd]) / bucket_size_));
+                ib[dd] = std::max(0, std::min(ib[dd], bucket_dims_[dd] - 1));
+            }
+            cell_bucket[cell] = ib[0] + bucket_dims_[0]*ib[1];
+            ++bucket_start_[cell_bucket[cell] + 1];
+        }
+        std::partial_sum(bucket_start_.begin(), bucket_start_.end(), bucket_start_.begin());
+        bucket_cells_.resize(num_cells);
+        std::vector<int> fill(bucket_start_.begin(), bucket_start_.end() - 1);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            bucket_cells_[fill[cell_bucket[cell]]++] = cell;
+        }
+    }
 
-namespace {
-    const char* AnisotropicEikonal2derrmsg =
-        "\n********************************************************************************\n"
-        "This library has not been compiled with support for the AnisotropicEikonal2d\n"
-        "class, due to too old version of the boost libraries (Boost.Heap from boost\n"
-        "version 1.49 or newer is required.\n"
-        "To use this class you must recompile opm-core on a system with sufficiently new\n"
-        "version of the boost libraries."
-        "\n********************************************************************************\n";
-}
 
-namespace Opm
-{
 
-    AnisotropicEikonal2d::AnisotropicEikonal2d(const UnstructuredGrid&)
-    {
-        OPM_THROW(std::logic_error, AnisotropicEikonal2derrmsg);
-    }
 
-    void AnisotropicEikonal2d::solve(const double*,
-                                     const std::vector<int>&,
-                                     std::vector<double>&)
-    {
-        OPM_THROW(std::logic_error, AnisotropicEikonal2derrmsg);
-    }
-}
 
-#endif // BOOST_HEAP_AVAILABLE
+} // namespace Opm
@@ -22,20 +22,7 @@
 
 #include <opm/core/utility/SparseTable.hpp>
 #include <vector>
-#include <set>
-#include <map>
-
-#include <opm/common/utility/platform_dependent/disable_warnings.h>
-
-#include <boost/version.hpp>
-
-#define BOOST_HEAP_AVAILABLE ((BOOST_VERSION / 100 % 1000) >= 49)
-
-#if BOOST_HEAP_AVAILABLE
-#include <boost/heap/fibonacci_heap.hpp>
-#endif
-
-#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+#include <utility>
 
 
 struct UnstructuredGrid;
@@ -62,28 +49,34 @@ namespace Opm
                    const std::vector<int>& startcells,
                    std::vector<double>& solution);
     private:
-#if BOOST_HEAP_AVAILABLE
         // Grid and topology.
         const UnstructuredGrid& grid_;
         SparseTable<int> cell_neighbours_;
 
-        // Keep track of accepted cells.
+        // Keep track of accepted cells. A cell is on the accepted
+        // front if it is accepted and has a non-accepted neighbour.
         std::vector<char> is_accepted_;
-        std::set<int> accepted_front_;
+        std::vector<char> is_front_;
 
         // Quantities relating to anisotropy.
         std::vector<double> grid_radius_;
         std::vector<double> aniso_ratio_;
         const double safety_factor_;
 
-        // Keep track of considered cells.
+        // Cells bucketed by centroid in a uniform grid of square
+        // buckets, for finding the cells close to a given cell.
+        double bucket_origin_[2];
+        double bucket_size_;
+        int bucket_dims_[2];
+        std::vector<int> bucket_start_;  // size = #buckets + 1
+        std::vector<int> bucket_cells_;  // size = #cells
+
+        // Keep track of considered cells, using an indexed d-ary
+        // min-heap. heap_pos_[cell] is the position of cell in
+        // considered_, or -1 if it is not considered.
         typedef std::pair<double, int> ValueAndCell;
-        typedef boost::heap::compare<std::greater<ValueAndCell>> Comparator;
-        typedef boost::heap::fibonacci_heap<ValueAndCell, Comparator> Heap;
-        Heap considered_;
-        typedef Heap::handle_type HeapHandle;
-        std::map<int, HeapHandle> considered_handles_;
-        std::vector<char> is_considered_;
+        std::vector<ValueAndCell> considered_;
+        std::vector<int> heap_pos_;
 
         bool isClose(const int c1, const int c2) const;
         double computeValue(const int cell, const double* metric, const double* solution) const;
@@ -91,13 +84,22 @@ namespace Opm
         double computeFromLine(const int cell, const int from, const double* metric, const double* solution) const;
         double computeFromTri(const int cell, const int n0, const int n1, const double* metric, const double* solution) const;
 
+        void acceptCell(const int cell);
+        template <class Op>
+        void forEachCloseCell(const int cell, Op op) const;
+
+        bool isConsidered(const int cell) const;
         const ValueAndCell& topConsidered() const;
         void pushConsidered(const ValueAndCell& vc);
         void popConsidered();
+        void decreaseConsidered(const ValueAndCell& vc);
+        void heapSiftUp(int pos);
+        void heapSiftDown(int pos);
+        void heapPlace(const int pos, const ValueAndCell& vc);
 
         void computeGridRadius();
         void computeAnisoRatio(const double* metric);
-#endif // BOOST_HEAP_AVAILABLE
+        void computeBuckets();
     };
 
 } // namespace Opm
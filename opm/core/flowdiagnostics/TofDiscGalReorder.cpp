@@ -24,6 +24,7 @@
 #include <opm/core/flowdiagnostics/DGBasis.hpp>
 #include <opm/core/grid.h>
 #include <opm/common/ErrorMacros.hpp>
+#include <opm/common/OpmLog/OpmLog.hpp>
 #include <opm/core/utility/SparseTable.hpp>
 #include <opm/core/utility/VelocityInterpolation.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
@@ -31,8 +32,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <numeric>
 #include <iostream>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace Opm
 {
@@ -47,8 +54,7 @@ namespace Opm
           limiter_relative_flux_threshold_(1e-3),
           limiter_method_(MinUpwindAverage),
           limiter_usage_(DuringComputations),
-          coord_(grid.dimensions),
-          velocity_(grid.dimensions),
+          use_quadrature_cache_(false),
           gauss_seidel_tol_(1e-3)
     {
         const int dg_degree = param.getDefault("dg_degree", 0);
@@ -60,6 +66,9 @@ namespace Opm
         }
 
         tracers_ensure_unity_ = param.getDefault("tracers_ensure_unity", true);
+        setMultithreading(param.getDefault("use_multithreading", false));
+        use_quadrature_cache_ = param.getDefault("use_quadrature_cache", use_quadrature_cache_);
+        quad_cache_.valid = false;
 
         use_cvi_ = param.getDefault("use_cvi", use_cvi_);
         use_limiter_ = param.getDefault("use_limiter", use_limiter_);
@@ -122,18 +131,16 @@ namespace Opm
         tof_coeff.resize(num_basis*grid_.number_of_cells);
         std::fill(tof_coeff.begin(), tof_coeff.end(), 0.0);
         tof_coeff_ = &tof_coeff[0];
-        rhs_.resize(num_basis);
-        jac_.resize(num_basis*num_basis);
-        orig_jac_.resize(num_basis*num_basis);
-        basis_.resize(num_basis);
-        basis_nb_.resize(num_basis);
-        grad_basis_.resize(num_basis*grid_.dimensions);
+        setupWorkspaces(num_basis);
+        if (use_quadrature_cache_ && !quad_cache_.valid) {
+            buildQuadratureCache();
+        }
         velocity_interpolation_->setupFluxes(darcyflux);
         num_tracers_ = 0;
         num_multicell_ = 0;
         max_size_multicell_ = 0;
         max_iter_multicell_ = 0;
-        num_singlesolves_ = 0;
+        invalidateOrdering();
         reorderAndTransport(grid_, darcyflux);
         switch (limiter_usage_) {
         case AsPostProcess:
@@ -148,13 +155,7 @@ namespace Opm
         default:
             OPM_THROW(std::runtime_error, "Unknown limiter usage choice: " << limiter_usage_);
         }
-        if (num_multicell_ > 0) {
-            std::cout << num_multicell_ << " multicell blocks with max size "
-                      << max_size_multicell_ << " cells in upto "
-                      << max_iter_multicell_ << " iterations." << std::endl;
-            std::cout << "Average solves per cell (for all cells) was "
-                      << double(num_singlesolves_)/double(grid_.number_of_cells) << std::endl;
-        }
+        reportMultiCellStatistics();
     }
 
 
@@ -201,12 +202,10 @@ namespace Opm
         tof_coeff.resize(num_basis*grid_.number_of_cells);
         std::fill(tof_coeff.begin(), tof_coeff.end(), 0.0);
         tof_coeff_ = &tof_coeff[0];
-        rhs_.resize(num_basis*(num_tracers_ + 1));
-        jac_.resize(num_basis*num_basis);
-        orig_jac_.resize(num_basis*num_basis);
-        basis_.resize(num_basis);
-        basis_nb_.resize(num_basis);
-        grad_basis_.resize(num_basis*grid_.dimensions);
+        setupWorkspaces(num_basis*(num_tracers_ + 1));
+        if (use_quadrature_cache_ && !quad_cache_.valid) {
+            buildQuadratureCache();
+        }
         velocity_interpolation_->setupFluxes(darcyflux);
 
         // Set up tracer
@@ -230,7 +229,7 @@ namespace Opm
         num_multicell_ = 0;
         max_size_multicell_ = 0;
         max_iter_multicell_ = 0;
-        num_singlesolves_ = 0;
+        invalidateOrdering();
         reorderAndTransport(grid_, darcyflux);
         switch (limiter_usage_) {
         case AsPostProcess:
@@ -245,12 +244,189 @@ namespace Opm
         default:
             OPM_THROW(std::runtime_error, "Unknown limiter usage choice: " << limiter_usage_);
         }
+        reportMultiCellStatistics();
+        reportZeroTracerSums();
+    }
+
+
+
+
+    void TofDiscGalReorder::buildQuadratureCache()
+    {
+        // Evaluate the quadrature rules of cellContribs() and
+        // faceContribs() once, keeping only the flux-independent sums.
+        const int num_basis = basis_func_->numBasisFunc();
+        const int nb2 = num_basis*num_basis;
+        const int dim = grid_.dimensions;
+        const int deg = basis_func_->degree();
+        const int nc = grid_.number_of_cells;
+        const int nf = grid_.number_of_faces;
+        std::vector<double> coord(dim);
+        std::vector<double> basis(num_basis);
+        std::vector<double> basis_nb(num_basis);
+        std::vector<double> grad_basis(num_basis*dim);
+
+        QuadratureCache& qc = quad_cache_;
+        qc.cell_basis_integral.assign(num_basis*nc, 0.0);
+        qc.cell_mass.assign(nb2*nc, 0.0);
+        qc.cell_vel_pos.assign(1, 0);
+        qc.cell_vel_coord.clear();
+        qc.cell_vel_prod.clear();
+        for (int cell = 0; cell < nc; ++cell) {
+            {
+                double* bint = &qc.cell_basis_integral[num_basis*cell];
+                CellQuadrature quad(grid_, cell, deg);
+                for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
+                    quad.quadPtCoord(quad_pt, &coord[0]);
+                    basis_func_->eval(cell, &coord[0], &basis[0]);
+                    const double w = quad.quadPtWeight(quad_pt);
+                    for (int j = 0; j < num_basis; ++j) {
+                        bint[j] += w * basis[j];
+                    }
+                }
+            }
+            {
+                double* mass = &qc.cell_mass[nb2*cell];
+                int num_pts = qc.cell_vel_pos.back();
+                CellQuadrature quad(grid_, cell, 2*deg);
+                for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
+                    quad.quadPtCoord(quad_pt, &coord[0]);
+                    basis_func_->eval(cell, &coord[0], &basis[0]);
+                    basis_func_->evalGrad(cell, &coord[0], &grad_basis[0]);
+                    const double w = quad.quadPtWeight(quad_pt);
+                    for (int j = 0; j < num_basis; ++j) {
+                        for (int i = 0; i < num_basis; ++i) {
+                            mass[j*num_basis + i] += w * basis[i] * basis[j];
+                        }
+                    }
+                    // Without ECVI the velocity is constant in the
+                    // cell, so all points are merged into the first.
+                    if (use_cvi_ || quad_pt == 0) {
+                        qc.cell_vel_coord.insert(qc.cell_vel_coord.end(), coord.begin(), coord.end());
+                        qc.cell_vel_prod.resize(qc.cell_vel_prod.size() + nb2*dim, 0.0);
+                        ++num_pts;
+                    }
+                    double* prod = &qc.cell_vel_prod[nb2*dim*(num_pts - 1)];
+                    for (int j = 0; j < num_basis; ++j) {
+                        for (int i = 0; i < num_basis; ++i) {
+                            for (int dd = 0; dd < dim; ++dd) {
+                                prod[dim*(j*num_basis + i) + dd] += w * basis[j] * grad_basis[dim*i + dd];
+                            }
+                        }
+                    }
+                }
+                qc.cell_vel_pos.push_back(num_pts);
+            }
+        }
+
+        qc.face_mass.assign(3*nb2*nf, 0.0);
+        for (int face = 0; face < nf; ++face) {
+            const int c0 = grid_.face_cells[2*face];
+            const int c1 = grid_.face_cells[2*face + 1];
+            double* m00 = &qc.face_mass[3*nb2*face];
+            double* m11 = m00 + nb2;
+            double* m01 = m11 + nb2;
+            FaceQuadrature quad(grid_, face, 2*deg);
+            for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
+                quad.quadPtCoord(quad_pt, &coord[0]);
+                const double w = quad.quadPtWeight(quad_pt);
+                if (c0 >= 0) {
+                    basis_func_->eval(c0, &coord[0], &basis[0]);
+                }
+                if (c1 >= 0) {
+                    basis_func_->eval(c1, &coord[0], &basis_nb[0]);
+                }
+                for (int j = 0; j < num_basis; ++j) {
+                    for (int i = 0; i < num_basis; ++i) {
+                        if (c0 >= 0) {
+                            m00[j*num_basis + i] += w * basis[i] * basis[j];
+                        }
+                        if (c1 >= 0) {
+                            m11[j*num_basis + i] += w * basis_nb[i] * basis_nb[j];
+                        }
+                        if (c0 >= 0 && c1 >= 0) {
+                            m01[j*num_basis + i] += w * basis[j] * basis_nb[i];
+                        }
+                    }
+                }
+            }
+        }
+        qc.valid = true;
+    }
+
+
+
+
+    void TofDiscGalReorder::setupWorkspaces(const int num_rhs)
+    {
+        const int num_basis = basis_func_->numBasisFunc();
+        const int dim = grid_.dimensions;
+        int num_threads = 1;
+#ifdef _OPENMP
+        if (multithreading()) {
+            num_threads = omp_get_max_threads();
+        }
+#endif
+        workspaces_.resize(num_threads);
+        for (int t = 0; t < num_threads; ++t) {
+            Workspace& ws = workspaces_[t];
+            ws.rhs.resize(num_rhs);
+            ws.jac.resize(num_basis*num_basis);
+            ws.orig_jac.resize(num_basis*num_basis);
+            ws.coord.resize(dim);
+            ws.basis.resize(num_basis);
+            ws.basis_nb.resize(num_basis);
+            ws.grad_basis.resize(num_basis*dim);
+            ws.velocity.resize(dim);
+            ws.num_singlesolves = 0;
+            ws.zero_tracer_sum_cells.clear();
+        }
+    }
+
+
+
+
+    TofDiscGalReorder::Workspace& TofDiscGalReorder::threadWorkspace()
+    {
+        return workspaces_[threadWorkspaceIndex(workspaces_.size())];
+    }
+
+
+
+
+    void TofDiscGalReorder::reportMultiCellStatistics() const
+    {
         if (num_multicell_ > 0) {
+            int num_singlesolves = 0;
+            for (std::size_t t = 0; t < workspaces_.size(); ++t) {
+                num_singlesolves += workspaces_[t].num_singlesolves;
+            }
             std::cout << num_multicell_ << " multicell blocks with max size "
                       << max_size_multicell_ << " cells in upto "
                       << max_iter_multicell_ << " iterations." << std::endl;
             std::cout << "Average solves per cell (for all cells) was "
-                      << double(num_singlesolves_)/double(grid_.number_of_cells) << std::endl;
+                      << double(num_singlesolves)/double(grid_.number_of_cells) << std::endl;
+        }
+    }
+
+
+
+
+    void TofDiscGalReorder::reportZeroTracerSums() const
+    {
+        std::vector<int> cells;
+        for (std::size_t t = 0; t < workspaces_.size(); ++t) {
+            const std::vector<int>& wc = workspaces_[t].zero_tracer_sum_cells;
+            cells.insert(cells.end(), wc.begin(), wc.end());
+        }
+        if (!cells.empty()) {
+            std::sort(cells.begin(), cells.end());
+            std::ostringstream msg;
+            msg << "Tracer sum is zero in " << cells.size() << " cell(s):";
+            for (std::size_t i = 0; i < cells.size(); ++i) {
+                msg << ' ' << cells[i];
+            }
+            OpmLog::warning(msg.str());
         }
     }
 
@@ -272,37 +448,38 @@ namespace Opm
         // For tracers, the equation is the same, except for the last
         // term being zero (the one with \phi).
         //
-        // The rhs_ vector contains a (Fortran ordering) matrix of all
+        // The ws.rhs vector contains a (Fortran ordering) matrix of all
         // right-hand-sides, first for tof and then (optionally) for
         // all tracers.
 
         const int num_basis = basis_func_->numBasisFunc();
-        ++num_singlesolves_;
+        Workspace& ws = threadWorkspace();
+        ++ws.num_singlesolves;
 
-        std::fill(rhs_.begin(), rhs_.end(), 0.0);
-        std::fill(jac_.begin(), jac_.end(), 0.0);
+        std::fill(ws.rhs.begin(), ws.rhs.end(), 0.0);
+        std::fill(ws.jac.begin(), ws.jac.end(), 0.0);
 
-        // Add cell contributions to res_ and jac_.
-        cellContribs(cell);
+        // Add cell contributions to ws.rhs and ws.jac.
+        cellContribs(cell, ws);
 
-        // Add face contributions to res_ and jac_.
-        faceContribs(cell);
+        // Add face contributions to ws.rhs and ws.jac.
+        faceContribs(cell, ws);
 
         // Solve linear equation.
-        solveLinearSystem(cell);
+        solveLinearSystem(cell, ws);
 
-        // The solution ends up in rhs_, so we must copy it.
-        std::copy(rhs_.begin(), rhs_.begin() + num_basis, tof_coeff_ + num_basis*cell);
+        // The solution ends up in ws.rhs, so we must copy it.
+        std::copy(ws.rhs.begin(), ws.rhs.begin() + num_basis, tof_coeff_ + num_basis*cell);
         if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
-            std::copy(rhs_.begin() + num_basis, rhs_.end(), tracer_coeff_ + num_tracers_*num_basis*cell);
+            std::copy(ws.rhs.begin() + num_basis, ws.rhs.end(), tracer_coeff_ + num_tracers_*num_basis*cell);
         }
 
         // Apply limiter.
         if (basis_func_->degree() > 0 && use_limiter_ && limiter_usage_ == DuringComputations) {
-            applyLimiter(cell, tof_coeff_);
+            applyLimiter(cell, tof_coeff_, ws);
             if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
                 for (int tr = 0; tr < num_tracers_; ++tr) {
-                    applyTracerLimiter(cell, tracer_coeff_ + cell*num_tracers_*num_basis + tr*num_basis);
+                    applyTracerLimiter(cell, tracer_coeff_ + cell*num_tracers_*num_basis + tr*num_basis, ws);
                 }
             }
         }
@@ -317,7 +494,9 @@ namespace Opm
                 tr_sum += tr_aver[tr];
             }
             if (tr_sum == 0.0) {
-                std::cout << "Tracer sum is zero in cell " << cell << std::endl;
+                // Reported once by reportZeroTracerSums(), since we
+                // may be running on several threads here.
+                ws.zero_tracer_sum_cells.push_back(cell);
             } else {
                 for (int tr = 0; tr < num_tracers_; ++tr) {
                     const double increment = tr_aver[tr]/tr_sum - tr_aver[tr];
@@ -331,23 +510,50 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::cellContribs(const int cell)
+    void TofDiscGalReorder::cellContribs(const int cell, Workspace& ws)
     {
         const int num_basis = basis_func_->numBasisFunc();
         const int dim = grid_.dimensions;
 
+        if (quad_cache_.valid) {
+            // Same contributions as below, from precomputed integrals.
+            const QuadratureCache& qc = quad_cache_;
+            const double pv_density = porevolume_[cell] / grid_.cell_volumes[cell];
+            const double* bint = &qc.cell_basis_integral[num_basis*cell];
+            for (int j = 0; j < num_basis; ++j) {
+                ws.rhs[j] += bint[j] * pv_density;
+            }
+            for (int pt = qc.cell_vel_pos[cell]; pt < qc.cell_vel_pos[cell + 1]; ++pt) {
+                velocity_interpolation_->interpolate(cell, &qc.cell_vel_coord[dim*pt], &ws.velocity[0]);
+                const double* prod = &qc.cell_vel_prod[num_basis*num_basis*dim*pt];
+                for (int ji = 0; ji < num_basis*num_basis; ++ji) {
+                    for (int dd = 0; dd < dim; ++dd) {
+                        ws.jac[ji] -= prod[dim*ji + dd] * ws.velocity[dd];
+                    }
+                }
+            }
+            if (source_[cell] < 0.0) {
+                const double flux_density = -source_[cell] / grid_.cell_volumes[cell];
+                const double* mass = &qc.cell_mass[num_basis*num_basis*cell];
+                for (int ji = 0; ji < num_basis*num_basis; ++ji) {
+                    ws.jac[ji] += flux_density * mass[ji];
+                }
+            }
+            return;
+        }
+
         // Compute cell residual contribution.
         {
             const int deg_needed = basis_func_->degree();
             CellQuadrature quad(grid_, cell, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // Integral of: b_i \phi
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     // Only adding to the tof rhs.
-                    rhs_[j] += w * basis_[j] * porevolume_[cell] / grid_.cell_volumes[cell];
+                    ws.rhs[j] += w * ws.basis[j] * porevolume_[cell] / grid_.cell_volumes[cell];
                 }
             }
         }
@@ -368,15 +574,15 @@ namespace Opm
             CellQuadrature quad(grid_, cell, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // b_i (v \cdot \grad b_j)
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
-                basis_func_->evalGrad(cell, &coord_[0], &grad_basis_[0]);
-                velocity_interpolation_->interpolate(cell, &coord_[0], &velocity_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
+                basis_func_->evalGrad(cell, &ws.coord[0], &ws.grad_basis[0]);
+                velocity_interpolation_->interpolate(cell, &ws.coord[0], &ws.velocity[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
                         for (int dd = 0; dd < dim; ++dd) {
-                            jac_[j*num_basis + i] -= w * basis_[j] * grad_basis_[dim*i + dd] * velocity_[dd];
+                            ws.jac[j*num_basis + i] -= w * ws.basis[j] * ws.grad_basis[dim*i + dd] * ws.velocity[dd];
                         }
                     }
                 }
@@ -396,12 +602,12 @@ namespace Opm
             // \int_{K} b_i flux b_j dx
             CellQuadrature quad(grid_, cell, 2*basis_func_->degree());
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
-                        jac_[j*num_basis + i] += w * basis_[i] * flux_density * basis_[j];
+                        ws.jac[j*num_basis + i] += w * ws.basis[i] * flux_density * ws.basis[j];
                     }
                 }
             }
@@ -411,8 +617,13 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::faceContribs(const int cell)
+    void TofDiscGalReorder::faceContribs(const int cell, Workspace& ws)
     {
+        if (quad_cache_.valid) {
+            faceContribsCached(cell, ws);
+            return;
+        }
+
         const int num_basis = basis_func_->numBasisFunc();
 
         // Compute upstream residual contribution from faces.
@@ -448,23 +659,23 @@ namespace Opm
             const int deg_needed = 2*basis_func_->degree();
             FaceQuadrature quad(grid_, face, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
-                basis_func_->eval(upstream_cell, &coord_[0], &basis_nb_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
+                basis_func_->eval(upstream_cell, &ws.coord[0], &ws.basis_nb[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 // Modify tof rhs
-                const double tof_upstream = std::inner_product(basis_nb_.begin(), basis_nb_.end(),
+                const double tof_upstream = std::inner_product(ws.basis_nb.begin(), ws.basis_nb.end(),
                                                                tof_coeff_ + num_basis*upstream_cell, 0.0);
                 for (int j = 0; j < num_basis; ++j) {
-                    rhs_[j] -= w * tof_upstream * normal_velocity * basis_[j];
+                    ws.rhs[j] -= w * tof_upstream * normal_velocity * ws.basis[j];
                 }
                 // Modify tracer rhs
                 if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
                     for (int tr = 0; tr < num_tracers_; ++tr) {
                         const double* up_tr_co = tracer_coeff_ + num_tracers_*num_basis*upstream_cell + num_basis*tr;
-                        const double tracer_up = std::inner_product(basis_nb_.begin(), basis_nb_.end(), up_tr_co, 0.0);
+                        const double tracer_up = std::inner_product(ws.basis_nb.begin(), ws.basis_nb.end(), up_tr_co, 0.0);
                         for (int j = 0; j < num_basis; ++j) {
-                            rhs_[num_basis*(tr + 1) + j] -= w * tracer_up * normal_velocity * basis_[j];
+                            ws.rhs[num_basis*(tr + 1) + j] -= w * tracer_up * normal_velocity * ws.basis[j];
                         }
                     }
                 }
@@ -490,12 +701,58 @@ namespace Opm
             FaceQuadrature quad(grid_, face, 2*basis_func_->degree());
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // u^ext flux B   (B = {b_j})
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                basis_func_->eval(cell, &ws.coord[0], &ws.basis[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
-                        jac_[j*num_basis + i] += w * basis_[i] * normal_velocity * basis_[j];
+                        ws.jac[j*num_basis + i] += w * ws.basis[i] * normal_velocity * ws.basis[j];
+                    }
+                }
+            }
+        }
+    }
+
+
+
+    void TofDiscGalReorder::faceContribsCached(const int cell, Workspace& ws)
+    {
+        // Same contributions as faceContribs(), but from the
+        // precomputed face integrals. The upstream solution enters
+        // linearly, so its quadrature reduces to a matrix product.
+        const int num_basis = basis_func_->numBasisFunc();
+        const int nb2 = num_basis*num_basis;
+        for (int hface = grid_.cell_facepos[cell]; hface < grid_.cell_facepos[cell+1]; ++hface) {
+            const int face = grid_.cell_faces[hface];
+            const int side = (cell == grid_.face_cells[2*face]) ? 0 : 1;
+            const double flux = (side == 0) ? darcyflux_[face] : -darcyflux_[face];
+            const int other_cell = grid_.face_cells[2*face + 1 - side];
+            const double normal_velocity = flux / grid_.face_areas[face];
+            const double* fmass = &quad_cache_.face_mass[3*nb2*face];
+            if (flux > 0.0) {
+                // Downstream jacobian contribution.
+                const double* own = fmass + side*nb2;
+                for (int ji = 0; ji < nb2; ++ji) {
+                    ws.jac[ji] += normal_velocity * own[ji];
+                }
+            } else if (flux < 0.0 && other_cell >= 0) {
+                // Upstream residual contribution. The (j, k) entry of the
+                // cross term is m01[j*nb + k] on side 0, m01[k*nb + j] on side 1.
+                const double* m01 = fmass + 2*nb2;
+                const int jstride = (side == 0) ? num_basis : 1;
+                const int kstride = (side == 0) ? 1 : num_basis;
+                const bool do_tracers = num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead;
+                const int num_rhs = do_tracers ? num_tracers_ + 1 : 1;
+                for (int r = 0; r < num_rhs; ++r) {
+                    const double* up_co = (r == 0)
+                        ? tof_coeff_ + num_basis*other_cell
+                        : tracer_coeff_ + num_tracers_*num_basis*other_cell + num_basis*(r - 1);
+                    for (int j = 0; j < num_basis; ++j) {
+                        double up = 0.0;
+                        for (int k = 0; k < num_basis; ++k) {
+                            up += m01[j*jstride + k*kstride] * up_co[k];
+                        }
+                        ws.rhs[num_basis*r + j] -= normal_velocity * up;
                     }
                 }
             }
@@ -504,11 +761,11 @@ namespace Opm
 
 
 
-    // This function assumes that jac_ and rhs_ contain the
-    // linear system to be solved. They are stored in orig_jac_
-    // and orig_rhs_, then the system is solved via LAPACK,
-    // overwriting the input data (jac_ and rhs_).
-    void TofDiscGalReorder::solveLinearSystem(const int cell)
+    // This function assumes that ws.jac and ws.rhs contain the
+    // linear system to be solved. They are stored in ws.orig_jac
+    // and ws.orig_rhs, then the system is solved via LAPACK,
+    // overwriting the input data (ws.jac and ws.rhs).
+    void TofDiscGalReorder::solveLinearSystem(const int cell, Workspace& ws)
     {
         MAT_SIZE_T n = basis_func_->numBasisFunc();
         int num_tracer_to_compute = num_tracers_;
@@ -522,23 +779,26 @@ namespace Opm
         std::vector<MAT_SIZE_T> piv(n);
         MAT_SIZE_T ldb = n;
         MAT_SIZE_T info = 0;
-        orig_jac_ = jac_;
-        orig_rhs_ = rhs_;
-        dgesv_(&n, &nrhs, &jac_[0], &lda, &piv[0], &rhs_[0], &ldb, &info);
+        ws.orig_jac = ws.jac;
+        ws.orig_rhs = ws.rhs;
+        dgesv_(&n, &nrhs, &ws.jac[0], &lda, &piv[0], &ws.rhs[0], &ldb, &info);
         if (info != 0) {
             // Print the local matrix and rhs.
-            std::cerr << "Failed solving single-cell system Ax = b in cell " << cell
-                      << " with A = \n";
+            std::ostringstream os;
+            os << "Failed solving single-cell system Ax = b in cell " << cell
+               << " with A = \n";
             for (int row = 0; row < n; ++row) {
                 for (int col = 0; col < n; ++col) {
-                    std::cerr << "    " << orig_jac_[row + n*col];
+                    os << "    " << ws.orig_jac[row + n*col];
                 }
-                std::cerr << '\n';
+                os << '\n';
             }
-            std::cerr << "and b = \n";
+            os << "and b = \n";
             for (int row = 0; row < n; ++row) {
-                std::cerr << "    " << orig_rhs_[row] << '\n';
+                os << "    " << ws.orig_rhs[row] << '\n';
             }
+            // Write in one piece, to avoid interleaving with other threads.
+            std::cerr << os.str();
             OPM_THROW(std::runtime_error, "Lapack error: " << info << " encountered in cell " << cell);
         }
     }
@@ -548,8 +808,11 @@ namespace Opm
 
     void TofDiscGalReorder::solveMultiCell(const int num_cells, const int* cells)
     {
-        ++num_multicell_;
-        max_size_multicell_ = std::max(max_size_multicell_, num_cells);
+#pragma omp critical(tof_discgal_multicell_stats)
+        {
+            ++num_multicell_;
+            max_size_multicell_ = std::max(max_size_multicell_, num_cells);
+        }
         // std::cout << "Multiblock solve with " << num_cells << " cells." << std::endl;
 
         // Using a Gauss-Seidel approach.
@@ -568,20 +831,21 @@ namespace Opm
             }
             // std::cout << "Max delta = " << max_delta << std::endl;
         }
+#pragma omp critical(tof_discgal_multicell_stats)
         max_iter_multicell_ = std::max(max_iter_multicell_, num_iter);
     }
 
 
 
 
-    void TofDiscGalReorder::applyLimiter(const int cell, double* tof)
+    void TofDiscGalReorder::applyLimiter(const int cell, double* tof, Workspace& ws)
     {
         switch (limiter_method_) {
         case MinUpwindFace:
-            applyMinUpwindLimiter(cell, true, tof);
+            applyMinUpwindLimiter(cell, true, tof, ws);
             break;
         case MinUpwindAverage:
-            applyMinUpwindLimiter(cell, false, tof);
+            applyMinUpwindLimiter(cell, false, tof, ws);
             break;
         default:
             OPM_THROW(std::runtime_error, "Limiter type not implemented: " << limiter_method_);
@@ -591,7 +855,7 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::applyMinUpwindLimiter(const int cell, const bool face_min, double* tof)
+    void TofDiscGalReorder::applyMinUpwindLimiter(const int cell, const bool face_min, double* tof, Workspace& ws)
     {
         if (basis_func_->degree() != 1) {
             OPM_THROW(std::runtime_error, "This limiter only makes sense for our DG1 implementation.");
@@ -633,13 +897,13 @@ namespace Opm
 
             // Find minimum tof in this cell and upstream.
             // The meaning of minimum upstream tof depends on method.
-            min_here_tof = std::min(min_here_tof, minCornerVal(cell, face));
+            min_here_tof = std::min(min_here_tof, minCornerVal(cell, face, ws));
             if (upstream) {
                 ++num_upstream_faces;
                 double upstream_tof = 0.0;
                 if (interior) {
                     if (face_min) {
-                        upstream_tof = minCornerVal(upstream_cell, face);
+                        upstream_tof = minCornerVal(upstream_cell, face, ws);
                     } else {
                         upstream_tof = basis_func_->functionAverage(tof_coeff_ + num_basis*upstream_cell);
                     }
@@ -688,9 +952,45 @@ namespace Opm
         const std::vector<int>& seq = ReorderSolverInterface::sequence();
         const int nc = seq.size();
         assert(nc == grid_.number_of_cells);
-        for (int i = 0; i < nc; ++i) {
-            const int cell = seq[i];
-            applyLimiter(cell, tof_coeff_);
+        const std::vector<int>& levels = ReorderSolverInterface::levels();
+        if (levels.empty()) {
+            Workspace& ws = threadWorkspace();
+            for (int i = 0; i < nc; ++i) {
+                const int cell = seq[i];
+                applyLimiter(cell, tof_coeff_, ws);
+            }
+            return;
+        }
+
+        // The dependencies are those of the solve itself, so the
+        // components of a level may be limited concurrently.
+        const std::vector<int>& comps = ReorderSolverInterface::components();
+        const std::vector<int>& level_comps = ReorderSolverInterface::levelComponents();
+        const int nlevels = levels.size() - 1;
+        std::exception_ptr error;
+        for (int level = 0; level < nlevels; ++level) {
+            const int level_begin = levels[level];
+            const int level_end = levels[level + 1];
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int i = level_begin; i < level_end; ++i) {
+                try {
+                    Workspace& ws = threadWorkspace();
+                    const int comp = level_comps[i];
+                    for (int j = comps[comp]; j < comps[comp + 1]; ++j) {
+                        applyLimiter(seq[j], tof_coeff_, ws);
+                    }
+                } catch (...) {
+#pragma omp critical(tof_discgal_limiter_error)
+                    {
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
         }
     }
 
@@ -704,9 +1004,24 @@ namespace Opm
         // we write the resulting dofs to a new array instead of writing to tof_coeff_.
         // Afterwards we copy the results back to tof_coeff_.
         const int num_basis = basis_func_->numBasisFunc();
-        std::vector<double> tof_coeffs_new(tof_coeff_, tof_coeff_ + num_basis*grid_.number_of_cells);
-        for (int c = 0; c < grid_.number_of_cells; ++c) {
-            applyLimiter(c, &tof_coeffs_new[0]);
+        const int nc = grid_.number_of_cells;
+        std::vector<double> tof_coeffs_new(tof_coeff_, tof_coeff_ + num_basis*nc);
+        std::exception_ptr error;
+#pragma omp parallel for schedule(static) if (multithreading())
+        for (int c = 0; c < nc; ++c) {
+            try {
+                applyLimiter(c, &tof_coeffs_new[0], threadWorkspace());
+            } catch (...) {
+#pragma omp critical(tof_discgal_limiter_error)
+                {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
         }
         std::copy(tof_coeffs_new.begin(), tof_coeffs_new.end(), tof_coeff_);
     }
@@ -742,7 +1057,7 @@ namespace Opm
 
 
 
-    double TofDiscGalReorder::minCornerVal(const int cell, const int face) const
+    double TofDiscGalReorder::minCornerVal(const int cell, const int face, Workspace& ws) const
     {
         // Evaluate the solution in all corners.
         const int dim = grid_.dimensions;
@@ -750,8 +1065,8 @@ namespace Opm
         double min_cornerval = 1e100;
         for (int fnode = grid_.face_nodepos[face]; fnode < grid_.face_nodepos[face+1]; ++fnode) {
             const double* nc = grid_.node_coordinates + dim*grid_.face_nodes[fnode];
-            basis_func_->eval(cell, nc, &basis_[0]);
-            const double tof_corner = std::inner_product(basis_.begin(), basis_.end(),
+            basis_func_->eval(cell, nc, &ws.basis[0]);
+            const double tof_corner = std::inner_product(ws.basis.begin(), ws.basis.end(),
                                                          tof_coeff_ + num_basis*cell, 0.0);
             min_cornerval = std::min(min_cornerval, tof_corner);
         }
@@ -760,7 +1075,7 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::applyTracerLimiter(const int cell, double* local_coeff)
+    void TofDiscGalReorder::applyTracerLimiter(const int cell, double* local_coeff, Workspace& ws)
     {
         // Evaluate the solution in all corners of all faces. Extract max and min.
         const int dim = grid_.dimensions;
@@ -771,8 +1086,8 @@ namespace Opm
             const int face = grid_.cell_faces[hface];
             for (int fnode = grid_.face_nodepos[face]; fnode < grid_.face_nodepos[face+1]; ++fnode) {
                 const double* nc = grid_.node_coordinates + dim*grid_.face_nodes[fnode];
-                basis_func_->eval(cell, nc, &basis_[0]);
-                const double tracer_corner = std::inner_product(basis_.begin(), basis_.end(),
+                basis_func_->eval(cell, nc, &ws.basis[0]);
+                const double tracer_corner = std::inner_product(ws.basis.begin(), ws.basis.end(),
                                                                 local_coeff, 0.0);
                 min_cornerval = std::min(min_cornerval, tracer_corner);
                 max_cornerval = std::max(min_cornerval, tracer_corner);
@@ -46,6 +46,10 @@ namespace Opm
     /// \f$ \tau \f$ is specified to be zero on all inflow boundaries.
     /// The user may specify the polynomial degree of the basis function space
     /// used, but only degrees 0 and 1 are supported so far.
+    ///
+    /// If multithreading is enabled with setMultithreading(), independent
+    /// cells of the reordered sequence, as well as the limiter
+    /// post-processing passes, are computed concurrently.
     class TofDiscGalReorder : public ReorderSolverInterface
     {
     public:
@@ -71,6 +75,11 @@ namespace Opm
         ///                                             computing (unlimited) solution.
         ///             - AsSimultaneousPostProcess  -- Apply to each cell independently, using un-
         ///                                             limited solution in neighbouring cells.
+        ///   - \c use_multithreading (false)              -- Solve independent cells concurrently,
+        ///                                                   see setMultithreading().
+        ///   - \c use_quadrature_cache (false)            -- Precompute the flux-independent quadrature
+        ///                                                   data for the grid at the first solve, and
+        ///                                                   reuse it in later solves. Uses more memory.
         TofDiscGalReorder(const UnstructuredGrid& grid,
                           const parameter::ParameterGroup& param);
 
@@ -117,13 +126,63 @@ namespace Opm
                             std::vector<double>& tof_coeff,
                             std::vector<double>& tracer_coeff);
 
+        /// Enable or disable concurrent solution of independent
+        /// components of the reordered sequence.
+        using ReorderSolverInterface::setMultithreading;
+
     private:
+        // Scratch data for single-cell solves. There is one
+        // workspace per thread.
+        struct Workspace
+        {
+            std::vector<double> rhs;        // single-cell right-hand-sides
+            std::vector<double> jac;        // single-cell jacobian
+            std::vector<double> orig_rhs;   // single-cell right-hand-sides (copy)
+            std::vector<double> orig_jac;   // single-cell jacobian (copy)
+            std::vector<double> coord;
+            std::vector<double> basis;
+            std::vector<double> basis_nb;
+            std::vector<double> grad_basis;
+            std::vector<double> velocity;
+            int num_singlesolves;
+            std::vector<int> zero_tracer_sum_cells;
+        };
+
+        // Flux-independent quadrature data for all cells and faces,
+        // integrated over the same quadrature rules as used by
+        // cellContribs() and faceContribs(). Matrices are nb*nb, with
+        // (j, i) stored at [j*nb + i], nb = number of basis functions.
+        struct QuadratureCache
+        {
+            bool valid;
+            // Per cell: int b_j dx (nb values).
+            std::vector<double> cell_basis_integral;
+            // Per cell: int b_i b_j dx.
+            std::vector<double> cell_mass;
+            // Per velocity evaluation point p of a cell, in
+            // [cell_vel_pos[cell], cell_vel_pos[cell+1]): its coordinates
+            // and the products w_p b_j (d b_i / dx_d), d cycling fastest.
+            // Constant velocity interpolation needs only one point per cell.
+            std::vector<int> cell_vel_pos;
+            std::vector<double> cell_vel_coord;
+            std::vector<double> cell_vel_prod;
+            // Per face: int b^a_j b^b_i ds for (a, b) = (0, 0), (1, 1)
+            // and (0, 1), where a and b index the face's two cells.
+            std::vector<double> face_mass;
+        };
+
         virtual void solveSingleCell(const int cell);
         virtual void solveMultiCell(const int num_cells, const int* cells);
 
-        void cellContribs(const int cell);
-        void faceContribs(const int cell);
-        void solveLinearSystem(const int cell);
+        void buildQuadratureCache();
+        void setupWorkspaces(const int num_rhs);
+        Workspace& threadWorkspace();
+        void cellContribs(const int cell, Workspace& ws);
+        void faceContribs(const int cell, Workspace& ws);
+        void faceContribsCached(const int cell, Workspace& ws);
+        void solveLinearSystem(const int cell, Workspace& ws);
+        void reportMultiCellStatistics() const;
+        void reportZeroTracerSums() const;
 
     private:
         // Disable copying and assignment.
@@ -152,16 +211,9 @@ namespace Opm
         std::vector<int> tracerhead_by_cell_;
         bool tracers_ensure_unity_;
         // Used by solveSingleCell().
-        std::vector<double> rhs_;   // single-cell right-hand-sides
-        std::vector<double> jac_;   // single-cell jacobian
-        std::vector<double> orig_rhs_;   // single-cell right-hand-sides (copy)
-        std::vector<double> orig_jac_;   // single-cell jacobian (copy)
-        std::vector<double> coord_;
-        mutable std::vector<double> basis_;
-        mutable std::vector<double> basis_nb_;
-        std::vector<double> grad_basis_;
-        std::vector<double> velocity_;
-        int num_singlesolves_;
+        std::vector<Workspace> workspaces_;
+        bool use_quadrature_cache_;
+        QuadratureCache quad_cache_;
         // Used by solveMultiCell():
         double gauss_seidel_tol_;
         int num_multicell_;
@@ -173,16 +225,16 @@ namespace Opm
         // Apply some limiter, writing to array tof
         // (will read data from tof_coeff_, it is ok to call
         //  with tof_coeff as tof argument.
-        void applyLimiter(const int cell, double* tof);
-        void applyMinUpwindLimiter(const int cell, const bool face_min, double* tof);
+        void applyLimiter(const int cell, double* tof, Workspace& ws);
+        void applyMinUpwindLimiter(const int cell, const bool face_min, double* tof, Workspace& ws);
         void applyLimiterAsPostProcess();
         void applyLimiterAsSimultaneousPostProcess();
         double totalFlux(const int cell) const;
-        double minCornerVal(const int cell, const int face) const;
+        double minCornerVal(const int cell, const int face, Workspace& ws) const;
 
         // Apply a simple (restrict to [0,1]) limiter.
         // Intended for tracers.
-        void applyTracerLimiter(const int cell, double* local_coeff);
+        void applyTracerLimiter(const int cell, double* local_coeff, Workspace& ws);
     };
 
 } // namespace Opm
@@ -42,8 +42,11 @@ namespace Opm
           porevolume_(0),
           source_(0),
           tof_(0),
+          tracer_(0),
+          num_tracers_(0),
           gauss_seidel_tol_(1e-3),
-          use_multidim_upwind_(use_multidim_upwind)
+          use_multidim_upwind_(use_multidim_upwind),
+          reuse_ordering_(false)
     {
     }
 
@@ -65,6 +68,9 @@ namespace Opm
         darcyflux_ = darcyflux;
         porevolume_ = porevolume;
         source_ = source;
+        if (!reuse_ordering_) {
+            invalidateOrdering();
+        }
 #ifndef NDEBUG
         // Sanity check for sources.
         const double cum_src = std::accumulate(source, source + grid_.number_of_cells, 0.0);
@@ -110,6 +116,9 @@ namespace Opm
         darcyflux_ = darcyflux;
         porevolume_ = porevolume;
         source_ = source;
+        if (!reuse_ordering_) {
+            invalidateOrdering();
+        }
         const int num_cells = grid_.number_of_cells;
 #ifndef NDEBUG
         // Sanity check for sources.
@@ -145,22 +154,42 @@ namespace Opm
             const unsigned int tracerheadsSize = tracerheads[tr].size();
             for (unsigned int i = 0; i < tracerheadsSize; ++i) {
                 const int cell = tracerheads[tr][i];
-                tracer[num_cells * tr + cell] = 1.0;
+                tracer[num_tracers * cell + tr] = 1.0;
                 tracerhead_by_cell_[cell] = tr;
             }
         }
+        if (num_tracers == 0) {
+            return;
+        }
 
-        // Execute solve for tracers.
+        // Execute solve for tracers. The flux is unchanged, so all
+        // solves share the ordering computed for the tof solve.
         std::vector<double> fake_pv(num_cells, 0.0);
         porevolume_ = fake_pv.data();
+        compute_tracer_ = true;
+        if (!use_multidim_upwind_) {
+            // All tracers are solved together in a single sweep,
+            // directly in the cell-major output layout.
+            tracer_ = tracer.data();
+            num_tracers_ = num_tracers;
+            executeSolve();
+            return;
+        }
+
+        // The multidimensional upwind face values are stored for a
+        // single field only, so we solve one tracer at a time.
+        std::vector<double> computed(num_cells*num_tracers);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            for (int tr = 0; tr < num_tracers; ++tr) {
+                computed[num_cells * tr + cell] = tracer[num_tracers * cell + tr];
+            }
+        }
         for (int tr = 0; tr < num_tracers; ++tr) {
-            tof_ = tracer.data() + tr * num_cells;
-            compute_tracer_ = true;
+            tof_ = computed.data() + tr * num_cells;
             executeSolve();
         }
 
         // Write output tracer data (transposing the computed data).
-        std::vector<double> computed = tracer;
         for (int cell = 0; cell < num_cells; ++cell) {
             for (int tr = 0; tr < num_tracers; ++tr) {
                 tracer[num_tracers * cell + tr] = computed[num_cells * tr + cell];
@@ -171,6 +200,14 @@ namespace Opm
 
 
 
+    void TofReorder::setReuseOrdering(const bool reuse_ordering)
+    {
+        reuse_ordering_ = reuse_ordering;
+    }
+
+
+
+
     void TofReorder::executeSolve()
     {
         num_multicell_ = 0;
@@ -202,6 +239,10 @@ namespace Opm
             // This is a tracer head cell, already has solution.
             return;
         }
+        if (compute_tracer_) {
+            solveSingleCellTracers(cell, tracer_ + num_tracers_*cell);
+            return;
+        }
         double upwind_term = 0.0;
         double downwind_flux = std::max(-source_[cell], 0.0);
         for (int i = grid_.cell_facepos[cell]; i < grid_.cell_facepos[cell+1]; ++i) {
@@ -236,6 +277,49 @@ namespace Opm
 
 
 
+    // Solve for all tracers in a cell simultaneously. Tracer values
+    // are stored cell-major, so the inner loops run over contiguous
+    // data for each upwind neighbour. The result is written to
+    // cell_tracer, which must not alias the values of other cells.
+    void TofReorder::solveSingleCellTracers(const int cell, double* cell_tracer) const
+    {
+        const int nt = num_tracers_;
+        std::fill(cell_tracer, cell_tracer + nt, 0.0);
+        double downwind_flux = std::max(-source_[cell], 0.0);
+        for (int i = grid_.cell_facepos[cell]; i < grid_.cell_facepos[cell+1]; ++i) {
+            int f = grid_.cell_faces[i];
+            double flux;
+            int other;
+            // Compute cell flux
+            if (cell == grid_.face_cells[2*f]) {
+                flux  = darcyflux_[f];
+                other = grid_.face_cells[2*f+1];
+            } else {
+                flux  =-darcyflux_[f];
+                other = grid_.face_cells[2*f];
+            }
+            // Tracers are zero on inflow boundaries, so only
+            // internal faces contribute to the upwind term.
+            if (flux < 0.0) {
+                if (other != -1) {
+                    const double* other_tracer = tracer_ + nt*other;
+                    for (int tr = 0; tr < nt; ++tr) {
+                        cell_tracer[tr] -= flux*other_tracer[tr];
+                    }
+                }
+            } else {
+                downwind_flux += flux;
+            }
+        }
+        const double inv_downwind_flux = 1.0/downwind_flux;
+        for (int tr = 0; tr < nt; ++tr) {
+            cell_tracer[tr] *= inv_downwind_flux;
+        }
+    }
+
+
+
+
     void TofReorder::solveSingleCellMultidimUpwind(const int cell)
     {
         // Compute flux terms.
@@ -304,11 +388,16 @@ namespace Opm
 
     void TofReorder::solveMultiCell(const int num_cells, const int* cells)
     {
-        ++num_multicell_;
-        max_size_multicell_ = std::max(max_size_multicell_, num_cells);
+#pragma omp critical(tof_reorder_multicell_stats)
+        {
+            ++num_multicell_;
+            max_size_multicell_ = std::max(max_size_multicell_, num_cells);
+        }
         // std::cout << "Multiblock solve with " << num_cells << " cells." << std::endl;
 
         // Using a Gauss-Seidel approach.
+        const bool block_tracers = compute_tracer_ && !use_multidim_upwind_;
+        std::vector<double> cell_tracer(block_tracers ? num_tracers_ : 0);
         double max_delta = 1e100;
         int num_iter = 0;
         while (max_delta > gauss_seidel_tol_) {
@@ -316,12 +405,25 @@ namespace Opm
             ++num_iter;
             for (int ci = 0; ci < num_cells; ++ci) {
                 const int cell = cells[ci];
+                if (block_tracers) {
+                    if (tracerhead_by_cell_[cell] != NoTracerHead) {
+                        continue;
+                    }
+                    solveSingleCellTracers(cell, cell_tracer.data());
+                    double* tracer_before = tracer_ + num_tracers_*cell;
+                    for (int tr = 0; tr < num_tracers_; ++tr) {
+                        max_delta = std::max(max_delta, std::fabs(cell_tracer[tr] - tracer_before[tr]));
+                        tracer_before[tr] = cell_tracer[tr];
+                    }
+                    continue;
+                }
                 const double tof_before = tof_[cell];
                 solveSingleCell(cell);
                 max_delta = std::max(max_delta, std::fabs(tof_[cell] - tof_before));
             }
             // std::cout << "Max delta = " << max_delta << std::endl;
         }
+#pragma omp critical(tof_reorder_multicell_stats)
         max_iter_multicell_ = std::max(max_iter_multicell_, num_iter);
     }
 
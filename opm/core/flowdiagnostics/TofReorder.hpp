@@ -79,9 +79,17 @@ namespace Opm
                             std::vector<double>& tof,
                             std::vector<double>& tracer);
 
+        /// Keep the cell ordering between calls to solveTof() and
+        /// solveTofTracer() as long as the same darcyflux array is
+        /// passed. If enabled, invalidateOrdering() must be called
+        /// whenever the values of that array change. By default the
+        /// ordering is recomputed once per call.
+        void setReuseOrdering(const bool reuse_ordering);
+
     private:
         void executeSolve();
         virtual void solveSingleCell(const int cell);
+        void solveSingleCellTracers(const int cell, double* cell_tracer) const;
         void solveSingleCellMultidimUpwind(const int cell);
         void assembleSingleCell(const int cell,
                                 std::vector<int>& local_column,
@@ -100,6 +108,8 @@ namespace Opm
         const double* porevolume_;  // one volume per cell
         const double* source_;      // one volumetric source term per cell
         double* tof_;
+        double* tracer_;   // num_tracers_ per cell, cell-major
+        int num_tracers_;
         bool compute_tracer_;
         enum { NoTracerHead = -1 };
         std::vector<int> tracerhead_by_cell_;
@@ -110,6 +120,7 @@ namespace Opm
         int max_iter_multicell_;
         // For multidim upwinding:
         bool use_multidim_upwind_;
+        bool reuse_ordering_;
         std::vector<double> face_tof_;       // For multidim upwind face tofs.
         std::vector<double> face_part_tof_;  // For multidim upwind face tofs.
     };
@@ -22,6 +22,7 @@
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/linalg/call_umfpack.h>
+#include <opm/core/utility/Profiler.hpp>
 
 namespace Opm
 {
@@ -38,7 +39,10 @@ namespace Opm
                                  const double* rhs,
                                  double* solution) const
     {
-        return solve(A->m, A->nnz, A->ia, A->ja, A->sa, rhs, solution);
+        ProfileScope scope("linear_solve");
+        const LinearSolverReport report = solve(A->m, A->nnz, A->ia, A->ja, A->sa, rhs, solution);
+        Profiler::instance().addIterations(report.iterations);
+        return report;
     }
 
 } // namespace Opm
@@ -53,9 +53,11 @@
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <type_traits>
+#include <vector>
 
 namespace Opm
 {
@@ -92,10 +94,82 @@ namespace Opm
         template<class O, class S, class C>
         LinearSolverInterface::LinearSolverReport
         solveBiCGStab_ILU0(O& A, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity);
+
+        typedef Dune::Preconditioner<Vector,Vector> SeqPreconditioner;
+
+        /// Forwards to a stored preconditioner, giving the solvers the
+        /// sequential category they check for at compile time.
+        class ReusedPreconditioner : public SeqPreconditioner
+        {
+        public:
+            enum { category = Dune::SolverCategory::sequential };
+
+            explicit ReusedPreconditioner(SeqPreconditioner& precond)
+                : precond_(precond)
+            {}
+
+            virtual void pre(Vector& x, Vector& b) { precond_.pre(x, b); }
+            virtual void apply(Vector& v, const Vector& d) { precond_.apply(v, d); }
+            virtual void post(Vector& x) { precond_.post(x); }
+
+        private:
+            SeqPreconditioner& precond_;
+        };
+
+        // The AMG hierarchies keep a reference to comm, which must
+        // therefore live as long as the returned preconditioner.
+        std::shared_ptr<SeqPreconditioner>
+        makeAMGPreconditioner(Operator& opA, const Dune::Amg::SequentialInformation& comm,
+                              int verbosity, double prolongateFactor, int smoothsteps);
+
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+        std::shared_ptr<SeqPreconditioner>
+        makeKAMGPreconditioner(Operator& opA, const Dune::Amg::SequentialInformation& comm,
+                               int verbosity, double prolongateFactor, int smoothsteps);
+
+        std::shared_ptr<SeqPreconditioner>
+        makeFastAMGPreconditioner(Operator& opA, const Dune::Amg::SequentialInformation& comm,
+                                  int verbosity, double prolongateFactor);
+#endif
+
+        void saveSystem(const Mat& A, const Vector& b, const std::string& filename);
     } // anonymous namespace
 
 
 
+    /// Matrix (and optionally preconditioner) kept between calls to
+    /// solve() when reuse is enabled.
+    struct LinearSolverIstl::ReuseData
+    {
+        ReuseData() : solves_since_setup(0), setup_iterations(-1) {}
+
+        /// True if ia/ja describe the pattern of the cached matrix.
+        bool samePattern(const int size, const int nonzeros,
+                         const int* ia, const int* ja) const
+        {
+            return A
+                && int(pattern_ia.size()) == size + 1
+                && int(pattern_ja.size()) == nonzeros
+                && std::equal(pattern_ia.begin(), pattern_ia.end(), ia)
+                && std::equal(pattern_ja.begin(), pattern_ja.end(), ja);
+        }
+
+        std::vector<int> pattern_ia;
+        std::vector<int> pattern_ja;
+        std::unique_ptr<Mat> A;
+        // Address of the matrix value of each CSR entry.
+        std::vector<double*> entries;
+        std::unique_ptr<Operator> opA;
+        // Referenced by the AMG preconditioners, so it is declared
+        // (and destroyed) before precond.
+        Dune::Amg::SequentialInformation seq_comm;
+        std::shared_ptr<SeqPreconditioner> precond;
+        int solves_since_setup;
+        int setup_iterations;
+    };
+
+
+
 
     LinearSolverIstl::LinearSolverIstl()
         : linsolver_residual_tolerance_(1e-8),
@@ -104,7 +178,10 @@ namespace Opm
           linsolver_save_system_(false),
           linsolver_max_iterations_(0),
           linsolver_smooth_steps_(2),
-          linsolver_prolongate_factor_(1.6)
+          linsolver_prolongate_factor_(1.6),
+          linsolver_reuse_matrix_(false),
+          linsolver_reuse_preconditioner_(0),
+          linsolver_reuse_max_iteration_growth_(2.0)
     {
     }
 
@@ -118,7 +195,10 @@ namespace Opm
           linsolver_save_system_(false),
           linsolver_max_iterations_(0),
           linsolver_smooth_steps_(2),
-          linsolver_prolongate_factor_(1.6)
+          linsolver_prolongate_factor_(1.6),
+          linsolver_reuse_matrix_(false),
+          linsolver_reuse_preconditioner_(0),
+          linsolver_reuse_max_iteration_growth_(2.0)
     {
         linsolver_residual_tolerance_ = param.getDefault("linsolver_residual_tolerance", linsolver_residual_tolerance_);
         linsolver_verbosity_ = param.getDefault("linsolver_verbosity", linsolver_verbosity_);
@@ -130,6 +210,10 @@ namespace Opm
         linsolver_max_iterations_ = param.getDefault("linsolver_max_iterations", linsolver_max_iterations_);
         linsolver_smooth_steps_ = param.getDefault("linsolver_smooth_steps", linsolver_smooth_steps_);
         linsolver_prolongate_factor_ = param.getDefault("linsolver_prolongate_factor", linsolver_prolongate_factor_);
+        linsolver_reuse_matrix_ = param.getDefault("linsolver_reuse_matrix", linsolver_reuse_matrix_);
+        linsolver_reuse_preconditioner_ = param.getDefault("linsolver_reuse_preconditioner", linsolver_reuse_preconditioner_);
+        linsolver_reuse_max_iteration_growth_ = param.getDefault("linsolver_reuse_max_iteration_growth",
+                                                                 linsolver_reuse_max_iteration_growth_);
     }
 
     LinearSolverIstl::~LinearSolverIstl()
@@ -145,6 +229,21 @@ namespace Opm
                             double* solution,
                             const boost::any& comm) const
     {
+        int maxit = linsolver_max_iterations_;
+        if (maxit == 0) {
+            maxit = 5000;
+        }
+
+        // Matrix and preconditioner reuse is only offered for the
+        // sequential solvers.
+        bool sequential = true;
+#if HAVE_MPI
+        sequential = comm.type() != typeid(ParallelISTLInformation);
+#endif
+        if (sequential && (linsolver_reuse_matrix_ || linsolver_reuse_preconditioner_ > 0)) {
+            return solveWithReuse(size, nonzeros, ia, ja, sa, rhs, solution, maxit);
+        }
+
         // Build Istl structures from input.
         // System matrix
         Mat A(size, size, nonzeros, Mat::row_wise);
@@ -160,10 +259,6 @@ namespace Opm
             }
         }
 
-        int maxit = linsolver_max_iterations_;
-        if (maxit == 0) {
-            maxit = 5000;
-        }
 #if HAVE_MPI
         if(comm.type()==typeid(ParallelISTLInformation))
         {
@@ -187,6 +282,147 @@ namespace Opm
         }
     }
 
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveWithReuse(const int size,
+                                     const int nonzeros,
+                                     const int* ia,
+                                     const int* ja,
+                                     const double* sa,
+                                     const double* rhs,
+                                     double* solution,
+                                     int maxit) const
+    {
+        if (!reuse_) {
+            reuse_.reset(new ReuseData);
+        }
+        ReuseData& data = *reuse_;
+
+        if (data.samePattern(size, nonzeros, ia, ja)) {
+            // Only the values changed: overwrite them in place.
+            for (int i = 0; i < nonzeros; ++i) {
+                *data.entries[i] = sa[i];
+            }
+        } else {
+            // New sparsity pattern: build the matrix and forget any
+            // preconditioner that refers to the old one.
+            data.precond.reset();
+            data.opA.reset();
+            data.A.reset(new Mat(size, size, nonzeros, Mat::row_wise));
+            Mat& A = *data.A;
+            for (Mat::CreateIterator row = A.createbegin(); row != A.createend(); ++row) {
+                int ri = row.index();
+                for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
+                    row.insert(ja[i]);
+                }
+            }
+            data.entries.resize(nonzeros);
+            for (int ri = 0; ri < size; ++ri) {
+                for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
+                    data.entries[i] = &A[ri][ja[i]][0][0];
+                    *data.entries[i] = sa[i];
+                }
+            }
+            data.pattern_ia.assign(ia, ia + size + 1);
+            data.pattern_ja.assign(ja, ja + nonzeros);
+            data.opA.reset(new Operator(A));
+        }
+
+        if (linsolver_reuse_preconditioner_ <= 0) {
+            Dune::SeqScalarProduct<Vector> sp;
+            Dune::Amg::SequentialInformation seq_comm;
+            return solveSystem(*data.opA, solution, rhs, sp, seq_comm, maxit);
+        }
+
+        // Set up a new preconditioner if there is none or the current
+        // one has been used the requested number of times.
+        if (!data.precond || data.solves_since_setup >= linsolver_reuse_preconditioner_) {
+            switch (linsolver_type_) {
+            case CG_ILU0:
+            case BiCGStab_ILU0:
+                data.precond.reset(new Dune::SeqILU0<Mat,Vector,Vector>(*data.A, 1.0));
+                break;
+            case CG_AMG:
+                data.precond = makeAMGPreconditioner(*data.opA, data.seq_comm, linsolver_verbosity_,
+                                                     linsolver_prolongate_factor_, linsolver_smooth_steps_);
+                break;
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+            case KAMG:
+                data.precond = makeKAMGPreconditioner(*data.opA, data.seq_comm, linsolver_verbosity_,
+                                                      linsolver_prolongate_factor_, linsolver_smooth_steps_);
+                break;
+            case FastAMG:
+                data.precond = makeFastAMGPreconditioner(*data.opA, data.seq_comm, linsolver_verbosity_,
+                                                         linsolver_prolongate_factor_);
+                break;
+#else
+            case KAMG:
+                throw std::runtime_error("KAMG not supported with this version of DUNE");
+            case FastAMG:
+                data.precond = makeAMGPreconditioner(*data.opA, data.seq_comm, linsolver_verbosity_,
+                                                     linsolver_prolongate_factor_, linsolver_smooth_steps_);
+                break;
+#endif
+            default:
+                std::cerr << "Unknown linsolver_type: " << int(linsolver_type_) << '\n';
+                throw std::runtime_error("Unknown linsolver_type");
+            }
+            data.solves_since_setup = 0;
+            data.setup_iterations = -1;
+        }
+
+        // System RHS and solution.
+        Vector b(size);
+        std::copy(rhs, rhs + size, b.begin());
+        Vector x(size);
+        x = 0.0;
+        if (linsolver_save_system_) {
+            saveSystem(*data.A, b, linsolver_save_filename_);
+        }
+
+        ReusedPreconditioner precond(*data.precond);
+        Dune::SeqScalarProduct<Vector> sp;
+        Dune::InverseOperatorResult result;
+        switch (linsolver_type_) {
+        case BiCGStab_ILU0: {
+            Dune::BiCGSTABSolver<Vector> linsolve(*data.opA, sp, precond, linsolver_residual_tolerance_,
+                                                  maxit, linsolver_verbosity_);
+            linsolve.apply(x, b, result);
+            break;
+        }
+        case KAMG:
+        case FastAMG: {
+            Dune::GeneralizedPCGSolver<Vector> linsolve(*data.opA, precond, linsolver_residual_tolerance_,
+                                                        maxit, linsolver_verbosity_);
+            linsolve.apply(x, b, result);
+            break;
+        }
+        default: {
+            Dune::CGSolver<Vector> linsolve(*data.opA, sp, precond, linsolver_residual_tolerance_,
+                                            maxit, linsolver_verbosity_);
+            linsolve.apply(x, b, result);
+            break;
+        }
+        }
+        std::copy(x.begin(), x.end(), solution);
+
+        // Book-keeping for the next call: a failed solve or a clear
+        // growth in iterations invalidates the preconditioner.
+        ++data.solves_since_setup;
+        if (data.setup_iterations < 0) {
+            data.setup_iterations = result.iterations;
+        }
+        if (!result.converged
+            || result.iterations > linsolver_reuse_max_iteration_growth_ * std::max(data.setup_iterations, 1)) {
+            data.precond.reset();
+        }
+
+        LinearSolverReport res;
+        res.converged = result.converged;
+        res.iterations = result.iterations;
+        res.residual_reduction = result.reduction;
+        return res;
+    }
+
     template<class O, class S, class C>
     LinearSolverInterface::LinearSolverReport
     LinearSolverIstl::solveSystem (O& opA, double* solution, const double* rhs,
@@ -203,14 +439,7 @@ namespace Opm
 
         if (linsolver_save_system_)
         {
-            // Save system to files.
-            writeMatrixToMatlab(opA.getmat(), linsolver_save_filename_ + "-mat");
-            std::string rhsfile(linsolver_save_filename_ + "-rhs");
-            std::ofstream rhsf(rhsfile.c_str());
-            rhsf.precision(15);
-            rhsf.setf(std::ios::scientific | std::ios::showpos);
-            std::copy(b.begin(), b.end(),
-                      std::ostream_iterator<VectorBlockType>(rhsf, "\n"));
+            saveSystem(opA.getmat(), b, linsolver_save_filename_);
         }
 
         LinearSolverReport res;
@@ -344,6 +573,30 @@ namespace Opm
 #define SMOOTHER_ILU 0
 #define ANISOTROPIC_3D 0
 
+    // Coarsening criteria and smoother shared by the AMG variants.
+#if FIRST_DIAGONAL
+    typedef Dune::Amg::FirstDiagonal CouplingMetric;
+#else
+    typedef Dune::Amg::RowSum        CouplingMetric;
+#endif
+
+#if SYMMETRIC
+    typedef Dune::Amg::SymmetricCriterion<Mat,CouplingMetric>   CriterionBase;
+#else
+    typedef Dune::Amg::UnSymmetricCriterion<Mat,CouplingMetric> CriterionBase;
+#endif
+    typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
+
+    typedef Dune::Amg::AggregationCriterion<Dune::Amg::SymmetricMatrixDependency<Mat,CouplingMetric> >
+    FastCriterionBase;
+    typedef Dune::Amg::CoarsenCriterion<FastCriterionBase> FastCriterion;
+
+#if SMOOTHER_ILU
+    typedef Dune::SeqILU0<Mat,Vector,Vector>        SeqSmoother;
+#else
+    typedef Dune::SeqSOR<Mat,Vector,Vector>        SeqSmoother;
+#endif
+
     template<typename C>
     void setUpCriterion(C& criterion, double linsolver_prolongate_factor,
                         int verbosity, std::size_t linsolver_smooth_steps)
@@ -364,26 +617,7 @@ namespace Opm
                 double linsolver_prolongate_factor, int linsolver_smooth_steps)
     {
         // Solve with AMG solver.
-
-#if FIRST_DIAGONAL
-        typedef Dune::Amg::FirstDiagonal CouplingMetric;
-#else
-        typedef Dune::Amg::RowSum        CouplingMetric;
-#endif
-
-#if SYMMETRIC
-        typedef Dune::Amg::SymmetricCriterion<Mat,CouplingMetric>   CriterionBase;
-#else
-        typedef Dune::Amg::UnSymmetricCriterion<Mat,CouplingMetric> CriterionBase;
-#endif
-
-#if SMOOTHER_ILU
-        typedef Dune::SeqILU0<Mat,Vector,Vector>        SeqSmoother;
-#else
-        typedef Dune::SeqSOR<Mat,Vector,Vector>        SeqSmoother;
-#endif
         typedef typename SmootherChooser<SeqSmoother, O, C>::Type Smoother;
-        typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
         typedef Dune::Amg::AMG<O,Vector,Smoother,C>   Precond;
 
         // Construct preconditioner.
@@ -417,26 +651,7 @@ namespace Opm
     {
         // Solve with AMG solver.
         Dune::MatrixAdapter<typename O::matrix_type,Vector,Vector> sOpA(opA.getmat());
-
-#if FIRST_DIAGONAL
-        typedef Dune::Amg::FirstDiagonal CouplingMetric;
-#else
-        typedef Dune::Amg::RowSum        CouplingMetric;
-#endif
-
-#if SYMMETRIC
-        typedef Dune::Amg::SymmetricCriterion<Mat,CouplingMetric>   CriterionBase;
-#else
-        typedef Dune::Amg::UnSymmetricCriterion<Mat,CouplingMetric> CriterionBase;
-#endif
-
-#if SMOOTHER_ILU
-        typedef Dune::SeqILU0<Mat,Vector,Vector>        Smoother;
-#else
-        typedef Dune::SeqSOR<Mat,Vector,Vector>        Smoother;
-#endif
-        typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
-        typedef Dune::Amg::KAMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation>   Precond;
+        typedef Dune::Amg::KAMG<Operator,Vector,SeqSmoother,Dune::Amg::SequentialInformation>   Precond;
 
         // Construct preconditioner.
         Precond::SmootherArgs smootherArgs;
@@ -468,24 +683,10 @@ namespace Opm
         // Solve with AMG solver.
         typedef Dune::MatrixAdapter<typename O::matrix_type, Vector, Vector> AMGOperator;
         AMGOperator sOpA(opA.getmat());
-
-#if FIRST_DIAGONAL
-        typedef Dune::Amg::FirstDiagonal CouplingMetric;
-#else
-        typedef Dune::Amg::RowSum        CouplingMetric;
-#endif
-
-#if SYMMETRIC
-        typedef Dune::Amg::AggregationCriterion<Dune::Amg::SymmetricMatrixDependency<Mat,CouplingMetric> > CriterionBase;
-#else
-        typedef Dune::Amg::AggregationCriterion<Dune::Amg::SymmetricMatrixDependency<Mat,CouplingMetric> > CriterionBase;
-#endif
-
-        typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
         typedef Dune::Amg::FastAMG<AMGOperator, Vector>   Precond;
 
         // Construct preconditioner.
-        Criterion criterion;
+        FastCriterion criterion;
         const int smooth_steps = 1;
         setUpCriterion(criterion, linsolver_prolongate_factor, verbosity, smooth_steps);
         Dune::Amg::Parameters parms;
@@ -511,6 +712,68 @@ namespace Opm
     }
 #endif
 
+    void saveSystem(const Mat& A, const Vector& b, const std::string& filename)
+    {
+        // Save system to files.
+        writeMatrixToMatlab(A, filename + "-mat");
+        std::string rhsfile(filename + "-rhs");
+        std::ofstream rhsf(rhsfile.c_str());
+        rhsf.precision(15);
+        rhsf.setf(std::ios::scientific | std::ios::showpos);
+        std::copy(b.begin(), b.end(),
+                  std::ostream_iterator<VectorBlockType>(rhsf, "\n"));
+    }
+
+    std::shared_ptr<SeqPreconditioner>
+    makeAMGPreconditioner(Operator& opA, const Dune::Amg::SequentialInformation& comm,
+                          int verbosity, double linsolver_prolongate_factor, int linsolver_smooth_steps)
+    {
+        typedef Dune::Amg::AMG<Operator,Vector,SeqSmoother,Dune::Amg::SequentialInformation>   Precond;
+
+        Criterion criterion;
+        Precond::SmootherArgs smootherArgs;
+        setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
+                       linsolver_smooth_steps);
+        return std::make_shared<Precond>(opA, criterion, smootherArgs, comm);
+    }
+
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+    std::shared_ptr<SeqPreconditioner>
+    makeKAMGPreconditioner(Operator& opA, const Dune::Amg::SequentialInformation& comm,
+                           int verbosity, double linsolver_prolongate_factor, int linsolver_smooth_steps)
+    {
+        typedef Dune::Amg::KAMG<Operator,Vector,SeqSmoother,Dune::Amg::SequentialInformation>   Precond;
+
+        Precond::SmootherArgs smootherArgs;
+        Criterion criterion;
+        setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
+                       linsolver_smooth_steps);
+        // The default arguments of KAMG, apart from the parallel information.
+        const std::size_t gamma = 1, pre_smooth = 1, post_smooth = 1, max_krylov_steps = 3;
+        const double min_defect_reduction = 1e-1;
+        return std::make_shared<Precond>(opA, criterion, smootherArgs, gamma, pre_smooth, post_smooth,
+                                         max_krylov_steps, min_defect_reduction, comm);
+    }
+
+    std::shared_ptr<SeqPreconditioner>
+    makeFastAMGPreconditioner(Operator& opA, const Dune::Amg::SequentialInformation& comm,
+                              int verbosity, double linsolver_prolongate_factor)
+    {
+        typedef Dune::Amg::FastAMG<Operator, Vector>   Precond;
+
+        FastCriterion criterion;
+        const int smooth_steps = 1;
+        setUpCriterion(criterion, linsolver_prolongate_factor, verbosity, smooth_steps);
+        Dune::Amg::Parameters parms;
+        parms.setDebugLevel(verbosity);
+        parms.setNoPreSmoothSteps(smooth_steps);
+        parms.setNoPostSmoothSteps(smooth_steps);
+        parms.setProlongationDampingFactor(linsolver_prolongate_factor);
+        const bool symmetric = true;
+        return std::make_shared<Precond>(opA, criterion, parms, symmetric, comm);
+    }
+#endif
+
     template<class O, class S, class C>
     LinearSolverInterface::LinearSolverReport
     solveBiCGStab_ILU0(O& opA, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity)
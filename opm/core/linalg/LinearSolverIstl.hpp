@@ -23,6 +23,7 @@
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <memory>
 #include <string>
 #include <boost/any.hpp>
 
@@ -47,6 +48,15 @@ namespace Opm
         ///   linsolver_smooth_steps        2
         ///   linsolver_prolongate_factor   1.6
         ///   linsolver_verbosity           0
+        ///   linsolver_reuse_matrix        false (keep the ISTL matrix between
+        ///                                 solves while ia/ja are unchanged)
+        ///   linsolver_reuse_preconditioner 0 (number of solves a preconditioner
+        ///                                 setup is reused for; 0 rebuilds it
+        ///                                 every solve, > 0 implies matrix reuse)
+        ///   linsolver_reuse_max_iteration_growth 2.0 (rebuild a reused
+        ///                                 preconditioner once the iteration
+        ///                                 count exceeds this factor times
+        ///                                 the count right after setup)
         LinearSolverIstl();
 
         /// Construct from parameters
@@ -97,6 +107,17 @@ namespace Opm
         LinearSolverReport solveSystem(O& opA, double* solution, const double *rhs,
                                        S& sp, const C& comm, int maxit) const;
 
+        /// \brief Solve the sequential linear system with a cached
+        /// matrix and, if requested, a cached preconditioner.
+        LinearSolverReport solveWithReuse(const int size,
+                                          const int nonzeros,
+                                          const int* ia,
+                                          const int* ja,
+                                          const double* sa,
+                                          const double* rhs,
+                                          double* solution,
+                                          int maxit) const;
+
         double linsolver_residual_tolerance_;
         int linsolver_verbosity_;
         enum LinsolverType { CG_ILU0 = 0, CG_AMG = 1, BiCGStab_ILU0 = 2, FastAMG=3, KAMG=4 };
@@ -108,7 +129,15 @@ namespace Opm
         int linsolver_smooth_steps_;
         /** \brief The factor to scale the coarse grid correction with. */
         double linsolver_prolongate_factor_;
-
+        /** \brief Whether to keep the matrix while its pattern is unchanged. */
+        bool linsolver_reuse_matrix_;
+        /** \brief The number of solves to reuse a preconditioner setup for. */
+        int linsolver_reuse_preconditioner_;
+        /** \brief The iteration growth factor that forces a new setup. */
+        double linsolver_reuse_max_iteration_growth_;
+
+        struct ReuseData;
+        mutable std::unique_ptr<ReuseData> reuse_;
     };
 
 
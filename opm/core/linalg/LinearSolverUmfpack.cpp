@@ -21,12 +21,17 @@
 #include <opm/core/linalg/LinearSolverUmfpack.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/linalg/call_umfpack.h>
+#include <opm/common/ErrorMacros.hpp>
 
 namespace Opm
 {
 
     LinearSolverUmfpack::LinearSolverUmfpack()
+        : handle_(call_UMFPACK_handle_create())
     {
+        if (!handle_) {
+            OPM_THROW(std::runtime_error, "Failed to construct UMFPACK solver handle.");
+        }
     }
 
 
@@ -34,6 +39,7 @@ namespace Opm
 
     LinearSolverUmfpack::~LinearSolverUmfpack()
     {
+        call_UMFPACK_handle_destroy(handle_);
     }
 
 
@@ -56,7 +62,10 @@ namespace Opm
             const_cast<int*>(ja),
             const_cast<double*>(sa)
         };
-        call_UMFPACK(&A, rhs, solution);
+        const int status = call_UMFPACK_handle_solve(handle_, &A, rhs, solution);
+        if (status < 0) {
+            OPM_THROW(std::runtime_error, "UMFPACK failed with status " << status);
+        }
         LinearSolverReport rep = {};
         rep.converged = true;
         return rep;
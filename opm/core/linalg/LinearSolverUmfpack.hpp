@@ -23,12 +23,15 @@
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 
+struct UMFPACKHandle;
 
 namespace Opm
 {
 
 
     /// Concrete class encapsulating the UMFPACK direct linear solver.
+    /// The symbolic factorization is kept between calls to solve()
+    /// for as long as the sparsity pattern does not change.
     class LinearSolverUmfpack : public LinearSolverInterface
     {
     public:
@@ -68,7 +71,12 @@ namespace Opm
         /// Not used for UMFPACK solver. Returns -1.
         virtual double getTolerance() const;
 
+    private:
+        // No copying: the factorization handle is owned.
+        LinearSolverUmfpack(const LinearSolverUmfpack&);
+        LinearSolverUmfpack& operator=(const LinearSolverUmfpack&);
 
+        UMFPACKHandle* handle_;
     };
 
 
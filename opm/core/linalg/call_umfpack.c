@@ -36,6 +36,7 @@
 #include "config.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <umfpack.h>
 
@@ -183,3 +184,279 @@ call_UMFPACK(struct CSRMatrix *A, const double *b, double *x)
     csc_deallocate(csc);
 }
 
+
+struct UMFPACKHandle {
+    /* Pattern the cached data was built for */
+    int      m;
+    int      nnz;
+    int     *ia;
+    int     *ja;
+
+    /* Column pointers and row indices passed to UMFPACK.  When
+     * 'transposed' is set, these describe the CSR pattern itself,
+     * interpreted as the CSC form of A^T, and the CSR values are
+     * passed to UMFPACK without copying.  Otherwise 'p' and 'i' hold
+     * the CSC pattern of A, 'perm' maps CSR entries to CSC positions
+     * and 'x' receives the permuted values. */
+    int      transposed;
+    UF_long *p;
+    UF_long *i;
+    UF_long *perm;
+    double  *x;
+
+    void    *Symbolic;
+    void    *Numeric;
+    double   Control[UMFPACK_CONTROL];
+
+    int      keep_factors;
+};
+
+
+/* ---------------------------------------------------------------------- */
+static void
+handle_release_pattern(struct UMFPACKHandle *h)
+/* ---------------------------------------------------------------------- */
+{
+    if (h->Numeric != NULL) {
+        umfpack_dl_free_numeric(&h->Numeric);
+    }
+
+    if (h->Symbolic != NULL) {
+        umfpack_dl_free_symbolic(&h->Symbolic);
+    }
+
+    free(h->x);    free(h->perm);
+    free(h->i);    free(h->p);
+    free(h->ja);   free(h->ia);
+
+    h->x  = NULL;  h->perm = NULL;
+    h->i  = NULL;  h->p    = NULL;
+    h->ja = NULL;  h->ia   = NULL;
+
+    h->m  = h->nnz = 0;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+same_pattern(const struct UMFPACKHandle *h, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    int nnz;
+
+    if ((h->ia == NULL) || (h->m != (int) A->m)) {
+        return 0;
+    }
+
+    nnz = A->ia[A->m];
+
+    return (h->nnz == nnz) &&
+        (memcmp(h->ia, A->ia, (A->m + 1) * sizeof *A->ia) == 0) &&
+        (memcmp(h->ja, A->ja, nnz        * sizeof *A->ja) == 0);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+strictly_sorted_rows(const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    size_t r;
+    int    k, ok;
+
+    for (r = 0, ok = 1; ok && (r < A->m); r++) {
+        for (k = A->ia[r] + 1; ok && (k < A->ia[r + 1]); k++) {
+            ok = A->ja[k - 1] < A->ja[k];
+        }
+    }
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+handle_setup_pattern(struct UMFPACKHandle *h, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    int     r, k, m, nnz, status;
+    UF_long *cnt;
+
+    handle_release_pattern(h);
+
+    m   = (int) A->m;
+    nnz = A->ia[m];
+
+    h->ia = malloc((m + 1) * sizeof *h->ia);
+    h->ja = malloc(nnz     * sizeof *h->ja);
+    h->p  = malloc((m + 1) * sizeof *h->p);
+    h->i  = malloc(nnz     * sizeof *h->i);
+
+    if ((h->ia == NULL) || (h->ja == NULL) ||
+        (h->p  == NULL) || (h->i  == NULL)) {
+        handle_release_pattern(h);
+        return -1;
+    }
+
+    memcpy(h->ia, A->ia, (m + 1) * sizeof *h->ia);
+    memcpy(h->ja, A->ja, nnz     * sizeof *h->ja);
+
+    h->transposed = strictly_sorted_rows(A);
+
+    if (h->transposed) {
+        /* The CSR arrays of A are the CSC arrays of A^T. */
+        for (r = 0; r <= m; r++) { h->p[r] = A->ia[r]; }
+        for (k = 0; k < nnz; k++) { h->i[k] = A->ja[k]; }
+    }
+    else {
+        h->perm = malloc(nnz     * sizeof *h->perm);
+        h->x    = malloc(nnz     * sizeof *h->x);
+        cnt     = malloc((m + 1) * sizeof *cnt);
+
+        if ((h->perm == NULL) || (h->x == NULL) || (cnt == NULL)) {
+            free(cnt);
+            handle_release_pattern(h);
+            return -1;
+        }
+
+        /* Column start pointers, as in csr_to_csc() */
+        for (r = 0; r <= m; r++) { h->p[r] = 0; }
+        for (k = 0; k < nnz; k++) { h->p[ A->ja[k] + 1 ] += 1; }
+        for (r = 0; r < m; r++) { h->p[r + 1] += h->p[r]; }
+
+        /* Row-major traversal yields sorted row indices per column */
+        memcpy(cnt, h->p, (m + 1) * sizeof *cnt);
+        for (r = k = 0; r < m; r++) {
+            for (; k < A->ia[r + 1]; k++) {
+                h->perm[k] = cnt[ A->ja[k] ]++;
+                h->i[ h->perm[k] ] = r;
+            }
+        }
+
+        free(cnt);
+    }
+
+    h->m   = m;
+    h->nnz = nnz;
+
+    status = umfpack_dl_symbolic(m, m, h->p, h->i, NULL,
+                                 &h->Symbolic, h->Control, NULL);
+
+    if (status < UMFPACK_OK) {
+        handle_release_pattern(h);
+    }
+
+    return status;
+}
+
+
+/*---------------------------------------------------------------------------*/
+struct UMFPACKHandle *
+call_UMFPACK_handle_create(void)
+/*---------------------------------------------------------------------------*/
+{
+    struct UMFPACKHandle *h;
+
+    h = malloc(1 * sizeof *h);
+
+    if (h != NULL) {
+        h->m  = h->nnz = 0;
+        h->ia = h->ja = NULL;
+
+        h->transposed = 0;
+        h->p    = h->i = NULL;
+        h->perm = NULL;
+        h->x    = NULL;
+
+        h->Symbolic = h->Numeric = NULL;
+        umfpack_dl_defaults(h->Control);
+
+        h->keep_factors = 0;
+    }
+
+    return h;
+}
+
+
+/*---------------------------------------------------------------------------*/
+void
+call_UMFPACK_handle_destroy(struct UMFPACKHandle *h)
+/*---------------------------------------------------------------------------*/
+{
+    if (h != NULL) {
+        handle_release_pattern(h);
+    }
+
+    free(h);
+}
+
+
+/*---------------------------------------------------------------------------*/
+void
+call_UMFPACK_handle_keep_factors(struct UMFPACKHandle *h, int keep)
+/*---------------------------------------------------------------------------*/
+{
+    h->keep_factors = keep;
+}
+
+
+/*---------------------------------------------------------------------------*/
+void
+call_UMFPACK_handle_refactor(struct UMFPACKHandle *h)
+/*---------------------------------------------------------------------------*/
+{
+    if (h->Numeric != NULL) {
+        umfpack_dl_free_numeric(&h->Numeric);
+    }
+}
+
+
+/*---------------------------------------------------------------------------*/
+int
+call_UMFPACK_handle_solve(struct UMFPACKHandle *h,
+                          struct CSRMatrix     *A,
+                          const double         *b,
+                          double               *x)
+/*---------------------------------------------------------------------------*/
+{
+    int     k, status;
+    double *Ax;
+
+    status = UMFPACK_OK;
+
+    if (! same_pattern(h, A)) {
+        status = handle_setup_pattern(h, A);
+    }
+
+    if (status < UMFPACK_OK) {
+        return status;
+    }
+
+    if (h->transposed) {
+        Ax = A->sa;
+    }
+    else {
+        for (k = 0; k < h->nnz; k++) {
+            h->x[ h->perm[k] ] = A->sa[k];
+        }
+        Ax = h->x;
+    }
+
+    if ((h->Numeric != NULL) && ! h->keep_factors) {
+        umfpack_dl_free_numeric(&h->Numeric);
+    }
+
+    if (h->Numeric == NULL) {
+        status = umfpack_dl_numeric(h->p, h->i, Ax, h->Symbolic,
+                                    &h->Numeric, h->Control, NULL);
+    }
+
+    /* Warnings, e.g. singular matrix, still leave usable factors */
+    if (status >= UMFPACK_OK) {
+        status = umfpack_dl_solve(h->transposed ? UMFPACK_At : UMFPACK_A,
+                                  h->p, h->i, Ax, x, b,
+                                  h->Numeric, h->Control, NULL);
+    }
+
+    return status;
+}
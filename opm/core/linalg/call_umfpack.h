@@ -43,6 +43,74 @@ struct CSRMatrix;
 
 void call_UMFPACK(struct CSRMatrix *A, const double *b, double *x);
 
+
+/**
+ * Persistent UMFPACK solver state for a sequence of systems sharing the
+ * same sparsity pattern.  The symbolic factorization and the CSR to CSC
+ * conversion are computed once per pattern, subsequent solves only
+ * perform the numeric factorization.
+ */
+struct UMFPACKHandle;
+
+/**
+ * Create an empty solver handle.
+ *
+ * @return Handle, NULL in case of allocation failure.  Dispose of
+ * the handle using call_UMFPACK_handle_destroy().
+ */
+struct UMFPACKHandle *
+call_UMFPACK_handle_create(void);
+
+/**
+ * Release all resources held by a solver handle.
+ *
+ * @param[in,out] h Solver handle.  NULL is allowed.
+ */
+void
+call_UMFPACK_handle_destroy(struct UMFPACKHandle *h);
+
+/**
+ * Control whether the numeric factorization is kept between solves.
+ *
+ * When enabled, call_UMFPACK_handle_solve() reuses the existing
+ * factors until the pattern changes or call_UMFPACK_handle_refactor()
+ * is called.  This is appropriate for repeated right-hand sides with
+ * an unchanged matrix.  Disabled by default.
+ *
+ * @param[in,out] h    Solver handle.
+ * @param[in]     keep Non-zero to keep the numeric factors.
+ */
+void
+call_UMFPACK_handle_keep_factors(struct UMFPACKHandle *h, int keep);
+
+/**
+ * Force a new numeric factorization at the next solve.
+ *
+ * @param[in,out] h Solver handle.
+ */
+void
+call_UMFPACK_handle_refactor(struct UMFPACKHandle *h);
+
+/**
+ * Solve the system A x = b, reusing whatever state the handle holds
+ * for the sparsity pattern of A.
+ *
+ * @param[in,out] h Solver handle.
+ * @param[in]     A System matrix.
+ * @param[in]     b System right-hand side.
+ * @param[out]    x System solution.
+ *
+ * @return An UMFPACK status code.  Zero on success, negative on
+ * failure (-1 for allocation failure), and positive for a warning,
+ * e.g. a singular matrix.  After a warning @c x holds a solution, but
+ * it may contain non-finite values.
+ */
+int
+call_UMFPACK_handle_solve(struct UMFPACKHandle *h,
+                          struct CSRMatrix     *A,
+                          const double         *b,
+                          double               *x);
+
 #ifdef __cplusplus
 }
 #endif
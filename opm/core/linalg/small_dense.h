@@ -0,0 +1,243 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_SMALL_DENSE_HEADER_INCLUDED
+#define OPM_SMALL_DENSE_HEADER_INCLUDED
+
+/**
+ * \file
+ * Inline kernels for dense matrices with at most three rows, such as
+ * per-cell fluid matrices (one row per phase) and permeability
+ * tensors (one row per dimension).  For such sizes the cost of
+ * calling BLAS or LAPACK dominates the arithmetic.  All matrices are
+ * stored in column major (Fortran) order.
+ *
+ * Callers are expected to check small_dense_supported() and use
+ * BLAS/LAPACK for larger matrices.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Whether the kernels of this file support 'n' rows.
+ *
+ * @param[in] n Number of rows.
+ * @return Non-zero if 1 <= n <= 3.
+ */
+static inline int
+small_dense_supported(int n)
+{
+    return (1 <= n) && (n <= 3);
+}
+
+
+/**
+ * Matrix-matrix product C <- A*B for an n-by-n matrix A and an
+ * n-by-ncol matrix B.  With ncol == 1 this is a matrix-vector
+ * product.  C must not overlap A or B.
+ *
+ * @param[in]  n    Number of rows in A, B and C, 1 <= n <= 3.
+ * @param[in]  ncol Number of columns in B and C.
+ * @param[in]  A    Matrix, n-by-n.
+ * @param[in]  B    Matrix, n-by-ncol.
+ * @param[out] C    Result, n-by-ncol.
+ */
+static inline void
+small_dense_matmat(int n, int ncol, const double *A,
+                   const double *B, double *C)
+{
+    int j;
+
+    switch (n) {
+    case 1:
+        for (j = 0; j < ncol; j++) {
+            C[j] = A[0] * B[j];
+        }
+        break;
+
+    case 2:
+        for (j = 0; j < ncol; j++, B += 2, C += 2) {
+            C[0] = A[0]*B[0] + A[2]*B[1];
+            C[1] = A[1]*B[0] + A[3]*B[1];
+        }
+        break;
+
+    case 3:
+        for (j = 0; j < ncol; j++, B += 3, C += 3) {
+            C[0] = A[0]*B[0] + A[3]*B[1] + A[6]*B[2];
+            C[1] = A[1]*B[0] + A[4]*B[1] + A[7]*B[2];
+            C[2] = A[2]*B[0] + A[5]*B[1] + A[8]*B[2];
+        }
+        break;
+    }
+}
+
+
+/**
+ * In-place matrix-matrix product B <- A*B for an n-by-n matrix A and
+ * an n-by-ncol matrix B.
+ *
+ * @param[in]     n    Number of rows in A and B, 1 <= n <= 3.
+ * @param[in]     ncol Number of columns in B.
+ * @param[in]     A    Matrix, n-by-n.
+ * @param[in,out] B    Matrix, n-by-ncol.
+ */
+static inline void
+small_dense_matmat_inplace(int n, int ncol, const double *A, double *B)
+{
+    int    j;
+    double b[3];
+
+    switch (n) {
+    case 1:
+        for (j = 0; j < ncol; j++) {
+            B[j] *= A[0];
+        }
+        break;
+
+    case 2:
+        for (j = 0; j < ncol; j++, B += 2) {
+            b[0] = B[0];  b[1] = B[1];
+            B[0] = A[0]*b[0] + A[2]*b[1];
+            B[1] = A[1]*b[0] + A[3]*b[1];
+        }
+        break;
+
+    case 3:
+        for (j = 0; j < ncol; j++, B += 3) {
+            b[0] = B[0];  b[1] = B[1];  b[2] = B[2];
+            B[0] = A[0]*b[0] + A[3]*b[1] + A[6]*b[2];
+            B[1] = A[1]*b[0] + A[4]*b[1] + A[7]*b[2];
+            B[2] = A[2]*b[0] + A[5]*b[1] + A[8]*b[2];
+        }
+        break;
+    }
+}
+
+
+/**
+ * Rectangular matrix-vector product y <- A*x for an nrow-by-ncol
+ * matrix A.  Typically used to form a linear combination of ncol
+ * short columns.
+ *
+ * @param[in]  nrow Number of rows in A, 1 <= nrow <= 3.
+ * @param[in]  ncol Number of columns in A.
+ * @param[in]  A    Matrix, nrow-by-ncol.
+ * @param[in]  x    Vector, ncol entries.
+ * @param[out] y    Result, nrow entries.
+ */
+static inline void
+small_dense_matvec(int nrow, int ncol, const double *A,
+                   const double *x, double *y)
+{
+    int    j;
+    double y0, y1, y2;
+
+    y0 = y1 = y2 = 0.0;
+
+    switch (nrow) {
+    case 1:
+        for (j = 0; j < ncol; j++) {
+            y0 += A[j] * x[j];
+        }
+        y[0] = y0;
+        break;
+
+    case 2:
+        for (j = 0; j < ncol; j++, A += 2) {
+            y0 += A[0] * x[j];
+            y1 += A[1] * x[j];
+        }
+        y[0] = y0;  y[1] = y1;
+        break;
+
+    case 3:
+        for (j = 0; j < ncol; j++, A += 3) {
+            y0 += A[0] * x[j];
+            y1 += A[1] * x[j];
+            y2 += A[2] * x[j];
+        }
+        y[0] = y0;  y[1] = y1;  y[2] = y2;
+        break;
+    }
+}
+
+
+/**
+ * Compute the inverse of an n-by-n matrix by cofactor expansion.
+ *
+ * @param[in]  n    Matrix size, 1 <= n <= 3.
+ * @param[in]  A    Matrix, n-by-n.
+ * @param[out] Ainv Inverse of A, n-by-n.  Must not overlap A.
+ * @return Zero on success, non-zero if A is singular.
+ */
+static inline int
+small_dense_invert(int n, const double *A, double *Ainv)
+{
+    double det;
+
+    switch (n) {
+    case 1:
+        if (A[0] == 0.0) { return 1; }
+        Ainv[0] = 1.0 / A[0];
+        break;
+
+    case 2:
+        det = A[0]*A[3] - A[2]*A[1];
+        if (det == 0.0) { return 1; }
+        Ainv[0] =   A[3] / det;
+        Ainv[1] = - A[1] / det;
+        Ainv[2] = - A[2] / det;
+        Ainv[3] =   A[0] / det;
+        break;
+
+    case 3:
+        Ainv[0] = A[4]*A[8] - A[7]*A[5];
+        Ainv[1] = A[7]*A[2] - A[1]*A[8];
+        Ainv[2] = A[1]*A[5] - A[4]*A[2];
+
+        det = A[0]*Ainv[0] + A[3]*Ainv[1] + A[6]*Ainv[2];
+        if (det == 0.0) { return 1; }
+
+        Ainv[3] = A[6]*A[5] - A[3]*A[8];
+        Ainv[4] = A[0]*A[8] - A[6]*A[2];
+        Ainv[5] = A[3]*A[2] - A[0]*A[5];
+        Ainv[6] = A[3]*A[7] - A[6]*A[4];
+        Ainv[7] = A[6]*A[1] - A[0]*A[7];
+        Ainv[8] = A[0]*A[4] - A[3]*A[1];
+
+        Ainv[0] /= det;  Ainv[1] /= det;  Ainv[2] /= det;
+        Ainv[3] /= det;  Ainv[4] /= det;  Ainv[5] /= det;
+        Ainv[6] /= det;  Ainv[7] /= det;  Ainv[8] /= det;
+        break;
+
+    default:
+        return 1;
+    }
+
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* OPM_SMALL_DENSE_HEADER_INCLUDED */
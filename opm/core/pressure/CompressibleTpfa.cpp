@@ -28,6 +28,7 @@
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/Profiler.hpp>
 #include <opm/core/wells.h>
 #include <opm/core/simulator/BlackoilState.hpp>
 #include <opm/core/simulator/WellState.hpp>
@@ -508,6 +509,7 @@ namespace Opm
                                     const BlackoilState& state,
                                     const WellState& well_state)
     {
+        ProfileScope scope("pressure_assemble");
         const double* cell_press = &state.pressure()[0];
         const double* well_bhp = well_state.bhp().empty() ? NULL : &well_state.bhp()[0];
         const double* z = &state.surfacevol()[0];
@@ -33,6 +33,7 @@
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/Profiler.hpp>
 #include <opm/core/wells.h>
 #include <iostream>
 #include <iomanip>
@@ -178,7 +179,11 @@ namespace Opm
 
         // Assemble.
         UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
-        int ok = ifs_tpfa_assemble(gg, &forces_, &trans_[0], &gpress_omegaweighted_[0], h_);
+        int ok = 0;
+        {
+            ProfileScope scope("pressure_assemble");
+            ok = ifs_tpfa_assemble(gg, &forces_, &trans_[0], &gpress_omegaweighted_[0], h_);
+        }
         if (!ok) {
             OPM_THROW(std::runtime_error, "Failed assembling pressure system.");
         }
@@ -400,6 +405,7 @@ namespace Opm
                               const SimulationDataContainer& state,
                               const WellState& /*well_state*/)
     {
+        ProfileScope scope("pressure_assemble");
         const double* pressures = wells_ ? &pressures_[0] : &state.pressure()[0];
 
         bool ok = ifs_tpfa_assemble_comprock_increment(const_cast<UnstructuredGrid*>(&grid_),
@@ -177,7 +177,7 @@ cfsh_construct(struct UnstructuredGrid *G, well_t *W)
  *     fsh->A * fsh->x = fsh->b
  */
 /* ---------------------------------------------------------------------- */
-void
+int
 cfsh_assemble(struct FlowBoundaryConditions *bc,
               const double    *src,
               const double    *Binv,
@@ -196,9 +196,11 @@ cfsh_assemble(struct FlowBoundaryConditions *bc,
     /* Suppress warnings about unused parameters. */
     (void) wctrl;  (void) WI;  (void) BivW;  (void) wdp;
 
-    hybsys_schur_comp_unsymm(h->pimpl->nc,
-                             h->pimpl->gdof_pos,
-                             Binv, Biv, P, h->pimpl->sys);
+    if (! hybsys_schur_comp_unsymm(h->pimpl->nc,
+                                   h->pimpl->gdof_pos,
+                                   Binv, Biv, P, h->pimpl->sys)) {
+        return 0;
+    }
 
     fsh_map_bdry_condition(bc, h->pimpl);
 
@@ -207,4 +209,6 @@ cfsh_assemble(struct FlowBoundaryConditions *bc,
     if (npp == 0) {
         h->A->sa[0] *= 2;        /* Remove zero eigenvalue */
     }
+
+    return 1;
 }
@@ -147,8 +147,11 @@ cfsh_construct(struct UnstructuredGrid *G, well_t *W);
  * @param[in]     BivW   \f$B^{-1}v\f$ for wells.  Ignored.
  * @param[in]     wdp    Gravity pressure along well track.  Ignored.
  * @param[in,out] h      Data object.
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case the system is not formed.
  */
-void
+int
 cfsh_assemble(struct FlowBoundaryConditions *bc,
               const double    *src,
               const double    *Binv,
@@ -195,8 +198,11 @@ ifsh_construct(struct UnstructuredGrid *G, well_t *W);
  * @param[in]     WI     Well indices.
  * @param[in]     wdp    Gravity pressure along well track.
  * @param[in,out] h      Data object.
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case the system is not formed.
  */
-void
+int
 ifsh_assemble(struct FlowBoundaryConditions *bc,
               const double    *src,
               const double    *Binv,
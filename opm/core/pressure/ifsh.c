@@ -349,7 +349,7 @@ ifsh_construct(struct UnstructuredGrid *G, well_t *W)
  * from effective local inner product matrices Binv, effective gravity
  * pressure gpress, boundary conditions bc, and source terms src. */
 /* ---------------------------------------------------------------------- */
-void
+int
 ifsh_assemble(struct FlowBoundaryConditions *bc,
               const double     *src,
               const double     *Binv,
@@ -364,9 +364,11 @@ ifsh_assemble(struct FlowBoundaryConditions *bc,
 
     fsh_map_bdry_condition(bc, ifsh->pimpl);
 
-    hybsys_schur_comp_symm(ifsh->pimpl->nc,
-                           ifsh->pimpl->gdof_pos,
-                           Binv, ifsh->pimpl->sys);
+    if (! hybsys_schur_comp_symm(ifsh->pimpl->nc,
+                                 ifsh->pimpl->gdof_pos,
+                                 Binv, ifsh->pimpl->sys)) {
+        return 0;
+    }
 
     if (ifsh->pimpl->nw > 0) {
         ifsh_set_effective_well_params(WI, wdp, ifsh);
@@ -387,4 +389,6 @@ ifsh_assemble(struct FlowBoundaryConditions *bc,
     if (npp == 0) {
         ifsh->A->sa[0] *= 2;        /* Remove zero eigenvalue */
     }
+
+    return 1;
 }
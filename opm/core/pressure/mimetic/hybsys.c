@@ -25,6 +25,7 @@
 
 #include <opm/core/linalg/blas_lapack.h>
 #include <opm/core/pressure/mimetic/hybsys.h>
+#include <opm/core/pressure/mimetic/mimetic.h>
 
 
 #if defined(MAX)
@@ -243,127 +244,198 @@ hybsys_init(int max_nconn, struct hybsys *sys)
 
 
 /* ---------------------------------------------------------------------- */
-void
-hybsys_schur_comp_symm(int nc, const int *pconn,
-                       const double *Binv, struct hybsys *sys)
+static void
+schur_comp_symm_cell(int c, const int *pconn, const double *Binv,
+                     struct hybsys *sys)
 /* ---------------------------------------------------------------------- */
 {
-    int    c, p1, p2, nconn;
+    int    p1, nconn;
     double a1, a2;
 
     MAT_SIZE_T incx, incy;
     MAT_SIZE_T nrows, ncols, lda;
 
-    incx = incy = 1;
-    p1 = p2 = 0;
+    incx  = incy = 1;
+    p1    = pconn[c + 0];
+    nconn = pconn[c + 1] - pconn[c];
+    nrows = ncols = lda = nconn;
+
+    /* F <- C' * inv(B) == (inv(B) * ones(n,1))' in single cell */
+    a1 = 1.0;  a2 = 0.0;
+    dgemv_("No Transpose"   , &nrows, &ncols,
+           &a1, Binv        , &lda, sys->one, &incx,
+           &a2, &sys->F1[p1],                 &incy);
+
+    /* L <- C' * inv(B) * C == SUM(F) == ones(n,1)' * F */
+    sys->L[c] = ddot_(&nrows, sys->one, &incx, &sys->F1[p1], &incy);
+}
 
-    for (c = 0; c < nc; c++) {
-        p1    = pconn[c + 0];
-        nconn = pconn[c + 1] - pconn[c];
-        nrows = ncols = lda = nconn;
 
-        /* F <- C' * inv(B) == (inv(B) * ones(n,1))' in single cell */
-        a1 = 1.0;  a2 = 0.0;
-        dgemv_("No Transpose"   , &nrows, &ncols,
-               &a1, &Binv[p2]   , &lda, sys->one, &incx,
-               &a2, &sys->F1[p1],                 &incy);
+/* ---------------------------------------------------------------------- */
+int
+hybsys_schur_comp_symm(int nc, const int *pconn,
+                       const double *Binv, struct hybsys *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int ok, *p2;
 
-        /* L <- C' * inv(B) * C == SUM(F) == ones(n,1)' * F */
-        sys->L[c] = ddot_(&nrows, sys->one, &incx, &sys->F1[p1], &incy);
+    p2 = mim_ip_offsets(nc, pconn);
+    ok = p2 != NULL;
 
-        p2 += nconn * nconn;
+    if (ok) {
+        hybsys_schur_comp_symm_cells(nc, NULL, pconn, p2, Binv, sys);
     }
+
+    free(p2);
+
+    return ok;
 }
 
 
 /* ---------------------------------------------------------------------- */
 void
-hybsys_schur_comp_unsymm(int nc, const int *pconn,
-                         const double *Binv, const double *BIV,
-                         const double *P, struct hybsys *sys)
+hybsys_schur_comp_symm_cells(int ncells, const int *cells,
+                             const int *pconn, const int *p2,
+                             const double *Binv, struct hybsys *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int k, c;
+
+#pragma omp parallel for schedule(static) private(c)
+    for (k = 0; k < ncells; k++) {
+        c = (cells != NULL) ? cells[k] : k;
+
+        schur_comp_symm_cell(c, pconn, &Binv[p2[c]], sys);
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+schur_comp_unsymm_cell(int c, const int *pconn,
+                       const double *Binv, const double *BIV,
+                       const double *P, struct hybsys *sys)
 /* ---------------------------------------------------------------------- */
 {
-    int    c, p1, p2, nconn;
+    int    p1, nconn;
     double a1, a2;
 
     MAT_SIZE_T incx, incy;
     MAT_SIZE_T nrows, ncols, lda;
 
-    assert ((sys->F2 != sys->F1) &&
-            (sys->F2 != NULL));
+    incx  = incy = 1;
+    p1    = pconn[c + 0];
+    nconn = pconn[c + 1] - pconn[c];
 
-    incx = incy = 1;
-    p2 = 0;
+    nrows = ncols = lda = nconn;
 
-    for (c = 0; c < nc; c++) {
-        p1    = pconn[c + 0];
-        nconn = pconn[c + 1] - pconn[c];
+    /* F1 <- C' * inv(B) */
+    a1 = 1.0;  a2 = 0.0;
+    dgemv_("No Transpose"   , &nrows, &ncols,
+           &a1, Binv        , &lda, sys->one, &incx,
+           &a2, &sys->F1[p1],                 &incy);
+
+    /* F2 <- (C - V)' * inv(B) == F1 - V'*inv(B) */
+    a1 = -1.0;
+    memcpy(&sys->F2[p1], &sys->F1[p1], nconn * sizeof sys->F2[p1]);
+    daxpy_(&nrows, &a1, &BIV[p1], &incx, &sys->F2[p1], &incy);
+
+    /* L <- (C - V)' * inv(B) * C - P */
+    sys->L[c]  = ddot_(&nrows, sys->one, &incx, &sys->F1[p1], &incy);
+    sys->L[c] -= ddot_(&nrows, sys->one, &incx, &BIV[p1]    , &incy);
+    sys->L[c] -= P[c];
+}
 
-        nrows = ncols = lda = nconn;
 
-        /* F1 <- C' * inv(B) */
-        a1 = 1.0;  a2 = 0.0;
-        dgemv_("No Transpose"   , &nrows, &ncols,
-               &a1, &Binv[p2]   , &lda, sys->one, &incx,
-               &a2, &sys->F1[p1],                 &incy);
+/* ---------------------------------------------------------------------- */
+int
+hybsys_schur_comp_unsymm(int nc, const int *pconn,
+                         const double *Binv, const double *BIV,
+                         const double *P, struct hybsys *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int c, ok, *p2;
 
-        /* F2 <- (C - V)' * inv(B) == F1 - V'*inv(B) */
-        a1 = -1.0;
-        memcpy(&sys->F2[p1], &sys->F1[p1], nconn * sizeof sys->F2[p1]);
-        daxpy_(&nrows, &a1, &BIV[p1], &incx, &sys->F2[p1], &incy);
+    assert ((sys->F2 != sys->F1) &&
+            (sys->F2 != NULL));
 
-        /* L <- (C - V)' * inv(B) * C - P */
-        sys->L[c]  = ddot_(&nrows, sys->one, &incx, &sys->F1[p1], &incy);
-        sys->L[c] -= ddot_(&nrows, sys->one, &incx, &BIV[p1]    , &incy);
-        sys->L[c] -= P[c];
+    p2 = mim_ip_offsets(nc, pconn);
+    ok = p2 != NULL;
 
-        p2 += nconn * nconn;
+    if (ok) {
+#pragma omp parallel for schedule(static)
+        for (c = 0; c < nc; c++) {
+            schur_comp_unsymm_cell(c, pconn, &Binv[p2[c]], BIV, P, sys);
+        }
     }
+
+    free(p2);
+
+    return ok;
 }
 
 
 /* ---------------------------------------------------------------------- */
-void
-hybsys_schur_comp_gen(int nc, const int *pconn,
-                      const double *Binv, const double *C2,
-                      const double *P, struct hybsys *sys)
+static void
+schur_comp_gen_cell(int c, const int *pconn,
+                    const double *Binv, const double *C2,
+                    const double *P, struct hybsys *sys)
 /* ---------------------------------------------------------------------- */
 {
-    int    c, p1, p2, nconn;
+    int    p1, nconn;
     double a1, a2;
 
     MAT_SIZE_T incx, incy;
     MAT_SIZE_T nrows, ncols, lda;
 
-    assert ((sys->F2 != sys->F1) &&
-            (sys->F2 != NULL));
+    incx  = incy = 1;
+    p1    = pconn[c + 0];
+    nconn = pconn[c + 1] - pconn[c];
 
-    incx = incy = 1;
-    p2 = 0;
+    nrows = ncols = lda = nconn;
 
-    for (c = 0; c < nc; c++) {
-        p1    = pconn[c + 0];
-        nconn = pconn[c + 1] - pconn[c];
+    /* F1 <- C' * inv(B) */
+    a1 = 1.0;  a2 = 0.0;
+    dgemv_("No Transpose"   , &nrows, &ncols,
+           &a1, Binv        , &lda, sys->one, &incx,
+           &a2, &sys->F1[p1],                 &incy);
+
+    /* F2 <- C2' * inv(B) */
+    dgemv_("No Transpose"   , &nrows, &ncols,
+           &a1, Binv        , &lda, &C2[p1], &incx,
+           &a2, &sys->F2[p1],                &incy);
+
+    /* L <- C2' * inv(B) * C - P == F2'*ones(n,1) - P */
+    sys->L[c]  = ddot_(&nrows, sys->one, &incx, &sys->F2[p1], &incy);
+    sys->L[c] -= P[c];
+}
 
-        nrows = ncols = lda = nconn;
 
-        /* F1 <- C' * inv(B) */
-        a1 = 1.0;  a2 = 0.0;
-        dgemv_("No Transpose"   , &nrows, &ncols,
-               &a1, &Binv[p2]   , &lda, sys->one, &incx,
-               &a2, &sys->F1[p1],                 &incy);
+/* ---------------------------------------------------------------------- */
+int
+hybsys_schur_comp_gen(int nc, const int *pconn,
+                      const double *Binv, const double *C2,
+                      const double *P, struct hybsys *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int c, ok, *p2;
 
-        /* F2 <- C2' * inv(B) */
-        dgemv_("No Transpose"   , &nrows, &ncols,
-               &a1, &Binv[p2]   , &lda, &C2[p1], &incx,
-               &a2, &sys->F2[p1],                &incy);
+    assert ((sys->F2 != sys->F1) &&
+            (sys->F2 != NULL));
 
-        /* L <- C2' * inv(B) * C - P == F2'*ones(n,1) - P */
-        sys->L[c]  = ddot_(&nrows, sys->one, &incx, &sys->F2[p1], &incy);
-        sys->L[c] -= P[c];
+    p2 = mim_ip_offsets(nc, pconn);
+    ok = p2 != NULL;
 
-        p2 += nconn * nconn;
+    if (ok) {
+#pragma omp parallel for schedule(static)
+        for (c = 0; c < nc; c++) {
+            schur_comp_gen_cell(c, pconn, &Binv[p2[c]], C2, P, sys);
+        }
     }
+
+    free(p2);
+
+    return ok;
 }
 
 
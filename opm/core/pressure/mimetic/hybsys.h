@@ -274,12 +274,37 @@ hybsys_init(int max_nconn, struct hybsys *sys);
  * @param[in,out] sys   Hybrid system management structure allocated
  *                      using hybsys_allocate_symm() and initialised
  *                      using hybsys_init().
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case @c sys is unchanged.
  */
-void
+int
 hybsys_schur_comp_symm(int nc, const int *pconn,
                        const double *Binv, struct hybsys *sys);
 
 
+/**
+ * Compute the elemental contributions of hybsys_schur_comp_symm() for
+ * a subset of the grid cells only.  The contributions of all other
+ * cells are left unchanged.
+ *
+ * @param[in]     ncells Number of cells to process.
+ * @param[in]     cells  Cells to process.  NULL for cells
+ *                       <CODE>0, ..., ncells - 1</CODE>.
+ * @param[in]     pconn  Cell-to-face start pointers.
+ * @param[in]     p2     Start of each cell's block in @c Binv, as
+ *                       computed by mim_ip_offsets().
+ * @param[in]     Binv   Inverse inner product results of all cells.
+ * @param[in,out] sys    Hybrid system management structure allocated
+ *                       using hybsys_allocate_symm() and initialised
+ *                       using hybsys_init().
+ */
+void
+hybsys_schur_comp_symm_cells(int ncells, const int *cells,
+                             const int *pconn, const int *p2,
+                             const double *Binv, struct hybsys *sys);
+
+
 /**
  * Compute elemental (per-cell) contributions to unsymmetric Schur
  * system of simultaneous linear equations.
@@ -312,8 +337,11 @@ hybsys_schur_comp_symm(int nc, const int *pconn,
  * @param[in,out] sys   Hybrid system management structure allocated
  *                      using hybsys_allocate_symm() and initialised
  *                      using hybsys_init().
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case @c sys is unchanged.
  */
-void
+int
 hybsys_schur_comp_unsymm(int nc, const int *pconn,
                          const double *Binv, const double *BIV,
                          const double *P, struct hybsys *sys);
@@ -352,8 +380,11 @@ hybsys_schur_comp_unsymm(int nc, const int *pconn,
  * @param[in,out] sys   Hybrid system management structure allocated
  *                      using hybsys_allocate_symm() and initialised
  *                      using hybsys_init().
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case @c sys is unchanged.
  */
-void
+int
 hybsys_schur_comp_gen(int nc, const int *pconn,
                       const double *Binv, const double *C2,
                       const double *P, struct hybsys *sys);
@@ -26,56 +26,118 @@
 #include <opm/core/pressure/mimetic/mimetic.h>
 
 /* ------------------------------------------------------------------ */
-void
-mim_ip_simple_all(int ncells, int d, int max_nconn,
-                  int *pconn, int *conn,
-                  int *fneighbour, double *fcentroid, double *fnormal,
-                  double *farea, double *ccentroid, double *cvol,
-                  double *perm, double *Binv)
+int *
+mim_ip_offsets(int nc, const int *pconn)
 /* ------------------------------------------------------------------ */
 {
-    int i, j, c, f, nconn, fpos2, lwork;
+    int c, n, *p2;
+
+    p2 = malloc((nc + 1) * sizeof *p2);
+
+    if (p2 != NULL) {
+        p2[0] = 0;
+
+        for (c = 0; c < nc; c++) {
+            n = pconn[c + 1] - pconn[c];
+
+            p2[c + 1] = p2[c] + n*n;
+        }
+    }
+
+    return p2;
+}
 
-    double *C, *N, *A, *work, s;
+
+/* ------------------------------------------------------------------ */
+static void
+ip_simple_cell(int c, int d, int *pconn, int *conn,
+               int *fneighbour, double *fcentroid, double *fnormal,
+               double *farea, double *ccentroid, double *cvol,
+               double *perm, double *Binv,
+               double *C, double *N, double *A,
+               double *work, int lwork)
+/* ------------------------------------------------------------------ */
+{
+    int    i, j, f, nconn;
+    double s;
 
     double cc[3] = { 0.0 };     /* No more than 3 space dimensions */
 
-    lwork = 64 * (max_nconn * d);                 /* 64 from ILAENV() */
-    C     = malloc((max_nconn * d) * sizeof *C);
-    N     = malloc((max_nconn * d) * sizeof *N);
-    A     = malloc(max_nconn       * sizeof *A);
-    work  = malloc(lwork           * sizeof *work);
+    for (j = 0; j < d; j++) {
+        cc[j] = ccentroid[j + c*d];
+    }
 
-    if ((C != NULL) && (N != NULL) && (A != NULL) && (work != NULL)) {
-        fpos2 = 0;
+    nconn = pconn[c + 1] - pconn[c];
 
-        for (c = 0; c < ncells; c++) {
-            for (j = 0; j < d; j++) {
-                cc[j] = ccentroid[j + c*d];
-            }
+    for (i = 0; i < nconn; i++) {
+        f = conn[pconn[c] + i];
+        s = 2.0*(fneighbour[2 * f] == c) - 1.0;
 
-            nconn = pconn[c + 1] - pconn[c];
+        A[i] = farea[f];
 
-            for (i = 0; i < nconn; i++) {
-                f = conn[pconn[c] + i];
-                s = 2.0*(fneighbour[2 * f] == c) - 1.0;
+        for (j = 0; j < d; j++) {
+            C[i + j*nconn] = fcentroid  [j + f*d] - cc[j];
+            N[i + j*nconn] = s * fnormal[j + f*d];
+        }
+    }
 
-                A[i] = farea[f];
+    mim_ip_simple(nconn, nconn, d, cvol[c], &perm[c * d * d],
+                  C, A, N, Binv, work, lwork);
+}
 
-                for (j = 0; j < d; j++) {
-                    C[i + j*nconn] = fcentroid  [j + f*d] - cc[j];
-                    N[i + j*nconn] = s * fnormal[j + f*d];
-                }
+
+/* ------------------------------------------------------------------ */
+/* Cells are independent, so the loop is parallel.  Every thread has  */
+/* its own scratch arrays for the per-cell QR factorisation.          */
+/* ------------------------------------------------------------------ */
+int
+mim_ip_simple_all(int ncells, int d, int max_nconn,
+                  int *pconn, int *conn,
+                  int *fneighbour, double *fcentroid, double *fnormal,
+                  double *farea, double *ccentroid, double *cvol,
+                  double *perm, double *Binv)
+/* ------------------------------------------------------------------ */
+{
+    int     c, lwork, ok, *p2;
+    double  *C, *N, *A, *work;
+
+    lwork = 64 * (max_nconn * d);                 /* 64 from ILAENV() */
+    p2    = mim_ip_offsets(ncells, pconn);
+    ok    = p2 != NULL;
+
+    if (ok) {
+#pragma omp parallel default(shared) private(c, C, N, A, work) \
+    reduction(&&:ok)
+        {
+            C = malloc((2*(max_nconn * d) + max_nconn + lwork) * sizeof *C);
+            N = A = work = NULL;
+
+            if (C != NULL) {
+                N    = C + (max_nconn * d);
+                A    = N + (max_nconn * d);
+                work = A +  max_nconn;
             }
 
-            mim_ip_simple(nconn, nconn, d, cvol[c], &perm[c * d * d],
-                          C, A, N, &Binv[fpos2], work, lwork);
+            ok = C != NULL;
 
-            fpos2 += nconn * nconn;
+            /* Every thread must reach the work-sharing loop. */
+#pragma omp for schedule(static)
+            for (c = 0; c < ncells; c++) {
+                if (C != NULL) {
+                    ip_simple_cell(c, d, pconn, conn, fneighbour,
+                                   fcentroid, fnormal, farea,
+                                   ccentroid, cvol, perm, &Binv[p2[c]],
+                                   C, N, A, work, lwork);
+                }
+            }
+
+            free(C);
         }
     }
 
-    free(work);  free(A);  free(N);  free(C);
+    free(p2);
+
+    return ok;
 }
 
 
@@ -217,22 +279,30 @@ mim_ip_compute_gpress(int nc, int d, const double *grav,
 
 /* inv(B) <- \lambda_t(s)*inv(B)_0 */
 /* ---------------------------------------------------------------------- */
-void
+int
 mim_ip_mobility_update(int nc, const int *pconn, const double *totmob,
                        const double *Binv0, double *Binv)
 /* ---------------------------------------------------------------------- */
 {
-    int c, i, n, p2;
+    int c, i, n, ok, *p2;
 
-    for (c = p2 = 0; c < nc; c++) {
-        n = pconn[c + 1] - pconn[c];
+    p2 = mim_ip_offsets(nc, pconn);
+    ok = p2 != NULL;
 
-        for (i = 0; i < n * n; i++) {
-            Binv[p2 + i] = totmob[c] * Binv0[p2 + i];
-        }
+    if (ok) {
+#pragma omp parallel for schedule(static) private(i, n)
+        for (c = 0; c < nc; c++) {
+            n = pconn[c + 1] - pconn[c];
 
-        p2 += n * n;
+            for (i = 0; i < n * n; i++) {
+                Binv[p2[c] + i] = totmob[c] * Binv0[p2[c] + i];
+            }
+        }
     }
+
+    free(p2);
+
+    return ok;
 }
 
 
@@ -245,8 +315,9 @@ mim_ip_density_update(int nc, const int *pconn, const double *omega,
 {
     int c, i;
 
-    for (c = i = 0; c < nc; c++) {
-        for (; i < pconn[c + 1]; i++) {
+#pragma omp parallel for schedule(static) private(i)
+    for (c = 0; c < nc; c++) {
+        for (i = pconn[c]; i < pconn[c + 1]; i++) {
             gpress[i] = omega[c] * gpress0[i];
         }
     }
@@ -150,11 +150,28 @@ mim_ip_simple(int nf, int nconn, int d,
               double *work, int lwork);
 
 
+/**
+ * Compute the start of each cell's block in the linear array of
+ * (inverse) inner products, i.e., the running sum of the squared
+ * number of connections (faces) of each cell.
+ *
+ * @param[in] nc    Number of cells.
+ * @param[in] pconn Start pointers of cell-to-face topology mapping.
+ *
+ * @return Array of size <CODE>nc + 1</CODE> whose entry @c c is the
+ *         start of cell @c c's block, to be released using free().
+ *         NULL if memory allocation failed.
+ */
+int *
+mim_ip_offsets(int nc, const int *pconn);
+
+
 /**
  * Compute the mimetic inner products given a grid and cell-wise
  * permeability tensors.
  *
  * This function applies mim_ip_simple() to all specified cells.
+ * The cells are processed in parallel if OpenMP is available.
  *
  * @param[in]  ncells       Number of cells.
  * @param[in]  d            Number of physical dimensions.
@@ -175,8 +192,11 @@ mim_ip_simple(int nf, int nconn, int d,
  *                          \f$\sum_c n_c^2\f$ when \f$n_c\f$ denotes
  *                          the number of connections (faces) of
  *                          cell \f$c\f$.
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case the contents of @c Binv is undefined.
  */
-void
+int
 mim_ip_simple_all(int ncells, int d, int max_ncf,
                   int *pconn, int *conn,
                   int *fneighbour, double *fcentroid, double *fnormal,
@@ -234,8 +254,11 @@ mim_ip_compute_gpress(int nc, int d, const double *grav,
  * @param[in]  Binv0  Inverse inner product results for all cells.
  * @param[out] Binv   Inverse inner product results incorporating
  *                    effects of multiple fluid phases.
+ *
+ * @return One (1) if successful and zero (0) if memory allocation
+ *         failed, in which case the contents of @c Binv is undefined.
  */
-void
+int
 mim_ip_mobility_update(int nc, const int *pconn, const double *totmob,
                        const double *Binv0, double *Binv);
 
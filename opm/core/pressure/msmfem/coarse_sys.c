@@ -71,7 +71,6 @@ struct coarse_sys_meta {
     int *blk_nhf;               /* Number of fs hfaces per block */
     int *blk_nfsf;              /* Number of fs faces per block */
 
-    int *loc_fno;               /* Local (fs) face numbering */
     int *ncf;                   /* diff(face_pos) */
     int *pconn2;                /* cumsum([0; diff(face_pos).^2]) */
 
@@ -87,6 +86,7 @@ struct coarse_sys_meta {
 
 struct bf_asm_data {
     struct hybsys *fsys;        /* Fine-scale hybrid system contributions */
+    struct hybsys  fsys_data;   /* Thread-private view of shared ->fsys */
 
     struct CSRMatrix *A;        /* BF coefficient matrix */
     double           *b;        /* BF system RHS */
@@ -96,10 +96,13 @@ struct bf_asm_data {
     double           *p;        /* BF pressure. */
     double           *flux;     /* BF flux.  Symmetrised. */
 
-    double           *gpress;   /* BF gravity contrib. (== 0) */
+    const double     *gpress;   /* BF gravity contrib. (== 0, shared) */
+    const double     *w;        /* BF weighting function (shared) */
+    const double     *wneg;     /* Sign flipped weighting (shared) */
 
     double           *work;     /* Back-substitution work array */
 
+    int              *loc_fno;  /* Local (fs) face numbering */
     int              *pdof;     /* Indirection pointer to linearised DOF */
     int              *dof;      /* Linearised DOFs per BF */
     int              *fcount;   /* Flux symmetrisation face count. */
@@ -131,7 +134,7 @@ coarse_sys_meta_destroy(struct coarse_sys_meta *m)
 /* ---------------------------------------------------------------------- */
 static struct coarse_sys_meta *
 coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c,
-                         size_t nc     , size_t nfaces_f)
+                         size_t nc)
 /* ---------------------------------------------------------------------- */
 {
     size_t                  i, alloc_sz;
@@ -144,7 +147,6 @@ coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c,
         alloc_sz += nblocks;     /* blk_nfsf */
         alloc_sz += nc;          /* ncf */
         alloc_sz += nc + 1;      /* pconn2 */
-        alloc_sz += nfaces_f;    /* loc_fno */
         alloc_sz += nblocks + 1; /* pb2c */
         alloc_sz += nc;          /* b2c */
         alloc_sz += nfaces_c;    /* bfno */
@@ -165,9 +167,8 @@ coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c,
             new->blk_nfsf  = new->blk_nhf   + nblocks;
             new->ncf       = new->blk_nfsf  + nblocks;
             new->pconn2    = new->ncf       + nc;
-            new->loc_fno   = new->pconn2    + nc + 1;
 
-            new->pb2c      = new->loc_fno   + nfaces_f;
+            new->pb2c      = new->pconn2    + nc + 1;
             new->b2c       = new->pb2c      + nblocks + 1;
 
             new->bfno      = new->b2c       + nc;
@@ -188,20 +189,31 @@ bf_asm_data_deallocate(struct bf_asm_data *data)
         free            (data->ddata);
         free            (data->idata);
         csrmatrix_delete(data->A);
-        hybsys_free     (data->fsys);
     }
 
     free(data);
 }
 
 
+/* Allocate the workspace needed to assemble and solve the local
+ * systems of a single thread.  The fine-scale hybrid system 'fsys',
+ * the (zero) gravity contributions 'gpress' and the weighting 'w'
+ * along with its negative 'wneg' are shared, while the per-cell data
+ * that hybsys_cellcontrib_symm() writes and the face numbering are
+ * private.
+ *
+ * Returns fully allocated workspace if successful and NULL if not. */
 /* ---------------------------------------------------------------------- */
 static struct bf_asm_data *
-bf_asm_data_allocate(struct UnstructuredGrid                 *g,
-                     struct coarse_sys_meta *m)
+bf_asm_data_allocate(struct UnstructuredGrid *g,
+                     struct coarse_sys_meta  *m,
+                     const struct hybsys     *fsys,
+                     const double            *gpress,
+                     const double            *w,
+                     const double            *wneg)
 /* ---------------------------------------------------------------------- */
 {
-    int                 tot_ngconn;
+    size_t              nc, nf, f;
     size_t              max_nhf, max_cells, max_faces, nnz;
     size_t              alloc_sz;
     struct bf_asm_data *new;
@@ -214,17 +226,15 @@ bf_asm_data_allocate(struct UnstructuredGrid                 *g,
         max_faces = 2 * m->max_blk_nfsf;
         nnz       = 2 * m->max_blk_sum_nhf2;
 
-        tot_ngconn = g->cell_facepos[ g->number_of_cells ];
-
-        new->fsys = hybsys_allocate_symm((int) m->max_ngconn,
-                                         g->number_of_cells,
-                                         tot_ngconn);
+        nc = g->number_of_cells;
+        nf = g->number_of_faces;
 
         new->A = csrmatrix_new_known_nnz(max_faces, nnz);
 
         alloc_sz   = max_cells + 1; /* pdof */
         alloc_sz  += max_nhf;       /* dof */
         alloc_sz  += max_faces;     /* fcount */
+        alloc_sz  += nf;            /* loc_fno */
 
         new->idata = malloc(alloc_sz * sizeof *new->idata);
 
@@ -232,19 +242,22 @@ bf_asm_data_allocate(struct UnstructuredGrid                 *g,
         alloc_sz  += 1 * max_nhf;   /* v */
         alloc_sz  += 1 * max_cells; /* p */
         alloc_sz  += 1 * max_faces; /* flux */
-        alloc_sz  += tot_ngconn;    /* gpress */
         alloc_sz  += m->max_ngconn; /* work */
+        alloc_sz  += nc;            /* fsys->q */
+        alloc_sz  += m->max_ngconn; /* fsys->r */
+        alloc_sz  += m->max_ngconn * m->max_ngconn; /* fsys->S */
 
         new->ddata = malloc(alloc_sz * sizeof *new->ddata);
 
-        if ((new->fsys  == NULL) || (new->A     == NULL) ||
+        if ((new->A     == NULL) ||
             (new->idata == NULL) || (new->ddata == NULL)) {
             bf_asm_data_deallocate(new);
             new = NULL;
         } else {
-            new->pdof   = new->idata;
-            new->dof    = new->pdof   + max_cells + 1;
-            new->fcount = new->dof    + max_nhf;
+            new->pdof    = new->idata;
+            new->dof     = new->pdof   + max_cells + 1;
+            new->fcount  = new->dof    + max_nhf;
+            new->loc_fno = new->fcount + max_faces;
 
             new->b      = new->ddata;
             new->x      = new->b      + max_faces;
@@ -253,10 +266,19 @@ bf_asm_data_allocate(struct UnstructuredGrid                 *g,
 
             new->flux   = new->p      + max_cells;
 
-            new->gpress = new->flux   + max_faces;
-            new->work   = new->gpress + tot_ngconn;
+            new->work   = new->flux   + max_faces;
+
+            new->fsys_data   = *fsys;
+            new->fsys_data.q = new->work + m->max_ngconn;
+            new->fsys_data.r = new->fsys_data.q + nc;
+            new->fsys_data.S = new->fsys_data.r + m->max_ngconn;
+            new->fsys        = &new->fsys_data;
 
-            hybsys_init((int) m->max_ngconn, new->fsys);
+            new->gpress = gpress;
+            new->w      = w;
+            new->wneg   = wneg;
+
+            for (f = 0; f < nf; f++) { new->loc_fno[f] = -1; }
         }
     }
 
@@ -412,10 +434,6 @@ coarse_sys_meta_fill(int nc, const int *pgconn,
         }
     }
 
-    for (f = 0; f < nneigh; f++) {
-        m->loc_fno[f] = -1;
-    }
-
     m->max_cf_nf = 0;
 
     for (f = 0; f < (size_t) ct->nfaces; f++) {
@@ -471,7 +489,7 @@ coarse_sys_meta_construct(struct UnstructuredGrid *g, const int *p,
     struct coarse_sys_meta *m;
 
     m = coarse_sys_meta_allocate(ct->nblocks, ct->nfaces,
-                                 g->number_of_cells, g->number_of_faces);
+                                 g->number_of_cells);
 
     if (m != NULL) {
         coarse_sys_meta_fill(g->number_of_cells,
@@ -487,23 +505,36 @@ coarse_sys_meta_construct(struct UnstructuredGrid *g, const int *p,
 #define USE_MIM_IP_TPFA 1
 #define USE_MIM_IP_QFAMILY 0
 
+/* Compute the fine-scale (inverse) inner products of the 'ncells'
+ * cells listed in 'cells', or of all cells if 'cells' is NULL.  The
+ * result has the layout defined by m->pconn2 regardless of the subset.
+ *
+ * Returns valid pointer if successful and NULL if not. */
 #if USE_MIM_IP_SIMPLE
 /* ---------------------------------------------------------------------- */
+/* Subsets are not supported by mim_ip_simple_all(); all cells are
+ * always computed. */
+/* ---------------------------------------------------------------------- */
 static double *
 compute_fs_ip(struct UnstructuredGrid *g, const double *perm,
-              const struct coarse_sys_meta *m)
+              const struct coarse_sys_meta *m,
+              int ncells, const int *cells)
 /* ---------------------------------------------------------------------- */
 {
     double *Binv;
 
+    (void) ncells;  (void) cells;
+
     Binv = malloc(m->sum_ngconn2 * sizeof *Binv);
 
-    if (Binv != NULL) {
-        mim_ip_simple_all(g->number_of_cells, g->dimensions, m->max_ngconn,
-                          g->cell_facepos, g->cell_faces,
-                          g->face_cells, g->face_centroids, g->face_normals,
-                          g->face_areas, g->cell_centroids, g->cell_volumes,
-                          (double *) perm, Binv); /* const_cast<>() */
+    if ((Binv != NULL) &&
+        ! mim_ip_simple_all(g->number_of_cells, g->dimensions, m->max_ngconn,
+                            g->cell_facepos, g->cell_faces,
+                            g->face_cells, g->face_centroids, g->face_normals,
+                            g->face_areas, g->cell_centroids, g->cell_volumes,
+                            (double *) perm, Binv)) { /* const_cast<>() */
+        free(Binv);
+        Binv = NULL;
     }
 
     return Binv;
@@ -513,9 +544,11 @@ compute_fs_ip(struct UnstructuredGrid *g, const double *perm,
 /* ---------------------------------------------------------------------- */
 static double *
 compute_fs_ip(struct UnstructuredGrid *g, const double *perm,
-              const struct coarse_sys_meta *m)
+              const struct coarse_sys_meta *m,
+              int ncells, const int *cells)
 /* ---------------------------------------------------------------------- */
 {
+    int    k;
     size_t c, nc, nconn, p1, p2, i, j;
     double *Binv, *htrans;
 
@@ -525,11 +558,18 @@ compute_fs_ip(struct UnstructuredGrid *g, const double *perm,
     htrans = malloc(g->cell_facepos[ nc ] * sizeof *htrans);
 
     if ((Binv != NULL) && (htrans != NULL)) {
-        tpfa_htrans_compute(g, perm, htrans);
+        if (cells == NULL) {
+            tpfa_htrans_compute(g, perm, htrans);
+            ncells = (int) nc;
+        } else {
+            tpfa_htrans_update(g, perm, ncells, cells, htrans);
+        }
 
-        for (c = p2 = 0; c < nc; c++) {
+        for (k = 0; k < ncells; k++) {
+            c     = (cells == NULL) ? (size_t) k : (size_t) cells[k];
             p1    = g->cell_facepos[c + 0]     ;
             nconn = g->cell_facepos[c + 1] - p1;
+            p2    = m->pconn2[c];
 
             for (i = 0; i < nconn; i++) {
                 Binv[p2 + i*(nconn + 1)] = htrans[p1 + i];
@@ -538,8 +578,6 @@ compute_fs_ip(struct UnstructuredGrid *g, const double *perm,
                     Binv[p2 + i*nconn + j] = 0.0;
                 }
             }
-
-            p2 += nconn * nconn;
         }
     }
 
@@ -550,154 +588,113 @@ compute_fs_ip(struct UnstructuredGrid *g, const double *perm,
 #endif
 
 
-/* Create basis function weighting source term (unsigned) based on
- * trace of permeability.
- *
- * Returns valid pointer (one scalar per cell in underlying fine-scale
- * grid model) if succesful, and NULL otherwise. */
+/* Create basis function weighting source term (unsigned) of block 'b'
+ * based on trace of permeability. */
 /* ---------------------------------------------------------------------- */
-static double *
-perm_weighting(size_t nc, size_t nd,
+static void
+perm_weighting(int b, size_t nd,
+               const struct coarse_sys_meta *m,
                const double *perm,
-               const double *cvol)
+               const double *cvol,
+               double       *w)
 /* ---------------------------------------------------------------------- */
 {
-    size_t c, d, off;
+    int    i, c;
+    size_t d, off;
     double t;
-    double *w;
 
-    w = malloc(nc * sizeof *w);
+    for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
+        c   = m->b2c[i];
+        off = c * nd * nd;
+        t   = 0.0;
 
-    if (w != NULL) {
-        for (c = off = 0; c < nc; c++, off += nd*nd) {
-            t = 0.0;
-
-            for (d = 0; d < nd; d++) {
-                t += perm[off + d*(nd + 1)];
-            }
-
-            w[c] = t * cvol[c];
+        for (d = 0; d < nd; d++) {
+            t += perm[off + d*(nd + 1)];
         }
-    }
 
-    return w;
+        w[c] = t * cvol[c];
+    }
 }
 
 
-/* Use prescribed sources if applicable (replace synthetic source term).
- *
- * Returns one (1) if successful (needs to allocate internal data) and
- * zero (0) otherwise. */
+/* Use prescribed sources of block 'b' if applicable (replace synthetic
+ * source term). */
 /* ---------------------------------------------------------------------- */
-static int
-enforce_explicit_source(size_t nc, size_t nb, const int *p,
-                        const double *src, struct coarse_sys_meta *m,
-                        double *w)
+static void
+enforce_explicit_source(int b, const struct coarse_sys_meta *m,
+                        const double *src, double *w)
 /* ---------------------------------------------------------------------- */
 {
-    int     i, ret;
-    size_t  c, b;
-    int    *has_src;
-
-    ret     = 0;
-    has_src = malloc(nb * sizeof *has_src);
+    int i, c, has_src;
 
-    if (has_src != NULL) {
-        for (b = 0; b < nb; b++) { has_src[b] = 0; }
-
-        for (c = 0; c < nc; c++) {
-            has_src[p[c]] += fabs(src[c]) > 0.0;
-        }
-
-        for (b = 0; b < nb; b++) {
-            if (has_src[b]) {
-                for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
-                    w[m->b2c[i]] = 0.0;
-                }
-            }
-        }
+    has_src = 0;
+    for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
+        has_src += fabs(src[m->b2c[i]]) > 0.0;
+    }
 
-        for (c = 0; c < nc; c++) {
-            if (fabs(src[c]) > 0.0) {
-                w[c] = src[c];
-            }
+    if (has_src) {
+        for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
+            c    = m->b2c[i];
+            w[c] = (fabs(src[c]) > 0.0) ? src[c] : 0.0;
         }
-
-        ret = 1;
     }
-
-    free(has_src);
-
-    return ret;
 }
 
 
-/* Enforce \int_{\Omega_i} w(x) dx == 1 for all blocks, \Omega_i.
- *
- * Allocates internal work array.
- *
- * Returns one (1) if successful, and zero (0) otherwise. */
+/* Enforce \int_{\Omega_b} w(x) dx == 1 for block \Omega_b. */
 /* ---------------------------------------------------------------------- */
-static int
-normalize_weighting(size_t nc, size_t nb, const int *p, double *w)
+static void
+normalize_weighting(int b, const struct coarse_sys_meta *m, double *w)
 /* ---------------------------------------------------------------------- */
 {
-    int     ret;
-    size_t  c, b;
-    double *bw;
-
-    ret = 0;
-    bw  = malloc(nb * sizeof *bw);
+    int    i;
+    double bw;
 
-    if (bw != NULL) {
-        for (b = 0; b < nb; b++) { bw[ b  ]  =  0.0; }
-        for (c = 0; c < nc; c++) { bw[p[c]] += w[c]; }
-
-        for (c = 0; c < nc; c++) {
-            assert (fabs(bw[p[c]]) > 0.0);
-
-            w[c] /= bw[p[c]];
-        }
-
-        ret = 1;
+    bw = 0.0;
+    for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
+        bw += w[m->b2c[i]];
     }
 
-    free(bw);
+    assert (fabs(bw) > 0.0);
 
-    return ret;
+    for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
+        w[m->b2c[i]] /= bw;
+    }
 }
 
 
 /* Create basis function weighting term (unsigned), one scalar per
  * grid cell in the underlying fine-scale grid.  Integral one per
- * block.  Satisfies any prescribed external source terms.
+ * block.  Satisfies any prescribed external source terms.  Only the
+ * cells of blocks for which active[b] is non-zero are defined if
+ * 'active' is not NULL.
  *
  * Returns valid ponter if successful and NULL if not. */
 /* ---------------------------------------------------------------------- */
 static double *
 coarse_weight(struct UnstructuredGrid *g, size_t nb,
-              const int              *p,
               struct coarse_sys_meta *m,
-              const double           *perm, const double *src)
+              const double           *perm, const double *src,
+              const char             *active)
 /* ---------------------------------------------------------------------- */
 {
-    int     ok;
+    size_t  b;
     double *w;
 
-    ok = 0;
-    w  = perm_weighting(g->number_of_cells,
-                        g->dimensions, perm, g->cell_volumes);
+    w = malloc(g->number_of_cells * sizeof *w);
 
     if (w != NULL) {
-        ok = enforce_explicit_source(g->number_of_cells,
-                                     nb, p, src, m, w);
-    }
+        for (b = 0; b < nb; b++) {
+            if ((active != NULL) && ! active[b]) { continue; }
 
-    if (ok) {
-        ok = normalize_weighting(g->number_of_cells, nb, p, w);
-    }
+            perm_weighting(b, g->dimensions, m, perm,
+                           g->cell_volumes, w);
 
-    if (!ok) { free(w);  w = NULL; }
+            enforce_explicit_source(b, m, src, w);
+
+            normalize_weighting(b, m, w);
+        }
+    }
 
     return w;
 }
@@ -842,6 +839,7 @@ coarse_sys_allocate(struct coarse_topology *ct,
             new->basis       = malloc(bf_asz   * sizeof *new->basis  );
             new->cell_ip     = malloc(ip_asz   * sizeof *new->cell_ip);
             new->Binv        = malloc(Binv_asz * sizeof *new->Binv   );
+            new->totmob      = malloc(m->pb2c[nb] * sizeof *new->totmob);
 
             alloc_ok += new->dof2conn    != NULL;
             alloc_ok += new->basis_pos   != NULL;
@@ -849,9 +847,10 @@ coarse_sys_allocate(struct coarse_topology *ct,
             alloc_ok += new->basis       != NULL;
             alloc_ok += new->cell_ip     != NULL;
             alloc_ok += new->Binv        != NULL;
+            alloc_ok += new->totmob      != NULL;
         }
 
-        if (alloc_ok < 7) {
+        if (alloc_ok < 8) {
             coarse_sys_destroy(new);
             new = NULL;
         } else {
@@ -924,7 +923,7 @@ set_csys_block_pointers(struct coarse_topology *ct,
 /* Create local numbering of the fine-scale faces contained in a pair
  * of blocks denoted by 'cf'.
  *
- * Precondition: m->loc_fno[0 .. g->number_of_faces-1] < 0
+ * Precondition: loc_fno[0 .. g->number_of_faces-1] < 0
  *
  * Returns the number of local fine-scale faces. */
 /* ---------------------------------------------------------------------- */
@@ -932,7 +931,8 @@ static int
 enumerate_local_dofs(size_t                  cf,
                      struct UnstructuredGrid                 *g ,
                      struct coarse_topology *ct,
-                     struct coarse_sys_meta *m)
+                     struct coarse_sys_meta *m ,
+                     int                    *loc_fno)
 /* ---------------------------------------------------------------------- */
 {
     int *b, *c, i, f, loc_no;
@@ -951,8 +951,8 @@ enumerate_local_dofs(size_t                  cf,
 
                     f = g->cell_faces[i];
 
-                    if (m->loc_fno[f] < 0) {
-                        m->loc_fno[f] = loc_no++;
+                    if (loc_fno[f] < 0) {
+                        loc_fno[f] = loc_no++;
                     }
                 }
             }
@@ -976,7 +976,8 @@ static void
 unenumerate_local_dofs(size_t                  cf,
                        struct UnstructuredGrid                 *g ,
                        struct coarse_topology *ct,
-                       struct coarse_sys_meta *m)
+                       struct coarse_sys_meta *m ,
+                       int                    *loc_fno)
 /* ---------------------------------------------------------------------- */
 {
     int *b, *c, i;
@@ -990,7 +991,7 @@ unenumerate_local_dofs(size_t                  cf,
                 for (i = g->cell_facepos[*c + 0];
                      i < g->cell_facepos[*c + 1]; i++) {
 
-                    m->loc_fno[ g->cell_faces[i] ] = -1;
+                    loc_fno[ g->cell_faces[i] ] = -1;
                 }
             }
         }
@@ -1001,7 +1002,7 @@ unenumerate_local_dofs(size_t                  cf,
 /* ---------------------------------------------------------------------- */
 /* Define local (to a single BF) pdof/dof CSR table.
  *
- * Precondition: m->loc_fno valid for BF (i.e., called after
+ * Precondition: bf_asm->loc_fno valid for BF (i.e., called after
  * enumerate_local_dofs()).
  *
  * Does not fail. */
@@ -1030,7 +1031,7 @@ linearise_local_dof(size_t                  cf,
 
                 for (i = g->cell_facepos[*c + 0];
                      i < g->cell_facepos[*c + 1]; i++) {
-                    *dof++ = m->loc_fno[ g->cell_faces[i] ];
+                    *dof++ = bf_asm->loc_fno[ g->cell_faces[i] ];
                 }
 
                 *++pdof = dof - bf_asm->dof;
@@ -1118,9 +1119,10 @@ define_csr_sparsity(size_t nc, size_t m, struct bf_asm_data *bf_asm)
 /* ---------------------------------------------------------------------- */
 /* Assemble system of linear equations corresponding to local
  * discretisation of flow problem on domain connected to coarse face
- * 'cf'.  The domain has a total of 'nlocf' fine-scale interfaces, and
- * the BF weighting function 'w' is pre-calculated using function
- * coarse_weight().
+ * 'cf'.  The domain has a total of 'nlocf' fine-scale interfaces.  The
+ * BF weighting function bf_asm->w, pre-calculated using function
+ * coarse_weight(), is the source in the first block and its negative,
+ * bf_asm->wneg, the sink in the second.
  *
  * Does not fail. */
 /* ---------------------------------------------------------------------- */
@@ -1129,7 +1131,6 @@ assemble_local_system(size_t                  cf   ,
                       size_t                  nlocf,
                       struct UnstructuredGrid                 *g    ,
                       const double           *Binv ,
-                      double                 *w    ,
                       struct coarse_topology *ct   ,
                       struct coarse_sys_meta *m    ,
                       struct bf_asm_data     *bf_asm)
@@ -1139,7 +1140,7 @@ assemble_local_system(size_t                  cf   ,
     int    *b, *dof;
     size_t nc;
 
-    double sgn;
+    const double *w;
 
     linearise_local_dof(cf, g, ct, m, bf_asm);
 
@@ -1156,7 +1157,7 @@ assemble_local_system(size_t                  cf   ,
     csrmatrix_zero(       bf_asm->A);
     vector_zero   (nlocf, bf_asm->b);
 
-    sgn = 1.0;
+    w   = bf_asm->w;
     dof = bf_asm->dof;
     for (b  = ct->neighbours + 2*(cf + 0);
          b != ct->neighbours + 2*(cf + 1); b++) {
@@ -1168,8 +1169,6 @@ assemble_local_system(size_t                  cf   ,
                 p2   = m->pconn2[c];
                 ndof = g->cell_facepos[c + 1] - p1;
 
-                w[c] *= sgn;    /* Set w-sign according to source/sink */
-
                 hybsys_cellcontrib_symm(c, ndof, p1, p2, bf_asm->gpress,
                                         w, Binv, bf_asm->fsys);
 
@@ -1177,12 +1176,10 @@ assemble_local_system(size_t                  cf   ,
                                             bf_asm->fsys->r, bf_asm->A,
                                             bf_asm->b);
 
-                w[c] *= sgn;    /* Restore original weighting sign */
-
                 dof += ndof;
             }
 
-            sgn = -sgn;
+            w = bf_asm->wneg;   /* Sink in second block */
         }
     }
 
@@ -1194,17 +1191,23 @@ assemble_local_system(size_t                  cf   ,
 /* ---------------------------------------------------------------------- */
 /* Scale the fine-scale (inverse) inner product 'Binv' by the
  * corresponding cell's total mobility.  This includes mobility
- * effects in the resulting BFs. */
+ * effects in the resulting BFs.  Restricted to the 'ncells' cells
+ * listed in 'cells' unless 'cells' is NULL. */
 /* ---------------------------------------------------------------------- */
 static void
 Binv_scale_mobility(int nc, struct coarse_sys_meta *m,
+                    int ncells, const int *cells,
                     const double *totmob, double *Binv)
 /* ---------------------------------------------------------------------- */
 {
-    int c, i;
+    int c, i, k;
+
+    if (cells == NULL) { ncells = nc; }
 
-    for (c = i = 0; c < nc; c++) {
-        for (; i < m->pconn2[c]; i++) {
+    for (k = 0; k < ncells; k++) {
+        c = (cells == NULL) ? k : cells[k];
+
+        for (i = m->pconn2[c]; i < m->pconn2[c + 1]; i++) {
             Binv[i] *= totmob[c];
         }
     }
@@ -1406,6 +1409,203 @@ store_basis_function(size_t                  cf    ,
 }
 
 
+static void
+compute_cell_ip(int                nc,
+                int                max_nconn,
+                int                nb,
+                const int         *pconn,
+                const int         *pconn2,
+                const double      *Binv,
+                const int         *b2c_pos,
+                const int         *b2c,
+                const char        *active,
+                struct coarse_sys *sys);
+
+
+/* ---------------------------------------------------------------------- */
+/* Compute the basis functions of all active coarse faces, or only of
+ * those for which recompute[cf] is non-zero if 'recompute' is not
+ * NULL.  In the latter case, 'cells' lists the 'ncells' cells of all
+ * blocks adjacent to a recomputed face, and only the fine-scale
+ * inner product 'Binv' and weighting 'w' of those cells are used.
+ * 'Binv' must already include mobility effects.
+ *
+ * The local problems are independent.  If 'parallel' is non-zero they
+ * are distributed across threads, each with its own assembly
+ * workspace, and 'linsolve' is called concurrently.
+ *
+ * Returns the number of basis functions computed if successful and
+ * -1 if not (allocation failure). */
+/* ---------------------------------------------------------------------- */
+static int
+compute_basis_functions(struct UnstructuredGrid *g        ,
+                        struct coarse_topology  *ct       ,
+                        struct coarse_sys_meta  *m        ,
+                        const double            *Binv     ,
+                        const double            *w        ,
+                        int                      ncells   ,
+                        const int               *cells    ,
+                        const char              *recompute,
+                        int                      parallel ,
+                        LocalSolver              linsolve ,
+                        struct coarse_sys       *sys      )
+/* ---------------------------------------------------------------------- */
+{
+    int                 c, i, k, cf, nbf, ok, tot_ngconn;
+    size_t              nlocf;
+    double             *gpress, *wneg;
+    struct hybsys      *fsys;
+    struct bf_asm_data *bf_asm;
+
+    nbf = -1;
+
+    tot_ngconn = g->cell_facepos[ g->number_of_cells ];
+
+    fsys   = hybsys_allocate_symm((int) m->max_ngconn,
+                                  g->number_of_cells, tot_ngconn);
+    gpress = malloc(tot_ngconn          * sizeof *gpress);
+    wneg   = malloc(g->number_of_cells * sizeof *wneg);
+
+    if ((fsys != NULL) && (gpress != NULL) && (wneg != NULL)) {
+        hybsys_init((int) m->max_ngconn, fsys);
+
+        if (cells == NULL) {
+            /* Exclude effects of gravity */
+            vector_zero(tot_ngconn, gpress);
+
+            for (c = 0; c < g->number_of_cells; c++) {
+                wneg[c] = -w[c];
+            }
+
+            /* Discretise flow equation on fine scale */
+            ok = hybsys_schur_comp_symm(g->number_of_cells, g->cell_facepos,
+                                        Binv, fsys);
+        } else {
+            for (k = 0; k < ncells; k++) {
+                c = cells[k];
+
+                for (i = g->cell_facepos[c]; i < g->cell_facepos[c + 1]; i++) {
+                    gpress[i] = 0.0;
+                }
+
+                wneg[c] = -w[c];
+            }
+
+            hybsys_schur_comp_symm_cells(ncells, cells, g->cell_facepos,
+                                         m->pconn2, Binv, fsys);
+            ok = 1;
+        }
+
+        nbf = 0;
+
+        if (ok) {
+#pragma omp parallel if(parallel) default(shared) \
+    private(cf, nlocf, bf_asm) reduction(&&:ok) reduction(+:nbf)
+            {
+                bf_asm = bf_asm_data_allocate(g, m, fsys, gpress, w, wneg);
+                ok     = bf_asm != NULL;
+
+                /* Every thread must reach the work-sharing loop. */
+#pragma omp for schedule(dynamic, 1)
+                for (cf = 0; cf < ct->nfaces; cf++) {
+                    if ((bf_asm != NULL) && (m->bfno[cf] >= 0) &&
+                        ((recompute == NULL) || recompute[cf])) {
+                        nlocf = enumerate_local_dofs(cf, g, ct, m,
+                                                     bf_asm->loc_fno);
+
+                        assemble_local_system(cf, nlocf, g, Binv,
+                                              ct, m, bf_asm);
+
+                        solve_local_system(cf, g, Binv, ct, m,
+                                           bf_asm, linsolve);
+
+                        store_basis_function(cf, ct, m, bf_asm, sys);
+
+                        unenumerate_local_dofs(cf, g, ct, m,
+                                               bf_asm->loc_fno);
+
+                        nbf += 1;
+                    }
+                }
+
+                bf_asm_data_deallocate(bf_asm);
+            }
+        }
+
+        if (! ok) { nbf = -1; }
+    }
+
+    free(wneg);
+    free(gpress);
+    hybsys_free(fsys);
+
+    return nbf;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Implementation of coarse_sys_construct() and
+ * coarse_sys_construct_parallel(). */
+/* ---------------------------------------------------------------------- */
+static struct coarse_sys *
+coarse_sys_construct_impl(struct UnstructuredGrid *g, const int   *p,
+                          struct coarse_topology *ct,
+                          const double           *perm,
+                          const double           *src,
+                          const double           *totmob,
+                          int                     parallel,
+                          LocalSolver             linsolve)
+/* ---------------------------------------------------------------------- */
+{
+    int                     ok;
+    double                 *Binv, *w;
+    struct coarse_sys_meta *m;
+    struct coarse_sys      *sys;
+
+    sys = NULL;  Binv = NULL;  w = NULL;  ok = 0;
+
+    m = coarse_sys_meta_construct(g, p, ct);
+
+    if (m != NULL) {
+        Binv   = compute_fs_ip(g, perm, m, 0, NULL);
+        w      = coarse_weight(g, ct->nblocks, m, perm, src, NULL);
+        sys    = coarse_sys_allocate(ct, m);
+    }
+
+    if ((Binv != NULL) && (w != NULL) && (sys != NULL)) {
+
+        /* Provide reverse BF->face mapping for fs flux reconstruction */
+        map_dof_to_conn(ct, m, sys);
+
+        /* Prepare storage tables */
+        set_csys_block_pointers(ct, m, sys);
+
+        /* Include mobility effects (multiple phases) */
+        Binv_scale_mobility(g->number_of_cells, m, 0, NULL, totmob, Binv);
+
+        ok = compute_basis_functions(g, ct, m, Binv, w, 0, NULL, NULL,
+                                     parallel, linsolve, sys) >= 0;
+    }
+
+    if (ok) {
+        memcpy(sys->totmob, totmob,
+               g->number_of_cells * sizeof *sys->totmob);
+
+        compute_cell_ip(g->number_of_cells, m->max_ngconn,
+                        ct->nblocks, g->cell_facepos, m->pconn2,
+                        Binv, m->pb2c, m->b2c, NULL, sys);
+    } else {
+        coarse_sys_destroy(sys);
+        sys = NULL;
+    }
+
+    free(w);    free(Binv);
+    coarse_sys_meta_destroy(m);
+
+    return sys;
+}
+
+
 /* ======================================================================
  * Public interfaces below.
  * ====================================================================== */
@@ -1432,74 +1632,162 @@ coarse_sys_construct(struct UnstructuredGrid *g, const int   *p,
                      LocalSolver             linsolve)
 /* ---------------------------------------------------------------------- */
 {
-    int                     cf;
-    size_t                  nlocf;
+    return coarse_sys_construct_impl(g, p, ct, perm, src, totmob,
+                                     0, linsolve);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* As coarse_sys_construct(), but the local systems are assembled and
+ * solved concurrently on all available threads.  'linsolve' must
+ * therefore be safe to call from multiple threads at once. */
+/* ---------------------------------------------------------------------- */
+struct coarse_sys *
+coarse_sys_construct_parallel(struct UnstructuredGrid *g, const int   *p,
+                              struct coarse_topology *ct,
+                              const double           *perm,
+                              const double           *src,
+                              const double           *totmob,
+                              LocalSolver             linsolve)
+/* ---------------------------------------------------------------------- */
+{
+    return coarse_sys_construct_impl(g, p, ct, perm, src, totmob,
+                                     1, linsolve);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Update the basis functions of an existing coarse system to a new
+ * total mobility field.  A block is considered changed if the
+ * mobility of at least one of its cells differs by more than the
+ * relative tolerance 'mob_tol' from that recorded in sys->totmob.  All
+ * basis functions associated with a coarse face adjacent to a changed
+ * block are recomputed, as are the fine-scale inner products and
+ * coarse inner product contributions of all blocks adjacent to those
+ * faces.  Work is proportional to the number of cells in those blocks.
+ *
+ * Only the cells of changed blocks have their mobility recorded in
+ * sys->totmob, since every basis function of a changed block is
+ * rebuilt.  The other blocks keep the mobility of their oldest basis
+ * functions, so mobility drift is always measured against that.
+ *
+ * The local systems are solved concurrently, as in
+ * coarse_sys_construct_parallel(), if 'parallel' is non-zero.
+ * Remaining input parameters must be the same as those used to
+ * construct 'sys'.
+ *
+ * Returns the number of recomputed basis functions if successful and
+ * -1 if not (allocation failure). */
+/* ---------------------------------------------------------------------- */
+int
+coarse_sys_update(struct UnstructuredGrid *g, const int   *p,
+                  struct coarse_topology *ct,
+                  const double           *perm,
+                  const double           *src,
+                  const double           *totmob,
+                  double                  mob_tol,
+                  int                     parallel,
+                  LocalSolver             linsolve,
+                  struct coarse_sys      *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int                     b, c, cf, i, k, nbf, ncells, *nb, *cells;
+    char                   *blk_changed, *blk_touched, *recompute;
     double                 *Binv, *w;
     struct coarse_sys_meta *m;
-    struct bf_asm_data     *bf_asm;
-    struct coarse_sys      *sys;
 
-    sys = NULL;  bf_asm = NULL;  Binv = NULL;  w = NULL;
+    nbf = -1;  Binv = NULL;  w = NULL;  cells = NULL;
 
-    m = coarse_sys_meta_construct(g, p, ct);
+    blk_changed = malloc(2 * ct->nblocks * sizeof *blk_changed);
+    recompute   = malloc(ct->nfaces      * sizeof *recompute);
 
-    if (m != NULL) {
-        Binv   = compute_fs_ip(g, perm, m);
-        w      = coarse_weight(g, ct->nblocks, p, m, perm, src);
-        bf_asm = bf_asm_data_allocate(g, m);
-        sys    = coarse_sys_allocate(ct, m);
-    }
+    m = coarse_sys_meta_construct(g, p, ct);
 
-    if ((Binv != NULL) && (w != NULL) &&
-        (bf_asm != NULL) && (sys != NULL)) {
+    if ((m != NULL) && (blk_changed != NULL) && (recompute != NULL)) {
+        blk_touched = blk_changed + ct->nblocks;
 
-        /* Provide reverse BF->face mapping for fs flux reconstruction */
-        map_dof_to_conn(ct, m, sys);
+        for (b = 0; b < ct->nblocks; b++) {
+            blk_changed[b] = blk_touched[b] = 0;
+        }
 
-        /* Prepare storage tables */
-        set_csys_block_pointers(ct, m, sys);
+        for (c = 0; c < g->number_of_cells; c++) {
+            if (fabs(totmob[c] - sys->totmob[c]) >
+                mob_tol * fabs(sys->totmob[c])) {
+                blk_changed[p[c]] = 1;
+            }
+        }
 
-        /* Exclude effects of gravity */
-        vector_zero(g->cell_facepos[ g->number_of_cells ], bf_asm->gpress);
+        nbf = 0;
+        for (cf = 0; cf < ct->nfaces; cf++) {
+            nb = ct->neighbours + 2*cf;
 
-        /* Include mobility effects (multiple phases) */
-        Binv_scale_mobility(g->number_of_cells, m, totmob, Binv);
+            recompute[cf] = (m->bfno[cf] >= 0) &&
+                (((nb[0] >= 0) && blk_changed[nb[0]]) ||
+                 ((nb[1] >= 0) && blk_changed[nb[1]]));
 
-        /* Discretise flow equation on fine scale */
-        hybsys_schur_comp_symm(g->number_of_cells, g->cell_facepos,
-                               Binv, bf_asm->fsys);
+            if (recompute[cf]) {
+                for (i = 0; i < 2; i++) {
+                    if (nb[i] >= 0) { blk_touched[nb[i]] = 1; }
+                }
 
-        for (cf = 0; cf < ct->nfaces; cf++) {
-            if (m->bfno[cf] >= 0) {
-                nlocf = enumerate_local_dofs(cf, g, ct, m);
+                nbf += 1;
+            }
+        }
+    }
 
-                assemble_local_system(cf, nlocf, g, Binv, w,
-                                      ct, m, bf_asm);
+    if (nbf > 0) {
+        /* Cells of touched blocks */
+        ncells = 0;
+        for (b = 0; b < ct->nblocks; b++) {
+            if (blk_touched[b]) { ncells += m->pb2c[b + 1] - m->pb2c[b]; }
+        }
 
-                solve_local_system(cf, g, Binv, ct, m,
-                                   bf_asm, linsolve);
+        cells = malloc(ncells * sizeof *cells);
 
-                store_basis_function(cf, ct, m, bf_asm, sys);
+        nbf = -1;
 
-                unenumerate_local_dofs(cf, g, ct, m);
+        if (cells != NULL) {
+            for (b = k = 0; b < ct->nblocks; b++) {
+                if (blk_touched[b]) {
+                    for (i = m->pb2c[b]; i < m->pb2c[b + 1]; i++) {
+                        cells[k++] = m->b2c[i];
+                    }
+                }
             }
+
+            Binv = compute_fs_ip(g, perm, m, ncells, cells);
+            w    = coarse_weight(g, ct->nblocks, m, perm, src, blk_touched);
         }
 
-        coarse_sys_compute_cell_ip(g->number_of_cells,
-                                   m->max_ngconn,
-                                   ct->nblocks,
-                                   g->cell_facepos,
-                                   Binv,
-                                   m->pb2c, m->b2c,
-                                   sys);
-    }
+        if ((Binv != NULL) && (w != NULL)) {
+            Binv_scale_mobility(g->number_of_cells, m, ncells, cells,
+                                totmob, Binv);
 
-    bf_asm_data_deallocate(bf_asm);
+            nbf = compute_basis_functions(g, ct, m, Binv, w,
+                                          ncells, cells, recompute,
+                                          parallel, linsolve, sys);
+        }
 
-    free(w);    free(Binv);
+        if (nbf > 0) {
+            for (k = 0; k < ncells; k++) {
+                c = cells[k];
+
+                if (blk_changed[p[c]]) {
+                    sys->totmob[c] = totmob[c];
+                }
+            }
+
+            compute_cell_ip(g->number_of_cells, m->max_ngconn,
+                            ct->nblocks, g->cell_facepos, m->pconn2,
+                            Binv, m->pb2c, m->b2c, blk_touched, sys);
+        }
+    }
+
+    free(w);  free(Binv);  free(cells);
     coarse_sys_meta_destroy(m);
+    free(recompute);  free(blk_changed);
 
-    return sys;
+    return nbf;
 }
 
 
@@ -1511,6 +1799,7 @@ coarse_sys_destroy(struct coarse_sys *sys)
 /* ---------------------------------------------------------------------- */
 {
     if (sys != NULL) {
+        free(sys->totmob);
         free(sys->Binv);
         free(sys->cell_ip);
         free(sys->basis);
@@ -1548,7 +1837,31 @@ coarse_sys_compute_cell_ip(int                nc,
                            struct coarse_sys *sys)
 /* ---------------------------------------------------------------------- */
 {
-    int i, i1, i2, b, c, n, bf, *pconn2;
+    compute_cell_ip(nc, max_nconn, nb, pconn, NULL, Binv,
+                    b2c_pos, b2c, NULL, sys);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Implementation of coarse_sys_compute_cell_ip().  Restricted to those
+ * blocks for which active[b] is non-zero if 'active' is not NULL.
+ * Start pointers 'pconn2' to each cell's block of 'Binv' are derived
+ * from 'pconn' if NULL. */
+/* ---------------------------------------------------------------------- */
+static void
+compute_cell_ip(int                nc,
+                int                max_nconn,
+                int                nb,
+                const int         *pconn,
+                const int         *pconn2,
+                const double      *Binv,
+                const int         *b2c_pos,
+                const int         *b2c,
+                const char        *active,
+                struct coarse_sys *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int i, i1, i2, b, c, n, bf, *own_pconn2;
     int max_nbf, nbf, loc_nc;
 
     size_t p, nbf_pairs, bf_off, bf_sz;
@@ -1565,7 +1878,12 @@ coarse_sys_compute_cell_ip(int                nc,
 
     max_nbf = max_diff(nb, sys->blkdof_pos);
 
-    pconn2  = malloc((nc + 1) * sizeof *pconn2);
+    own_pconn2 = NULL;
+    if (pconn2 == NULL) {
+        own_pconn2 = mim_ip_offsets(nc, pconn);
+        pconn2     = own_pconn2;
+    }
+
     work    = malloc(((max_nconn * max_nconn) + /* BI */
                       (max_nconn * max_nbf  ) + /* Psi */
                       (max_nbf   * max_nbf  ))  /* IP */
@@ -1576,18 +1894,13 @@ coarse_sys_compute_cell_ip(int                nc,
         Psi = BI   + (max_nconn * max_nconn);
         IP  = Psi  + (max_nconn * max_nbf  );
 
-        pconn2[0] = 0;
-
-        for (i = 1; i <= nc; i++) {
-            n         = pconn[i] - pconn[i - 1];
-            pconn2[i] = pconn2[i - 1] + (n * n);
-        }
-
 #if DEBUG_OUTPUT
         fp = fopen("debug_out.m", "wt");
 #endif
 
         for (b = 0; b < nb; b++) {
+            if ((active != NULL) && ! active[b]) { continue; }
+
             loc_nc = b2c_pos[b + 1] - b2c_pos[b];
             bf_off = 0;
             nbf    = sys->blkdof_pos[b + 1] - sys->blkdof_pos[b];
@@ -1689,7 +2002,7 @@ coarse_sys_compute_cell_ip(int                nc,
 #endif
     }
 
-    free(work);  free(pconn2);
+    free(work);  free(own_pconn2);
 }
 
 
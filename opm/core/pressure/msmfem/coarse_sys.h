@@ -38,6 +38,7 @@ struct coarse_sys {
     double *basis;           /* All basis functions */
     double *cell_ip;         /* Fine-scale IP contributions */
     double *Binv;            /* Coarse-scale inverse IP per block */
+    double *totmob;          /* Mobility underlying basis functions */
 };
 
 
@@ -46,6 +47,10 @@ struct coarse_sys {
 struct coarse_topology;
 struct CSRMatrix;
 
+/* Local solvers are invoked from one thread at a time, except by
+ * coarse_sys_construct_parallel() and by coarse_sys_update() with
+ * 'parallel' set, which call them concurrently from multiple threads,
+ * each call with its own matrix and vectors. */
 typedef void (*LocalSolver)(struct CSRMatrix *A,
                             double           *b,
                             double           *x);
@@ -58,6 +63,25 @@ coarse_sys_construct(struct UnstructuredGrid *g, const int   *p,
                      const double           *totmob,
                      LocalSolver             linsolve);
 
+struct coarse_sys *
+coarse_sys_construct_parallel(struct UnstructuredGrid *g, const int   *p,
+                              struct coarse_topology *ct,
+                              const double           *perm,
+                              const double           *src,
+                              const double           *totmob,
+                              LocalSolver             linsolve);
+
+int
+coarse_sys_update(struct UnstructuredGrid *g, const int   *p,
+                  struct coarse_topology *ct,
+                  const double           *perm,
+                  const double           *src,
+                  const double           *totmob,
+                  double                  mob_tol,
+                  int                     parallel,
+                  LocalSolver             linsolve,
+                  struct coarse_sys      *sys);
+
 void
 coarse_sys_destroy(struct coarse_sys *sys);
 
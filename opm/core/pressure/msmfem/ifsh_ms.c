@@ -435,7 +435,7 @@ ifsh_ms_destroy(struct ifsh_ms_data *h)
 
 
 /* ---------------------------------------------------------------------- */
-void
+int
 ifsh_ms_assemble(const double        *src   ,
                  const double        *totmob,
                  struct ifsh_ms_data *h)
@@ -460,9 +460,11 @@ ifsh_ms_assemble(const double        *src   ,
                             h->pimpl->max_bcells, totmob,
                             pb2c, b2c, h->pimpl->sys, h->pimpl->work);
 
-    hybsys_schur_comp_symm(h->pimpl->ct->nblocks,
-                           h->pimpl->sys->blkdof_pos,
-                           h->pimpl->sys->Binv, h->pimpl->hsys);
+    if (! hybsys_schur_comp_symm(h->pimpl->ct->nblocks,
+                                 h->pimpl->sys->blkdof_pos,
+                                 h->pimpl->sys->Binv, h->pimpl->hsys)) {
+        return 0;
+    }
 
     csrmatrix_zero(         h->A);
     vector_zero   (h->A->m, h->b);
@@ -489,6 +491,8 @@ ifsh_ms_assemble(const double        *src   ,
 
     /* Remove zero eigenvalue */
     h->A->sa[0] *= 2;
+
+    return 1;
 }
 
 
@@ -54,7 +54,9 @@ ifsh_ms_construct(struct UnstructuredGrid       *G,
 void
 ifsh_ms_destroy(struct ifsh_ms_data *h);
 
-void
+/* Returns one (1) if successful and zero (0) if memory allocation
+ * failed. */
+int
 ifsh_ms_assemble(const double        *src,
                  const double        *totmob,
                  struct ifsh_ms_data *h);
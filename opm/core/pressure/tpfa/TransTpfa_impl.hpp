@@ -1,4 +1,4 @@
-#include <opm/core/linalg/blas_lapack.h>
+#include <opm/core/linalg/small_dense.h>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 #include <opm/core/grid/GridHelpers.hpp>
 
@@ -68,14 +68,8 @@ tpfa_htrans_compute(const Grid* G, const double *perm, double *htrans)
     const double *n;
     const double *K;
 
-    MAT_SIZE_T nrows, ncols, ldA, incx, incy;
-    double a1, a2;
-
     d = dimensions(*G);
-
-    nrows = ncols    = ldA = d;
-    incx  = incy     = 1      ;
-    a1    = 1.0;  a2 = 0.0    ;
+    assert (small_dense_supported(d));  /* Kn[] has room for d <= 3 */
 
     for (int c =0, i = 0; c < numCells(*G); c++) {
         K  = perm + (c * d * d);
@@ -90,8 +84,7 @@ tpfa_htrans_compute(const Grid* G, const double *perm, double *htrans)
             n = faceNormal(*G, *f);
             const double* nn=multiplyFaceNormalWithArea(*G, *f, n);
             const double* fc = &(faceCentroid(*G, *f)[0]);
-            dgemv_("No Transpose", &nrows, &ncols,
-                   &a1, K, &ldA, nn, &incx, &a2, &Kn[0], &incy);
+            small_dense_matvec(d, d, K, nn, &Kn[0]);
             maybeFreeFaceNormal(*G, nn);
             
             htrans[i] = denom = 0.0;
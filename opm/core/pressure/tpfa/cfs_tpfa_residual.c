@@ -9,6 +9,7 @@
 #include <opm/core/wells.h>
 #include <opm/core/well_controls.h>
 #include <opm/core/linalg/blas_lapack.h>
+#include <opm/core/linalg/small_dense.h>
 #include <opm/core/linalg/sparse_sys.h>
 
 #include <opm/core/pressure/tpfa/compr_quant_general.h>
@@ -56,8 +57,15 @@ struct cfs_tpfa_res_impl {
 
     struct densrat_util *ratio;
 
+    /* Positions of matrix elements in J->sa, computed once */
+    int                 *diag;    /* Diagonal element of each row */
+    int                 *hf_nnz;  /* Element (c, nb) of each half-face */
+    int                 *perf_cw; /* Element (c, w) of each perforation */
+    int                 *perf_wc; /* Element (w, c) of each perforation */
+
     /* Linear storage */
     double *ddata;
+    int    *idata;
 };
 
 
@@ -121,6 +129,7 @@ impl_deallocate(struct cfs_tpfa_res_impl *pimpl)
 /* ---------------------------------------------------------------------- */
 {
     if (pimpl != NULL) {
+        free              (pimpl->idata);
         free              (pimpl->ddata);
         deallocate_densrat(pimpl->ratio);
     }
@@ -137,12 +146,13 @@ impl_allocate(struct UnstructuredGrid   *G       ,
               int                        np      )
 /* ---------------------------------------------------------------------- */
 {
-    size_t                nnu, nwperf;
+    size_t                nnu, nhf, nwperf;
     struct cfs_tpfa_res_impl *new;
 
-    size_t ddata_sz;
+    size_t ddata_sz, idata_sz;
 
     nnu    = G->number_of_cells;
+    nhf    = G->cell_facepos[ G->number_of_cells ];
     nwperf = 0;
 
     if ((wells != NULL) && (wells->W != NULL)) {
@@ -165,18 +175,31 @@ impl_allocate(struct UnstructuredGrid   *G       ,
 
     ddata_sz += 1  *      G->number_of_faces ; /* scratch_f */
 
+    /* Matrix element positions */
+    idata_sz  = nnu;                           /* diag */
+    idata_sz += nhf;                           /* hf_nnz */
+    idata_sz += 2 * nwperf;                    /* perf_cw, perf_wc */
+
     new = malloc(1 * sizeof *new);
 
     if (new != NULL) {
         new->ddata = malloc(ddata_sz * sizeof *new->ddata);
+        new->idata = malloc(idata_sz * sizeof *new->idata);
         new->ratio = allocate_densrat(max_conn, np);
 
-        if (new->ddata == NULL || new->ratio == NULL) {
+        if (new->ddata == NULL || new->idata == NULL || new->ratio == NULL) {
             impl_deallocate(new);
             new = NULL;
         }
     }
 
+    if (new != NULL) {
+        new->diag    = new->idata;
+        new->hf_nnz  = new->diag    + nnu;
+        new->perf_cw = new->hf_nnz  + nhf;
+        new->perf_wc = new->perf_cw + nwperf;
+    }
+
     return new;
 }
 
@@ -281,12 +304,74 @@ construct_matrix(struct UnstructuredGrid   *G    ,
 }
 
 
+/* ---------------------------------------------------------------------- */
+/* Record the position in J->sa of every matrix element touched during
+ * assembly, so that assembly need not search the sparsity structure. */
+/* ---------------------------------------------------------------------- */
+static void
+compute_nnz_index(struct UnstructuredGrid   *G    ,
+                  struct cfs_tpfa_res_wells *wells,
+                  const struct CSRMatrix    *J    ,
+                  struct cfs_tpfa_res_impl  *pimpl)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, c1, c2, f, i, w, nc;
+    size_t r;
+
+    nc = G->number_of_cells;
+
+    for (r = 0; r < J->m; r++) {
+        pimpl->diag[r] = (int) csrmatrix_elm_index((int) r, (int) r, J);
+    }
+
+    for (c = i = 0; c < nc; c++) {
+        for (; i < G->cell_facepos[c + 1]; i++) {
+            f  = G->cell_faces[i];
+
+            c1 = G->face_cells[2*f + 0];
+            c2 = G->face_cells[2*f + 1];
+
+            c2 = (c1 == c) ? c2 : c1;
+
+            pimpl->hf_nnz[i] = -1;
+            if (c2 >= 0) {
+                pimpl->hf_nnz[i] = (int) csrmatrix_elm_index(c, c2, J);
+            }
+        }
+    }
+
+    if ((wells != NULL) && (wells->W != NULL)) {
+        struct Wells *W = wells->W;
+
+        for (w = i = 0; w < W->number_of_wells; w++) {
+            for (; i < W->well_connpos[w + 1]; i++) {
+                c = W->well_cells[i];
+
+                pimpl->perf_cw[i] = (int) csrmatrix_elm_index(c     , nc + w, J);
+                pimpl->perf_wc[i] = (int) csrmatrix_elm_index(nc + w, c     , J);
+            }
+        }
+    }
+}
+
+
+/* For np <= 3 (see small_dense_supported()), 'ratio->lu' holds the
+ * explicit inverse of the fluid matrix rather than its LU factors.
+ * Solving then amounts to a single fixed-size matrix product over all
+ * right-hand sides of the cell. */
 static void
 factorise_fluid_matrix(int np, const double *A, struct densrat_util *ratio)
 {
     int        np2;
     MAT_SIZE_T m, n, ld, info;
 
+    if (small_dense_supported(np)) {
+        info = small_dense_invert(np, A, ratio->lu);
+
+        assert (info == 0);
+        return;
+    }
+
     m = n = ld = np;
     np2 = np * np;
 
@@ -305,6 +390,11 @@ solve_linear_systems(int                  np   ,
 {
     MAT_SIZE_T n, ldA, ldB, info;
 
+    if (small_dense_supported(np)) {
+        small_dense_matmat_inplace(np, nrhs, ratio->lu, b);
+        return;
+    }
+
     n = ldA = ldB = np;
 
     dgetrs_("No Transpose", &n,
@@ -321,6 +411,11 @@ matvec(int nrow, int ncol, const double *A, const double *x, double *y)
     MAT_SIZE_T m, n, ld, incx, incy;
     double     a1, a2;
 
+    if (small_dense_supported(nrow)) {
+        small_dense_matvec(nrow, ncol, A, x, y);
+        return;
+    }
+
     m    = ld = nrow;
     n    = ncol;
     incx = incy = 1;
@@ -339,6 +434,11 @@ matmat(int np, int ncol, const double *A, const double *B, double *C)
     MAT_SIZE_T m, n, k, ldA, ldB, ldC;
     double     a1, a2;
 
+    if (small_dense_supported(np)) {
+        small_dense_matmat(np, ncol, A, B, C);
+        return;
+    }
+
     m  = k = ldA = ldB = ldC = np;
     n  = ncol;
     a1 = 1.0;
@@ -643,7 +743,7 @@ assemble_cell_contrib(struct UnstructuredGrid  *G,
 {
     int c1, c2, i, f, j1, j2, off;
 
-    j1 = csrmatrix_elm_index(c, c, h->J);
+    j1 = h->pimpl->diag[ c ];
 
     h->J->sa[j1] += h->pimpl->ratio->mat_row[ 0 ];
 
@@ -657,7 +757,7 @@ assemble_cell_contrib(struct UnstructuredGrid  *G,
         c2 = (c1 == c) ? c2 : c1;
 
         if (c2 >= 0) {
-            j2 = csrmatrix_elm_index(c, c2, h->J);
+            j2 = h->pimpl->hf_nnz[ i ];
 
             h->J->sa[j2] += h->pimpl->ratio->mat_row[ off ];
         }
@@ -701,7 +801,7 @@ init_completion_contrib(int                       i    ,
 
 
 static void
-assemble_completion_to_cell(int c, int wdof, int np, double dt,
+assemble_completion_to_cell(int i, int c, int wdof, int np, double dt,
                             struct cfs_tpfa_res_data *h)
 {
     int    p;
@@ -723,8 +823,8 @@ assemble_completion_to_cell(int c, int wdof, int np, double dt,
 
     /* Assemble Jacobian contributions from well completion. */
     assert (wdof > c);
-    jc = csrmatrix_elm_index(c, c   , h->J);
-    jw = csrmatrix_elm_index(c, wdof, h->J);
+    jc = h->pimpl->diag   [ c ];
+    jw = h->pimpl->perf_cw[ i ];
 
     /* Compressibility-like (diagonal) Jacobian term.  Positive sign
      * since the negative derivative in ->ratio->t2 (see
@@ -850,7 +950,7 @@ welleq_coeff_surfrate(int i, int np, struct cfs_tpfa_res_data *h,
 
 /* ---------------------------------------------------------------------- */
 static void
-assemble_completion_to_well(int i, int w, int c, int nc, int np,
+assemble_completion_to_well(int i, int w, int nc, int np,
                             double pw, double dt,
                             struct cfs_tpfa_res_wells *wells,
                             struct cfs_tpfa_res_data  *h    )
@@ -894,8 +994,8 @@ assemble_completion_to_well(int i, int w, int c, int nc, int np,
 
     /* Assemble completion contributions */
     wdof = nc + w;
-    jc   = csrmatrix_elm_index(wdof, c   , h->J);
-    jw   = csrmatrix_elm_index(wdof, wdof, h->J);
+    jc   = h->pimpl->perf_wc[ i    ];
+    jw   = h->pimpl->diag   [ wdof ];
 
     h->F    [ wdof ] += dt * res;
     h->J->sa[ jc   ] += dt * w2c;
@@ -947,7 +1047,7 @@ assemble_well_contrib(struct cfs_tpfa_res_wells   *wells ,
             init_completion_contrib(i, np, Ac, dAc, h->pimpl);
 
             if (is_open) {
-                assemble_completion_to_cell(c, nc + w, np, dt, h);
+                assemble_completion_to_cell(i, c, nc + w, np, dt, h);
             }
 
             /* Prepare for RESV controls */
@@ -955,7 +1055,7 @@ assemble_well_contrib(struct cfs_tpfa_res_wells   *wells ,
                                         h->pimpl->flux_work,
                                         h->pimpl->flux_work + np);
 
-            assemble_completion_to_well(i, w, c, nc, np, pw, dt, wells, h);
+            assemble_completion_to_well(i, w, nc, np, pw, dt, wells, h);
         }
 
         ctrl = W->ctrls[ w ];
@@ -1209,6 +1309,8 @@ cfs_tpfa_res_construct(struct UnstructuredGrid   *G      ,
 
         h->pimpl->scratch_f        =
             h->pimpl->flux_work                      + (nphases * (1 + 2));
+
+        compute_nnz_index(G, wells, h->J, h->pimpl);
     }
 
     return h;
@@ -1322,7 +1424,7 @@ cfs_tpfa_res_comprock_assemble(
     /* Add new terms to residual and Jacobian. */
     rock_is_incomp = 1;
     for (c = 0; c < G->number_of_cells; c++) {
-        j = csrmatrix_elm_index(c, c, h->J);
+        j = h->pimpl->diag[ c ];
 
         dpv = (porevol[c] - porevol0[c]);
         if (dpv != 0.0 || rock_comp[c] != 0.0) {
@@ -37,8 +37,15 @@ struct ifs_tpfa_impl {
     double *fgrav;              /* Accumulated grav contrib/face */
     double *work;
 
+    /* Positions of matrix elements in A->sa, computed once */
+    int    *diag;               /* Diagonal element of each row */
+    int    *hf_nnz;             /* Element (c, nb) of each half-face */
+    int    *perf_cw;            /* Element (c, w) of each perforation */
+    int    *perf_wc;            /* Element (w, c) of each perforation */
+
     /* Linear storage */
     double *ddata;
+    int    *idata;
 };
 
 
@@ -48,6 +55,7 @@ impl_deallocate(struct ifs_tpfa_impl *pimpl)
 /* ---------------------------------------------------------------------- */
 {
     if (pimpl != NULL) {
+        free(pimpl->idata);
         free(pimpl->ddata);
     }
 
@@ -63,29 +71,44 @@ impl_allocate(struct UnstructuredGrid *G,
 {
     struct ifs_tpfa_impl *new;
 
-    size_t nnu;
-    size_t ddata_sz;
+    size_t nnu, nhf, nwperf;
+    size_t ddata_sz, idata_sz;
 
-    nnu = G->number_of_cells;
+    nnu    = G->number_of_cells;
+    nhf    = G->cell_facepos[ G->number_of_cells ];
+    nwperf = 0;
     if (W != NULL) {
-        nnu += W->number_of_wells;
+        nnu    += W->number_of_wells;
+        nwperf  = W->well_connpos[ W->number_of_wells ];
     }
 
     ddata_sz  = 2 * nnu;                 /* b, x */
     ddata_sz += 1 * G->number_of_faces;  /* fgrav */
     ddata_sz += 1 * nnu;                 /* work */
 
+    idata_sz  = 1 * nnu;                 /* diag */
+    idata_sz += 1 * nhf;                 /* hf_nnz */
+    idata_sz += 2 * nwperf;              /* perf_cw, perf_wc */
+
     new = malloc(1 * sizeof *new);
 
     if (new != NULL) {
         new->ddata = malloc(ddata_sz * sizeof *new->ddata);
+        new->idata = malloc(idata_sz * sizeof *new->idata);
 
-        if (new->ddata == NULL) {
+        if ((new->ddata == NULL) || (new->idata == NULL)) {
             impl_deallocate(new);
             new = NULL;
         }
     }
 
+    if (new != NULL) {
+        new->diag    = new->idata;
+        new->hf_nnz  = new->diag    + nnu;
+        new->perf_cw = new->hf_nnz  + nhf;
+        new->perf_wc = new->perf_cw + nwperf;
+    }
+
     return new;
 }
 
@@ -183,6 +206,55 @@ ifs_tpfa_construct_matrix(struct UnstructuredGrid *G,
 }
 
 
+/* ---------------------------------------------------------------------- */
+/* Record the position in A->sa of every matrix element touched during
+ * assembly, so that assembly need not search the sparsity structure. */
+/* ---------------------------------------------------------------------- */
+static void
+compute_nnz_index(struct UnstructuredGrid *G    ,
+                  struct Wells            *W    ,
+                  const struct CSRMatrix  *A    ,
+                  struct ifs_tpfa_impl    *pimpl)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, c1, c2, f, i, w, nc;
+    size_t r;
+
+    nc = G->number_of_cells;
+
+    for (r = 0; r < A->m; r++) {
+        pimpl->diag[r] = (int) csrmatrix_elm_index((int) r, (int) r, A);
+    }
+
+    for (c = i = 0; c < nc; c++) {
+        for (; i < G->cell_facepos[c + 1]; i++) {
+            f  = G->cell_faces[i];
+
+            c1 = G->face_cells[2*f + 0];
+            c2 = G->face_cells[2*f + 1];
+
+            c2 = (c1 == c) ? c2 : c1;
+
+            pimpl->hf_nnz[i] = -1;
+            if (c2 >= 0) {
+                pimpl->hf_nnz[i] = (int) csrmatrix_elm_index(c, c2, A);
+            }
+        }
+    }
+
+    if (W != NULL) {
+        for (w = i = 0; w < W->number_of_wells; w++) {
+            for (; i < W->well_connpos[w + 1]; i++) {
+                c = W->well_cells[i];
+
+                pimpl->perf_cw[i] = (int) csrmatrix_elm_index(c     , nc + w, A);
+                pimpl->perf_wc[i] = (int) csrmatrix_elm_index(nc + w, c     , A);
+            }
+        }
+    }
+}
+
+
 /* ---------------------------------------------------------------------- */
 /* fgrav = accumarray(cf(j), grav(j).*sgn(j), [nf, 1]) */
 /* ---------------------------------------------------------------------- */
@@ -232,14 +304,14 @@ assemble_bhp_well(int nc, int w,
     wdof  = nc + w;
     bhp   = well_controls_get_current_target(ctrls);
 
-    jw    = csrmatrix_elm_index(wdof, wdof, h->A);
+    jw    = h->pimpl->diag[ wdof ];
 
     for (i = W->well_connpos[w]; i < W->well_connpos[w + 1]; i++) {
 
         c     = W->well_cells  [ i ];
         trans = mt[ c ] * W->WI[ i ];
 
-        jc = csrmatrix_elm_index(c, c, h->A);
+        jc = h->pimpl->diag[ c ];
 
         /* c<->c diagonal contribution from well */
         h->A->sa[ jc   ] += trans;
@@ -271,15 +343,15 @@ assemble_rate_well(int nc, int w,
     wdof  = nc + w;
     resv  = well_controls_get_current_target(ctrls);
 
-    jww   = csrmatrix_elm_index(wdof, wdof, h->A);
+    jww   = h->pimpl->diag[ wdof ];
 
     for (i = W->well_connpos[w]; i < W->well_connpos[w + 1]; i++) {
 
         c   = W->well_cells[ i ];
 
-        jcc = csrmatrix_elm_index(c   , c   , h->A);
-        jcw = csrmatrix_elm_index(c   , wdof, h->A);
-        jwc = csrmatrix_elm_index(wdof, c   , h->A);
+        jcc = h->pimpl->diag   [ c ];
+        jcw = h->pimpl->perf_cw[ i ];
+        jwc = h->pimpl->perf_wc[ i ];
 
         /* Connection transmissibility */
         trans = mt[ c ] * W->WI[ i ];
@@ -326,7 +398,7 @@ assemble_shut_well(int nc, int w,
 
     wdof  = nc + w;
 
-    jw    = csrmatrix_elm_index(wdof, wdof, h->A);
+    jw    = h->pimpl->diag[ wdof ];
 
     for (i = W->well_connpos[w]; i < W->well_connpos[w + 1]; i++) {
 
@@ -448,7 +520,7 @@ assemble_bc_contrib(struct UnstructuredGrid             *G    ,
                 t  = trans[ f ];
                 s  = 2.0*is_outflow - 1.0;
                 c1 = is_outflow ? c1 : c2;
-                ix = csrmatrix_elm_index(c1, c1, h->A);
+                ix = h->pimpl->diag[ c1 ];
 
                 h->A->sa[ ix ] += t;
                 h->b    [ c1 ] += t * bc->value[ i ];
@@ -605,7 +677,7 @@ assemble_incompressible(struct UnstructuredGrid      *G     ,
     compute_grav_term(G, gpress, h->pimpl->fgrav);
 
     for (c = i = 0; c < G->number_of_cells; c++) {
-        j1 = csrmatrix_elm_index(c, c, h->A);
+        j1 = h->pimpl->diag[c];
 
         for (; i < G->cell_facepos[c + 1]; i++) {
             f = G->cell_faces[i];
@@ -619,7 +691,7 @@ assemble_incompressible(struct UnstructuredGrid      *G     ,
             h->b[c] -= trans[f] * (s * h->pimpl->fgrav[f]);
 
             if (c2 >= 0) {
-                j2 = csrmatrix_elm_index(c, c2, h->A);
+                j2 = h->pimpl->hf_nnz[i];
 
                 h->A->sa[j1] += trans[f];
                 h->A->sa[j2] -= trans[f];
@@ -691,6 +763,8 @@ ifs_tpfa_construct(struct UnstructuredGrid *G,
 
         new->pimpl->fgrav = new->x            + new->A->m;
         new->pimpl->work  = new->pimpl->fgrav + G->number_of_faces;
+
+        compute_nnz_index(G, W, new->A, new->pimpl);
     }
 
     return new;
@@ -748,7 +822,7 @@ ifs_tpfa_assemble_comprock(struct UnstructuredGrid      *G        ,
      */
     if (ok) {
         for (c = 0; c < G->number_of_cells; c++) {
-            j = csrmatrix_elm_index(c, c, h->A);
+            j = h->pimpl->diag[c];
 
             d = porevol[c] * rock_comp[c] / dt;
 
@@ -792,7 +866,7 @@ ifs_tpfa_assemble_comprock_increment(struct UnstructuredGrid      *G        ,
         mult_csr_matrix(h->A, prev_pressure, v);
 
         for (c = 0; c < G->number_of_cells; c++) {
-            j = csrmatrix_elm_index(c, c, h->A);
+            j = h->pimpl->diag[c];
 
             dpvdt = (porevol[c] - initial_porevolume[c]) / dt;
 
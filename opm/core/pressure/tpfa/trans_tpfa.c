@@ -4,7 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <opm/core/linalg/blas_lapack.h>
+#include <opm/core/linalg/small_dense.h>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 
 
@@ -13,59 +13,155 @@
 #endif
 
 /* ---------------------------------------------------------------------- */
-/* htrans <- sum(C(:,i) .* K(cellNo,:) .* N(:,j), 2) ./ sum(C.*C, 2) */
+/* htrans <- sum(C(:,i) .* K(c,:) .* N(:,j), 2) ./ sum(C.*C, 2), cell c   */
+/*                                                                        */
+/* Inlined with a constant dimension 'd' by cells_htrans() to get fully   */
+/* unrolled 2D and 3D loops.                                              */
 /* ---------------------------------------------------------------------- */
-void
-tpfa_htrans_compute(struct UnstructuredGrid *G, const double *perm, double *htrans)
+static inline void
+cell_htrans(const struct UnstructuredGrid *G     ,
+            int                            d     ,
+            int                            c     ,
+            const double                  *perm  ,
+            double                        *htrans)
 /* ---------------------------------------------------------------------- */
 {
-    #ifdef __cplusplus
-    return tpfa_htrans_compute<UnstructuredGrid>(G, totmob, htrans, trans);
-    #endif
-    
-    int    c, d, f, i, j;
+    int    f, i, j;
     double s, dist, denom;
 
     double Kn[3];
-    double *cc, *fc, *n;
-    const double *K;
+    const double *cc, *fc, *n, *K;
+
+    K  = perm + (c * d * d);
+    cc = G->cell_centroids + (c * d);
+
+    for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+        f = G->cell_faces[i];
+        s = 2.0*(G->face_cells[2*f + 0] == c) - 1.0;
+
+        n  = G->face_normals   + (f * d);
+        fc = G->face_centroids + (f * d);
+
+        small_dense_matvec(d, d, K, n, &Kn[0]);
+
+        htrans[i] = denom = 0.0;
+        for (j = 0; j < d; j++) {
+            dist = fc[j] - cc[j];
+
+            htrans[i] += s * dist * Kn[j];
+            denom     +=     dist * dist;
+        }
+
+        assert (denom > 0);
+        htrans[i] /= denom;
+        htrans[i]  = fabs(htrans[i]);
+    }
+}
+
 
-    MAT_SIZE_T nrows, ncols, ldA, incx, incy;
-    double a1, a2;
+/* ---------------------------------------------------------------------- */
+/* One-sided transmissibilities of cells[0 .. ncells-1], or of all cells  */
+/* if 'cells' is NULL.  Cells are independent, so the loop is parallel.  */
+/* ---------------------------------------------------------------------- */
+static void
+cells_htrans(const struct UnstructuredGrid *G     ,
+             int                            ncells,
+             const int                     *cells ,
+             const double                  *perm  ,
+             double                        *htrans)
+/* ---------------------------------------------------------------------- */
+{
+    int c, d, k;
 
     d = G->dimensions;
+    assert (small_dense_supported(d));  /* Kn[] has room for d <= 3 */
+
+    switch (d) {
+    case 2:
+#pragma omp parallel for schedule(static) private(c)
+        for (k = 0; k < ncells; k++) {
+            c = (cells != NULL) ? cells[k] : k;
+            cell_htrans(G, 2, c, perm, htrans);
+        }
+        break;
 
-    nrows = ncols    = ldA = d;
-    incx  = incy     = 1      ;
-    a1    = 1.0;  a2 = 0.0    ;
+    case 3:
+#pragma omp parallel for schedule(static) private(c)
+        for (k = 0; k < ncells; k++) {
+            c = (cells != NULL) ? cells[k] : k;
+            cell_htrans(G, 3, c, perm, htrans);
+        }
+        break;
+
+    default:
+#pragma omp parallel for schedule(static) private(c)
+        for (k = 0; k < ncells; k++) {
+            c = (cells != NULL) ? cells[k] : k;
+            cell_htrans(G, d, c, perm, htrans);
+        }
+        break;
+    }
+}
 
-    for (c = i = 0; c < G->number_of_cells; c++) {
-        K  = perm + (c * d * d);
-        cc = G->cell_centroids + (c * d);
 
-        for (; i < G->cell_facepos[c + 1]; i++) {
-            f = G->cell_faces[i];
-            s = 2.0*(G->face_cells[2*f + 0] == c) - 1.0;
+/* ---------------------------------------------------------------------- */
+/* T_f = 1 / sum(1 / (totmob(c) * htrans)) over the half-faces of face    */
+/* 'f'.  Unit mobility if 'totmob' is NULL.  Reads only the neighbouring  */
+/* cells' half-faces, so faces may be processed in parallel.              */
+/* ---------------------------------------------------------------------- */
+static double
+face_trans(const struct UnstructuredGrid *G, const double *totmob,
+           const double *htrans, int f)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, i, k;
+    double t;
 
-            n  = G->face_normals   + (f * d);
-            fc = G->face_centroids + (f * d);
+    t = 0.0;
 
-            dgemv_("No Transpose", &nrows, &ncols,
-                   &a1, K, &ldA, n, &incx, &a2, &Kn[0], &incy);
+    for (k = 0; k < 2; k++) {
+        c = G->face_cells[2*f + k];
 
-            htrans[i] = denom = 0.0;
-            for (j = 0; j < d; j++) {
-                dist = fc[j] - cc[j];
+        if (c < 0) { continue; }
 
-                htrans[i] += s * dist * Kn[j];
-                denom     +=     dist * dist;
+        for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+            if (G->cell_faces[i] == f) {
+                t += 1.0 / ((totmob != NULL) ? totmob[c] * htrans[i]
+                                             :             htrans[i]);
+                break;
             }
-
-            assert (denom > 0);
-            htrans[i] /= denom;
-            htrans[i]  = fabs(htrans[i]);
         }
     }
+
+    return 1.0 / t;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* htrans <- sum(C(:,i) .* K(cellNo,:) .* N(:,j), 2) ./ sum(C.*C, 2) */
+/* ---------------------------------------------------------------------- */
+void
+tpfa_htrans_compute(struct UnstructuredGrid *G, const double *perm, double *htrans)
+/* ---------------------------------------------------------------------- */
+{
+    #ifdef __cplusplus
+    return tpfa_htrans_compute<UnstructuredGrid>(G, totmob, htrans, trans);
+    #endif
+
+    cells_htrans(G, G->number_of_cells, NULL, perm, htrans);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+tpfa_htrans_update(struct UnstructuredGrid *G     ,
+                   const double            *perm  ,
+                   int                      ncells,
+                   const int               *cells ,
+                   double                  *htrans)
+/* ---------------------------------------------------------------------- */
+{
+    cells_htrans(G, ncells, cells, perm, htrans);
 }
 
 
@@ -78,22 +174,33 @@ tpfa_trans_compute(struct UnstructuredGrid *G, const double *htrans, double *tra
     return tpfa_trans_compute<UnstructuredGrid>(G, totmob, htrans, trans);
     #endif
     
-    int c, i, f;
+    int f;
 
+#pragma omp parallel for schedule(static)
     for (f = 0; f < G->number_of_faces; f++) {
-        trans[f] = 0.0;
+        trans[f] = face_trans(G, NULL, htrans, f);
     }
+}
 
-    for (c = i = 0; c < G->number_of_cells; c++) {
-        for (; i < G->cell_facepos[c + 1]; i++) {
-            f = G->cell_faces[i];
 
-            trans[f] += 1.0 / htrans[i];
-        }
-    }
+/* ---------------------------------------------------------------------- */
+void
+tpfa_trans_update(struct UnstructuredGrid *G     ,
+                  const double            *htrans,
+                  int                      ncells,
+                  const int               *cells ,
+                  double                  *trans )
+/* ---------------------------------------------------------------------- */
+{
+    int c, i, k;
 
-    for (f = 0; f < G->number_of_faces; f++) {
-        trans[f] = 1.0 / trans[f];
+    for (k = 0; k < ncells; k++) {
+        c = cells[k];
+
+        for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+            trans[G->cell_faces[i]] = face_trans(G, NULL, htrans,
+                                                 G->cell_faces[i]);
+        }
     }
 }
 
@@ -110,21 +217,10 @@ tpfa_eff_trans_compute(struct UnstructuredGrid       *G,
     return tpfa_eff_trans_compute<UnstructuredGrid>(G, totmob, htrans, trans);
     #endif
     
-    int c, i, f;
-
-    for (f = 0; f < G->number_of_faces; f++) {
-        trans[f] = 0.0;
-    }
-
-    for (c = i = 0; c < G->number_of_cells; c++) {
-        for (; i < G->cell_facepos[c + 1]; i++) {
-            f = G->cell_faces[i];
-
-            trans[f] += 1.0 / (totmob[c] * htrans[i]);
-        }
-    }
+    int f;
 
+#pragma omp parallel for schedule(static)
     for (f = 0; f < G->number_of_faces; f++) {
-        trans[f] = 1.0 / trans[f];
+        trans[f] = face_trans(G, totmob, htrans, f);
     }
 }
@@ -54,6 +54,25 @@ tpfa_htrans_compute(struct UnstructuredGrid *G     ,
                     const double            *perm  ,
                     double                  *htrans);
 
+/**
+ * Recompute static, one-sided transmissibilities for a subset of the grid
+ * cells, for instance following a change in their permeability.  Only the
+ * half-faces of the given cells are written.
+ *
+ * @param[in]     G       Grid.
+ * @param[in]     perm    Permeability, as in tpfa_htrans_compute().
+ * @param[in]     ncells  Number of cells in subset.
+ * @param[in]     cells   Distinct cell indices of subset.
+ * @param[in,out] htrans  One-sided transmissibilities, as computed by
+ *                        tpfa_htrans_compute().
+ */
+void
+tpfa_htrans_update(struct UnstructuredGrid *G     ,
+                   const double            *perm  ,
+                   int                      ncells,
+                   const int               *cells ,
+                   double                  *htrans);
+
 /**
  * Compute two-point transmissibilities from one-sided transmissibilities.
  *
@@ -77,6 +96,26 @@ tpfa_trans_compute(struct UnstructuredGrid *G     ,
                    const double            *htrans,
                    double                  *trans );
 
+/**
+ * Recompute two-point transmissibilities of all faces of a subset of the
+ * grid cells, for instance following tpfa_htrans_update() on the same
+ * subset.  Cost is proportional to the number of half-faces of the subset.
+ *
+ * @param[in]     G       Grid.
+ * @param[in]     htrans  One-sided transmissibilities as defined by function
+ *                        tpfa_htrans_compute().
+ * @param[in]     ncells  Number of cells in subset.
+ * @param[in]     cells   Cell indices of subset.
+ * @param[in,out] trans   Interface, two-point transmissibilities, as computed
+ *                        by tpfa_trans_compute().
+ */
+void
+tpfa_trans_update(struct UnstructuredGrid *G     ,
+                  const double            *htrans,
+                  int                      ncells,
+                  const int               *cells ,
+                  double                  *trans );
+
 /**
  * Calculate effective two-point transmissibilities from one-sided, total
  * mobility weighted, transmissibilities.
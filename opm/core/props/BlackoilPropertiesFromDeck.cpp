@@ -21,9 +21,11 @@
 #include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
 #include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
 #include <opm/core/props/phaseUsageFromDeck.hpp>
+#include <opm/core/props/ParallelBatch.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/utility/compressedToCartesian.hpp>
 #include <opm/core/utility/extractPvtTableIndex.hpp>
+#include <algorithm>
 #include <vector>
 #include <numeric>
 
@@ -246,22 +248,24 @@ namespace Opm
 
         typedef Opm::DenseAd::Evaluation<double, /*size=*/1> Eval;
 
-        Eval pEval = 0.0;
-        Eval TEval = 0.0;
-        Eval RsEval = 0.0;
-        Eval RvEval = 0.0;
-        Eval muEval = 0.0;
-
-        pEval.setDerivative(0, 1.0);
-
-        R_.resize(n*np);
-        this->compute_R_(n, p, T, z, cells, &R_[0]);
-
+        // Every cell is evaluated independently with its own local
+        // data, so the loop may be run concurrently.
+#pragma omp parallel for schedule(static) if(n >= min_parallel_batch)
         for (int i = 0; i < n; ++ i) {
             int cellIdx = cells[i];
             int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
-            pEval.setValue(p[i]);
-            TEval.setValue(T[i]);
+
+            Eval pEval = p[i];
+            Eval TEval = T[i];
+            Eval RsEval = 0.0;
+            Eval RvEval = 0.0;
+            Eval muEval = 0.0;
+            pEval.setDerivative(0, 1.0);
+
+            // z may be null, e.g. from the compressible reorder solver.
+            const double* zi = z ? z + i*np : 0;
+            double R[BlackoilPhases::MaxNumPhases];
+            this->compute_R_(1, p + i, T + i, zi, cells + i, R);
 
             if (pu.phase_used[BlackoilPhases::Aqua]) {
                 muEval = waterPvt_.viscosity(pvtRegionIdx, TEval, pEval);
@@ -271,7 +275,7 @@ namespace Opm
             }
 
             if (pu.phase_used[BlackoilPhases::Liquid]) {
-                RsEval.setValue(R_[i*np + pu.phase_pos[BlackoilPhases::Liquid]]);
+                RsEval.setValue(R[pu.phase_pos[BlackoilPhases::Liquid]]);
                 muEval = oilPvt_.viscosity(pvtRegionIdx, TEval, pEval, RsEval);
                 int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Liquid];
                 mu[offset] = muEval.value();
@@ -279,7 +283,7 @@ namespace Opm
             }
 
             if (pu.phase_used[BlackoilPhases::Vapour]) {
-                RvEval.setValue(R_[i*np + pu.phase_pos[BlackoilPhases::Vapour]]);
+                RvEval.setValue(R[pu.phase_pos[BlackoilPhases::Vapour]]);
                 muEval = gasPvt_.viscosity(pvtRegionIdx, TEval, pEval, RvEval);
                 int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Vapour];
                 mu[offset] = muEval.value();
@@ -308,79 +312,73 @@ namespace Opm
                                             double* dAdp) const
     {
         const int np = numPhases();
-
-        B_.resize(n*np);
-        R_.resize(n*np);
-        if (dAdp) {
-            dB_.resize(n*np);
-            dR_.resize(n*np);
-
-            this->compute_dBdp_(n, p, T, z, cells, &B_[0], &dB_[0]);
-            this->compute_dRdp_(n, p, T, z, cells, &R_[0], &dR_[0]);
-        } else {
-            this->compute_B_(n, p, T, z, cells, &B_[0]);
-            this->compute_R_(n, p, T, z, cells, &R_[0]);
-        }
         const auto& pu = phaseUsage();
         bool oil_and_gas = pu.phase_used[BlackoilPhases::Liquid] &&
             pu.phase_used[BlackoilPhases::Vapour];
         const int o = pu.phase_pos[BlackoilPhases::Liquid];
         const int g = pu.phase_pos[BlackoilPhases::Vapour];
 
-        // Compute A matrix
-// #pragma omp parallel for
+        // B and R are only needed for one cell at a time, so they live
+        // on the stack and the loop may be run concurrently.
+#pragma omp parallel for schedule(static) if(n >= min_parallel_batch)
         for (int i = 0; i < n; ++i) {
+            double B[BlackoilPhases::MaxNumPhases];
+            double R[BlackoilPhases::MaxNumPhases];
+            double dB[BlackoilPhases::MaxNumPhases];
+            double dR[BlackoilPhases::MaxNumPhases];
+            const double* zi = z ? z + i*np : 0;
+            if (dAdp) {
+                this->compute_dBdp_(1, p + i, T + i, zi, cells + i, B, dB);
+                this->compute_dRdp_(1, p + i, T + i, zi, cells + i, R, dR);
+            } else {
+                this->compute_B_(1, p + i, T + i, zi, cells + i, B);
+                this->compute_R_(1, p + i, T + i, zi, cells + i, R);
+            }
+
+            // Compute A matrix
             double* m = A + i*np*np;
             std::fill(m, m + np*np, 0.0);
             // Diagonal entries.
             for (int phase = 0; phase < np; ++phase) {
-                m[phase + phase*np] = 1.0/B_[i*np + phase];
+                m[phase + phase*np] = 1.0/B[phase];
             }
             // Off-diagonal entries.
             if (oil_and_gas) {
-                m[o + g*np] = R_[i*np + g]/B_[i*np + g];
-                m[g + o*np] = R_[i*np + o]/B_[i*np + o];
+                m[o + g*np] = R[g]/B[g];
+                m[g + o*np] = R[o]/B[o];
             }
-        }
 
-        // Derivative of A matrix.
-        // A     = R*inv(B) whence
-        //
-        // dA/dp = (dR/dp*inv(B) + R*d(inv(B))/dp)
-        //       = (dR/dp*inv(B) - R*inv(B)*(dB/dp)*inv(B))
-        //       = (dR/dp - A*(dB/dp)) * inv(B)
-        //
-        // The B matrix is diagonal and that fact is exploited in the
-        // following implementation.
-        if (dAdp) {
-// #pragma omp parallel for
-            // (1): dA/dp <- A
-            std::copy(A, A + n*np*np, dAdp);
-
-            for (int i = 0; i < n; ++i) {
-                double*       m  = dAdp + i*np*np;
+            // Derivative of A matrix.
+            // A     = R*inv(B) whence
+            //
+            // dA/dp = (dR/dp*inv(B) + R*d(inv(B))/dp)
+            //       = (dR/dp*inv(B) - R*inv(B)*(dB/dp)*inv(B))
+            //       = (dR/dp - A*(dB/dp)) * inv(B)
+            //
+            // The B matrix is diagonal and that fact is exploited in the
+            // following implementation.
+            if (dAdp) {
+                // (1): dA/dp <- A
+                double* dm = dAdp + i*np*np;
+                std::copy(m, m + np*np, dm);
 
                 // (2): dA/dp <- -dA/dp*(dB/dp) == -A*(dB/dp)
-                const double* dB = & dB_[i * np];
                 for (int col = 0; col < np; ++col) {
                     for (int row = 0; row < np; ++row) {
-                        m[col*np + row] *= - dB[ col ]; // Note sign.
+                        dm[col*np + row] *= - dB[ col ]; // Note sign.
                     }
                 }
 
                 if (oil_and_gas) {
                     // (2b): dA/dp += dR/dp (== dR/dp - A*(dB/dp))
-                    const double* dR = & dR_[i * np];
-
-                    m[o*np + g] += dR[ o ];
-                    m[g*np + o] += dR[ g ];
+                    dm[o*np + g] += dR[ o ];
+                    dm[g*np + o] += dR[ g ];
                 }
 
                 // (3): dA/dp *= inv(B) (== final result)
-                const double* B = & B_[i * np];
                 for (int col = 0; col < np; ++col) {
                     for (int row = 0; row < np; ++row) {
-                        m[col*np + row] /= B[ col ];
+                        dm[col*np + row] /= B[ col ];
                     }
                 }
             }
@@ -668,7 +666,7 @@ namespace Opm
                                              double* rho) const
     {
         const int np = numPhases();
-// #pragma omp parallel for
+#pragma omp parallel for schedule(static) if(n >= min_parallel_batch)
         for (int i = 0; i < n; ++i) {
             int cellIdx = cells?cells[i]:i;
             const double *sdens = surfaceDensity(cellIdx);
@@ -40,6 +40,9 @@ namespace Opm
 
     /// Concrete class implementing the blackoil property interface,
     /// reading all data and properties from eclipse deck input.
+    ///
+    /// The const evaluation methods keep no scratch state in the
+    /// object and may be called concurrently from several threads.
     class BlackoilPropertiesFromDeck : public BlackoilPropertiesInterface
     {
     public:
@@ -316,10 +319,6 @@ namespace Opm
         std::shared_ptr<MaterialLawManager> materialLawManager_;
         std::shared_ptr<SaturationPropsInterface> satprops_;
         std::vector<double> surfaceDensities_;
-        mutable std::vector<double> B_;
-        mutable std::vector<double> dB_;
-        mutable std::vector<double> R_;
-        mutable std::vector<double> dR_;
     };
 
 
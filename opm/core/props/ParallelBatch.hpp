@@ -0,0 +1,34 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PARALLELBATCH_HEADER_INCLUDED
+#define OPM_PARALLELBATCH_HEADER_INCLUDED
+
+namespace Opm
+{
+
+    /// Smallest number of data points for which the property classes
+    /// evaluate a batch with OpenMP threads. The reordering transport
+    /// solvers ask for one cell at a time, and for such small batches
+    /// opening a parallel region costs more than the work itself.
+    const int min_parallel_batch = 256;
+
+} // namespace Opm
+
+#endif // OPM_PARALLELBATCH_HEADER_INCLUDED
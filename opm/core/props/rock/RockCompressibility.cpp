@@ -129,10 +129,8 @@ namespace Opm
         if (p_.empty()) {
             return rock_comp_;
         } else {
-            //const double poromult = Opm::linearInterpolation(p_, poromult_, pressure);
-            //const double dporomultdp = Opm::linearInterpolationDerivative(p_, poromult_, pressure);
-            const double poromult = Opm::linearInterpolation(p_, poromult_, pressure);
-            const double dporomultdp = Opm::linearInterpolationDerivative(p_, poromult_, pressure);
+            double dporomultdp = 0.0;
+            const double poromult = Opm::linearInterpolationAndDerivative(p_, poromult_, pressure, dporomultdp);
 
             return dporomultdp/poromult;
         }
@@ -19,6 +19,7 @@
 #include "config.h"
 
 #include <opm/core/props/satfunc/SaturationPropsFromDeck.hpp>
+#include <opm/core/props/ParallelBatch.hpp>
 
 #include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
 
@@ -28,14 +29,145 @@
 #include <opm/core/simulator/ExplicitArraysFluidState.hpp>
 #include <opm/core/simulator/ExplicitArraysSatDerivativesFluidState.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <numeric>
+#include <vector>
 
 namespace Opm
 {
 
     typedef SaturationPropsFromDeck::MaterialLawManager::MaterialLaw MaterialLaw;
 
+    namespace
+    {
+        typedef SaturationPropsFromDeck::MaterialLawManager MaterialLawManager;
+
+        inline double valueOf(const double x) { return x; }
+        inline double derivativeOf(const double, const int) { return 0.0; }
+
+        template <class Evaluation>
+        double valueOf(const Evaluation& x) { return x.value(); }
+        template <class Evaluation>
+        double derivativeOf(const Evaluation& x, const int phaseIdx) { return x.derivative(phaseIdx); }
+
+
+        // Order the points of a batch by saturation region (SATNUM),
+        // so that consecutive evaluations, and each thread's chunk of
+        // them, use the same region's tables. The counting sort keeps
+        // the given order within a region. Small batches and batches
+        // within a single region are evaluated as given, signalled by
+        // an empty order.
+        void groupByRegion(const MaterialLawManager& materialLawManager,
+                           const int n,
+                           const int* cells,
+                           std::vector<int>& order)
+        {
+            order.clear();
+            if (n < min_parallel_batch) {
+                return;
+            }
+            std::vector<int> region(n);
+            std::vector<int> start(1, 0);
+            for (int i = 0; i < n; ++i) {
+                region[i] = materialLawManager.satnumRegionIdx(cells[i]);
+                if (region[i] + 2 > int(start.size())) {
+                    start.resize(region[i] + 2, 0);
+                }
+                ++start[region[i] + 1];
+            }
+            if (std::count(start.begin(), start.end(), n) == 1) {
+                return;
+            }
+            std::partial_sum(start.begin(), start.end(), start.begin());
+            order.resize(n);
+            for (int i = 0; i < n; ++i) {
+                order[start[region[i]]++] = i;
+            }
+        }
+
+
+        // Relative permeabilities of a batch, region by region. With
+        // the derivative fluid state each evaluation yields values and
+        // saturation derivatives together.
+        template <class FluidState>
+        void relpermBatch(const MaterialLawManager& materialLawManager,
+                          FluidState fluidState,
+                          const int np,
+                          const int n,
+                          const int* cells,
+                          const std::vector<int>& order,
+                          double* kr,
+                          double* dkrds)
+        {
+            typedef typename FluidState::Scalar Evaluation;
+            Evaluation relativePerms[BlackoilPhases::MaxNumPhases];
+#pragma omp parallel for schedule(static) firstprivate(fluidState) private(relativePerms) \
+    if(n >= min_parallel_batch)
+            for (int k = 0; k < n; ++k) {
+                const int i = order.empty() ? k : order[k];
+                fluidState.setIndex(i);
+                const auto& params = materialLawManager.materialLawParams(cells[i]);
+                MaterialLaw::relativePermeabilities(relativePerms, params, fluidState);
+
+                // copy the values calculated using opm-material to the target arrays
+                for (int krPhaseIdx = 0; krPhaseIdx < np; ++krPhaseIdx) {
+                    kr[np*i + krPhaseIdx] = valueOf(relativePerms[krPhaseIdx]);
+                    if (dkrds) {
+                        for (int satPhaseIdx = 0; satPhaseIdx < np; ++satPhaseIdx)
+                            dkrds[np*np*i + satPhaseIdx*np + krPhaseIdx] = derivativeOf(relativePerms[krPhaseIdx], satPhaseIdx);
+                    }
+                }
+            }
+        }
+
+
+        // Capillary pressures of a batch, region by region, see
+        // relpermBatch(). The active phases are given in canonical
+        // order with their output position and the sign that shifts
+        // the reference phase to oil.
+        template <class FluidState>
+        void capPressBatch(const MaterialLawManager& materialLawManager,
+                           FluidState fluidState,
+                           const int np,
+                           const int numActive,
+                           const int* canonicalIdx,
+                           const int* pos,
+                           const double* sign,
+                           const int n,
+                           const int* cells,
+                           const std::vector<int>& order,
+                           double* pc,
+                           double* dpcds)
+        {
+            typedef typename FluidState::Scalar Evaluation;
+            Evaluation capillaryPressures[BlackoilPhases::MaxNumPhases];
+#pragma omp parallel for schedule(static) firstprivate(fluidState) private(capillaryPressures) \
+    if(n >= min_parallel_batch)
+            for (int k = 0; k < n; ++k) {
+                const int i = order.empty() ? k : order[k];
+                fluidState.setIndex(i);
+                const auto& params = materialLawManager.materialLawParams(cells[i]);
+                MaterialLaw::capillaryPressures(capillaryPressures, params, fluidState);
+
+                // copy the values calculated using opm-material to the target arrays
+                const Evaluation& pcOil = capillaryPressures[BlackoilPhases::Liquid];
+                for (int phase = 0; phase < numActive; ++phase) {
+                    const Evaluation& pcPhase = capillaryPressures[canonicalIdx[phase]];
+                    pc[np*i + pos[phase]] = valueOf(pcOil) + sign[phase] * valueOf(pcPhase);
+                    if (dpcds) {
+                        for (int satPhase = 0; satPhase < numActive; ++satPhase) {
+                            dpcds[np*np*i + pos[satPhase]*np + pos[phase]] =
+                                derivativeOf(pcOil, canonicalIdx[satPhase])
+                                + sign[phase] * derivativeOf(pcPhase, canonicalIdx[satPhase]);
+                        }
+                    }
+                }
+            }
+        }
+    } // anonymous namespace
+
     // ----------- Methods of SaturationPropsFromDeck ---------
 
 
@@ -80,40 +212,17 @@ namespace Opm
         assert(cells != 0);
 
         const int np = numPhases();
+        std::vector<int> order;
+        groupByRegion(*materialLawManager_, n, cells, order);
+
         if (dkrds) {
             ExplicitArraysSatDerivativesFluidState fluidState(phaseUsage_);
             fluidState.setSaturationArray(s);
-
-            typedef ExplicitArraysSatDerivativesFluidState::Evaluation Evaluation;
-            Evaluation relativePerms[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::relativePermeabilities(relativePerms, params, fluidState);
-
-                // copy the values calculated using opm-material to the target arrays
-                for (int krPhaseIdx = 0; krPhaseIdx < np; ++krPhaseIdx) {
-                    kr[np*i + krPhaseIdx] = relativePerms[krPhaseIdx].value();
-
-                    for (int satPhaseIdx = 0; satPhaseIdx < np; ++satPhaseIdx)
-                        dkrds[np*np*i + satPhaseIdx*np + krPhaseIdx] = relativePerms[krPhaseIdx].derivative(satPhaseIdx);
-                }
-            }
+            relpermBatch(*materialLawManager_, fluidState, np, n, cells, order, kr, dkrds);
         } else {
             ExplicitArraysFluidState fluidState(phaseUsage_);
             fluidState.setSaturationArray(s);
-
-            double relativePerms[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::relativePermeabilities(relativePerms, params, fluidState);
-
-                // copy the values calculated using opm-material to the target arrays
-                for (int krPhaseIdx = 0; krPhaseIdx < np; ++krPhaseIdx) {
-                    kr[np*i + krPhaseIdx] = relativePerms[krPhaseIdx];
-                }
-            }
+            relpermBatch(*materialLawManager_, fluidState, np, n, cells, order, kr, dkrds);
         }
     }
 
@@ -141,65 +250,37 @@ namespace Opm
 
         const int np = numPhases();
 
+        // Active phases in canonical order with their output position
+        // and the sign that shifts the reference phase to oil: in
+        // opm-material the wetting phase is the reference phase for
+        // two-phase problems, i.e. water for an oil-water system, but
+        // for flow it is always oil.
+        int numActive = 0;
+        int canonicalIdx[BlackoilPhases::MaxNumPhases];
+        int pos[BlackoilPhases::MaxNumPhases];
+        double sign[BlackoilPhases::MaxNumPhases];
+        for (int canonicalPhaseIdx = 0; canonicalPhaseIdx < BlackoilPhases::MaxNumPhases; ++canonicalPhaseIdx) {
+            if (phaseUsage_.phase_used[canonicalPhaseIdx]) {
+                canonicalIdx[numActive] = canonicalPhaseIdx;
+                pos[numActive] = phaseUsage_.phase_pos[canonicalPhaseIdx];
+                sign[numActive] = (canonicalPhaseIdx == BlackoilPhases::Aqua)? -1.0 : 1.0;
+                ++numActive;
+            }
+        }
+
+        std::vector<int> order;
+        groupByRegion(*materialLawManager_, n, cells, order);
+
         if (dpcds) {
             ExplicitArraysSatDerivativesFluidState fluidState(phaseUsage_);
-            typedef ExplicitArraysSatDerivativesFluidState::Evaluation Evaluation;
             fluidState.setSaturationArray(s);
-
-            Evaluation capillaryPressures[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::capillaryPressures(capillaryPressures, params, fluidState);
-
-                // copy the values calculated using opm-material to the target arrays
-                for (int canonicalPhaseIdx = 0; canonicalPhaseIdx < BlackoilPhases::MaxNumPhases; ++canonicalPhaseIdx) {
-                    // skip unused phases
-                    if ( ! phaseUsage_.phase_used[canonicalPhaseIdx]) {
-                        continue;
-                    }
-                    const int pcPhaseIdx = phaseUsage_.phase_pos[canonicalPhaseIdx];
-
-                    const double sign = (canonicalPhaseIdx == BlackoilPhases::Aqua)? -1.0 : 1.0;
-                    // in opm-material the wetting phase is the reference phase
-                    // for two-phase problems i.e water for oil-water system,
-                    // but for flow it is always oil. Add oil (liquid) capillary pressure value
-                    // to shift the reference phase to oil
-                    pc[np*i + pcPhaseIdx] = capillaryPressures[BlackoilPhases::Liquid].value() + sign * capillaryPressures[canonicalPhaseIdx].value();
-                    for (int canonicalSatPhaseIdx = 0; canonicalSatPhaseIdx < BlackoilPhases::MaxNumPhases; ++canonicalSatPhaseIdx) {
-                        if ( ! phaseUsage_.phase_used[canonicalSatPhaseIdx])
-                            continue;
-
-                        const int satPhaseIdx = phaseUsage_.phase_pos[canonicalSatPhaseIdx];
-                        dpcds[np*np*i + satPhaseIdx*np + pcPhaseIdx] = capillaryPressures[BlackoilPhases::Liquid].derivative(canonicalSatPhaseIdx) + sign * capillaryPressures[canonicalPhaseIdx].derivative(canonicalSatPhaseIdx);
-                    }
-                }
-            }
+            capPressBatch(*materialLawManager_, fluidState, np, numActive, canonicalIdx, pos, sign,
+                          n, cells, order, pc, dpcds);
         } else {
             ExplicitArraysFluidState fluidState(phaseUsage_);
             fluidState.setSaturationArray(s);
-
-            double capillaryPressures[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {         
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::capillaryPressures(capillaryPressures, params, fluidState);
-
-                // copy the values calculated using opm-material to the target arrays
-                for (int canonicalPhaseIdx = 0; canonicalPhaseIdx < BlackoilPhases::MaxNumPhases; ++canonicalPhaseIdx) {
-                    // skip unused phases
-                    if ( ! phaseUsage_.phase_used[canonicalPhaseIdx])
-                        continue;
-
-                    const int pcPhaseIdx = phaseUsage_.phase_pos[canonicalPhaseIdx];
-                    double sign = (canonicalPhaseIdx == BlackoilPhases::Aqua)? -1.0 : 1.0;
-                    // in opm-material the wetting phase is the reference phase
-                    // for two-phase problems i.e water for oil-water system,
-                    // but for flow it is always oil. Add oil (liquid) capillary pressure value
-                    // to shift the reference phase to oil
-                    pc[np*i + pcPhaseIdx] = capillaryPressures[BlackoilPhases::Liquid] + sign * capillaryPressures[canonicalPhaseIdx];
-                }
-            }
+            capPressBatch(*materialLawManager_, fluidState, np, numActive, canonicalIdx, pos, sign,
+                          n, cells, order, pc, dpcds);
         }
     }
 
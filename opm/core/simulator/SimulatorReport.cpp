@@ -55,6 +55,7 @@ namespace Opm
         total_linearizations += sr.total_linearizations;
         total_newton_iterations += sr.total_newton_iterations;
         total_linear_iterations += sr.total_linear_iterations;
+        profile.merge(sr.profile);
     }
 
     void SimulatorReport::report(std::ostream& os)
@@ -103,5 +104,24 @@ namespace Opm
         }
     }
 
+    void SimulatorReport::collectProfile()
+    {
+        Profiler& profiler = Profiler::instance();
+        profile.merge(profiler.snapshot());
+        profiler.reset();
+    }
+
+    void SimulatorReport::reportProfile(std::ostream& os)
+    {
+        if ( verbose_ && !profile.children.empty() )
+        {
+            profile.print(os);
+        }
+    }
+
+    void SimulatorReport::reportProfileJson(std::ostream& os)
+    {
+        profile.writeJson(os);
+    }
 
 } // namespace Opm
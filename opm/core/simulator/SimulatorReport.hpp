@@ -20,6 +20,7 @@
 #ifndef OPM_SIMULATORREPORT_HEADER_INCLUDED
 #define OPM_SIMULATORREPORT_HEADER_INCLUDED
 
+#include <opm/core/utility/Profiler.hpp>
 #include <iosfwd>
 
 namespace Opm
@@ -44,6 +45,9 @@ namespace Opm
 
         bool converged;
 
+        /// Profiler scopes recorded by collectProfile().
+        ProfileNode profile;
+
         /// Default constructor initializing all times to 0.0.
         SimulatorReport(bool verbose=true);
         /// Copy constructor
@@ -55,6 +59,13 @@ namespace Opm
         /// Print a report, leaving out the transport time.
         void reportFullyImplicit(std::ostream& os);
         void reportParam(std::ostream& os);
+        /// Move the statistics recorded by Profiler::instance() into
+        /// this report, and reset the profiler.
+        void collectProfile();
+        /// Print the collected profile as a tree.
+        void reportProfile(std::ostream& os);
+        /// Write the collected profile as JSON.
+        void reportProfileJson(std::ostream& os);
     private:
         // Whether to print statistics to std::cout
         bool verbose_;
@@ -44,10 +44,26 @@ namespace Opm
     namespace ImplicitTransportLinAlgSupport
     {
 
+        /// Direct solver for the Newton systems of the implicit
+        /// transport solver.  The symbolic factorization is shared by
+        /// all systems with the same sparsity pattern.
         class CSRMatrixUmfpackSolver
         {
         public:
+#if HAVE_SUITESPARSE_UMFPACK_H
+            CSRMatrixUmfpackSolver()
+                : handle_(call_UMFPACK_handle_create())
+            {
+                if (!handle_) {
+                    OPM_THROW(std::runtime_error, "Failed to construct UMFPACK solver handle.");
+                }
+            }
 
+            ~CSRMatrixUmfpackSolver()
+            {
+                call_UMFPACK_handle_destroy(handle_);
+            }
+#endif
 
             template <class Vector>
             void
@@ -56,7 +72,7 @@ namespace Opm
                   Vector                  x)
             {
 #if HAVE_SUITESPARSE_UMFPACK_H
-                call_UMFPACK(const_cast<CSRMatrix*>(A), b, x);
+                checkStatus(call_UMFPACK_handle_solve(handle_, const_cast<CSRMatrix*>(A), b, x));
 #else
     OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
           "Reconfigure opm-core with SuiteSparse/UMFPACK support and recompile.");
@@ -71,14 +87,28 @@ namespace Opm
                   Vector&                 x)
             {
 #if HAVE_SUITESPARSE_UMFPACK_H
-                call_UMFPACK(const_cast<CSRMatrix*>(&A), &b[0], &x[0]);
+                checkStatus(call_UMFPACK_handle_solve(handle_, const_cast<CSRMatrix*>(&A), &b[0], &x[0]));
 #else
     OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
           "Reconfigure opm-core with SuiteSparse/UMFPACK support and recompile.");
 #endif
             }
 
+#if HAVE_SUITESPARSE_UMFPACK_H
+        private:
+            // No copying: the factorization handle is owned.
+            CSRMatrixUmfpackSolver(const CSRMatrixUmfpackSolver&);
+            CSRMatrixUmfpackSolver& operator=(const CSRMatrixUmfpackSolver&);
 
+            static void checkStatus(const int status)
+            {
+                if (status < 0) {
+                    OPM_THROW(std::runtime_error, "UMFPACK failed with status " << status);
+                }
+            }
+
+            UMFPACKHandle* handle_;
+#endif
         }; // class CSRMatrixUmfpackSolver
 
     } // namespace ImplicitTransportLinAlgSupport
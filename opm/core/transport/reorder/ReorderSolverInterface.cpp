@@ -21,46 +21,170 @@
 #include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
 #include <opm/core/transport/reorder/reordersequence.h>
 #include <opm/core/grid.h>
-#include <opm/core/utility/StopWatch.hpp>
+#include <opm/core/utility/Profiler.hpp>
+#include <opm/common/ErrorMacros.hpp>
 
 #include <vector>
 #include <cassert>
-#include <iostream>
+#include <exception>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+Opm::ReorderSolverInterface::ReorderSolverInterface()
+    : ordering_valid_(false),
+      ordering_grid_(0),
+      ordering_flux_(0),
+      use_multithreading_(false)
+{
+}
+
+
+void Opm::ReorderSolverInterface::setMultithreading(const bool use_multithreading)
+{
+    use_multithreading_ = use_multithreading;
+}
+
+
+bool Opm::ReorderSolverInterface::multithreading() const
+{
+    return use_multithreading_;
+}
+
+
+void Opm::ReorderSolverInterface::invalidateOrdering()
+{
+    ordering_valid_ = false;
+    levels_.clear();
+}
 
 
 void Opm::ReorderSolverInterface::reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux)
+{
+    ProfileScope scope("reorder_transport");
+    if (!ordering_valid_ || ordering_grid_ != &grid || ordering_flux_ != darcyflux) {
+        computeOrdering(grid, darcyflux);
+    }
+    const int ncomponents = components_.size() - 1;
+
+    if (!use_multithreading_) {
+        // Invoke appropriate solve method for each interdependent component.
+        for (int comp = 0; comp < ncomponents; ++comp) {
+            solveComponent(comp);
+        }
+        return;
+    }
+
+    if (levels_.empty()) {
+        computeLevels(grid, darcyflux);
+    }
+    const int nlevels = levels_.size() - 1;
+
+    // Solve all components of a level concurrently. Exceptions cannot
+    // propagate out of a parallel region, so the first one is kept
+    // and rethrown after the level is done.
+    std::exception_ptr error;
+    for (int level = 0; level < nlevels; ++level) {
+        const int level_begin = levels_[level];
+        const int level_end = levels_[level + 1];
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int i = level_begin; i < level_end; ++i) {
+            try {
+                solveComponent(level_components_[i]);
+            } catch (...) {
+#pragma omp critical(reorder_solver_error)
+                {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+
+void Opm::ReorderSolverInterface::computeOrdering(const UnstructuredGrid& grid, const double* darcyflux)
+{
+    computeOrderingAndGraphs(grid, darcyflux, 0, 0, 0, 0);
+}
+
+
+void Opm::ReorderSolverInterface::computeOrderingAndGraphs(const UnstructuredGrid& grid,
+                                                           const double* darcyflux,
+                                                           int* ia_upw, int* ja_upw,
+                                                           int* ia_downw, int* ja_downw)
 {
     // Compute reordered sequence of single-cell problems
     sequence_.resize(grid.number_of_cells);
     components_.resize(grid.number_of_cells + 1);
+    work_.resize(compute_sequence_worksize(&grid));
+    if (ia_upw == 0 || ja_upw == 0) {
+        // Caller does not want the upwind graph, but Tarjan needs it.
+        ia_.resize(grid.number_of_cells + 1);
+        ja_.resize(grid.number_of_faces);
+        ia_upw = &ia_[0];
+        ja_upw = &ja_[0];
+    }
     int ncomponents;
-    time::StopWatch clock;
-    clock.start();
-    compute_sequence(&grid, darcyflux, &sequence_[0], &components_[0], &ncomponents);
-    clock.stop();
-    std::cout << "Topological sort took: " << clock.secsSinceStart() << " seconds." << std::endl;
+    {
+        ProfileScope scope("topological_sort");
+        compute_sequence_graphs(&grid, darcyflux, &sequence_[0], &components_[0], &ncomponents,
+                                ia_upw, ja_upw, ia_downw, ja_downw, &work_[0]);
+    }
 
     // Make vector's size match actual used data.
     components_.resize(ncomponents + 1);
 
-    // Invoke appropriate solve method for each interdependent component.
-    for (int comp = 0; comp < ncomponents; ++comp) {
+    ordering_valid_ = true;
+    ordering_grid_ = &grid;
+    ordering_flux_ = darcyflux;
+    levels_.clear();
+}
+
+
+void Opm::ReorderSolverInterface::computeLevels(const UnstructuredGrid& grid, const double* darcyflux)
+{
+    // Group components in levels of mutually independent components.
+    const int ncomponents = components_.size() - 1;
+    if (ncomponents == 0) {
+        level_components_.clear();
+        levels_.assign(1, 0);
+        return;
+    }
+    level_components_.resize(ncomponents);
+    levels_.resize(ncomponents + 1);
+    int nlevels;
+    compute_component_levels(&grid, darcyflux, &sequence_[0], &components_[0], ncomponents,
+                             &level_components_[0], &levels_[0], &nlevels);
+    levels_.resize(nlevels + 1);
+}
+
+
+void Opm::ReorderSolverInterface::solveComponent(const int comp)
+{
 #if 0
 #ifdef MATLAB_MEX_FILE
-	// \TODO replace this with general signal handling code, check if it costs performance.
-        if (interrupt_signal) {
-            mexPrintf("Reorder loop interrupted by user: %d of %d "
-                      "cells finished.\n", i, grid.number_of_cells);
-            break;
-        }
+    // \TODO replace this with general signal handling code, check if it costs performance.
+    if (interrupt_signal) {
+        mexPrintf("Reorder loop interrupted by user: %d of %d "
+                  "cells finished.\n", i, grid.number_of_cells);
+        break;
+    }
 #endif
 #endif
-	const int comp_size = components_[comp + 1] - components_[comp];
-	if (comp_size == 1) {
-	    solveSingleCell(sequence_[components_[comp]]);
-	} else {
-	    solveMultiCell(comp_size, &sequence_[components_[comp]]);
-	}
+    const int comp_size = components_[comp + 1] - components_[comp];
+    if (comp_size == 1) {
+        solveSingleCell(sequence_[components_[comp]]);
+    } else {
+        ProfileScope scope("multi_cell_solve");
+        solveMultiCell(comp_size, &sequence_[components_[comp]]);
     }
 }
 
@@ -75,3 +199,29 @@ const std::vector<int>& Opm::ReorderSolverInterface::components() const
 {
     return components_;
 }
+
+
+const std::vector<int>& Opm::ReorderSolverInterface::levels() const
+{
+    return levels_;
+}
+
+
+const std::vector<int>& Opm::ReorderSolverInterface::levelComponents() const
+{
+    return level_components_;
+}
+
+
+int Opm::ReorderSolverInterface::threadWorkspaceIndex(const int num_workspaces)
+{
+#ifdef _OPENMP
+    const int thread = omp_get_thread_num();
+#else
+    const int thread = 0;
+#endif
+    if (thread >= num_workspaces) {
+        OPM_THROW(std::logic_error, "No workspace for thread " << thread);
+    }
+    return thread;
+}
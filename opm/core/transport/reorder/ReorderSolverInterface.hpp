@@ -35,20 +35,76 @@ namespace Opm
     /// class.) The reorderAndTransport() method is provided as an aid
     /// to implementing solve() in subclasses, together with the
     /// sequence() and components() methods for accessing the ordering.
+    ///
+    /// By default the components are solved one at a time in causal
+    /// order. If multithreading is enabled, the components are
+    /// grouped in levels of mutually independent components, and all
+    /// components of a level are solved concurrently. A subclass
+    /// that allows this must ensure that solveSingleCell() and
+    /// solveMultiCell() only write data belonging to the cells they
+    /// are given.
+    ///
+    /// The ordering is cached, and reorderAndTransport() reuses it
+    /// when called again with the same grid and flux array. A subclass
+    /// must call invalidateOrdering() whenever the flux values may
+    /// have changed since the previous call.
     class ReorderSolverInterface
     {
     public:
+    ReorderSolverInterface();
     virtual ~ReorderSolverInterface() {}
+        /// Enable or disable concurrent solution of independent
+        /// components. Has no effect unless compiled with OpenMP.
+        void setMultithreading(const bool use_multithreading);
+        /// Is concurrent solution of independent components enabled?
+        bool multithreading() const;
+        /// Discard the cached ordering, so that it is recomputed by
+        /// the next call to reorderAndTransport().
+        void invalidateOrdering();
     private:
 	virtual void solveSingleCell(const int cell) = 0;
 	virtual void solveMultiCell(const int num_cells, const int* cells) = 0;
     protected:
 	void reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux);
+        /// Compute the ordering for the given grid and flux, as
+        /// reorderAndTransport() would, and also output the upwind
+        /// and downwind graphs (see compute_sequence_graphs()). The
+        /// ordering is cached, so a following reorderAndTransport()
+        /// with the same grid and flux does not recompute it.
+        void computeOrderingAndGraphs(const UnstructuredGrid& grid, const double* darcyflux,
+                                      int* ia_upw, int* ja_upw,
+                                      int* ia_downw, int* ja_downw);
         const std::vector<int>& sequence() const;
         const std::vector<int>& components() const;
+        /// Components grouped in levels of mutually independent
+        /// components: level l consists of the components
+        /// levelComponents()[levels()[l] .. levels()[l+1]-1].
+        /// Empty unless reorderAndTransport() ran multithreaded.
+        const std::vector<int>& levels() const;
+        const std::vector<int>& levelComponents() const;
+        /// Index of the calling thread into an array of
+        /// num_workspaces per-thread workspaces. Throws if the thread
+        /// has no entry.
+        static int threadWorkspaceIndex(const int num_workspaces);
     private:
+        void computeOrdering(const UnstructuredGrid& grid, const double* darcyflux);
+        void computeLevels(const UnstructuredGrid& grid, const double* darcyflux);
+        void solveComponent(const int comp);
+
         std::vector<int> sequence_;
         std::vector<int> components_;
+        // Persistent workspace for computing the ordering.
+        std::vector<int> work_;
+        std::vector<int> ia_;
+        std::vector<int> ja_;
+        // Key of the cached ordering.
+        bool ordering_valid_;
+        const UnstructuredGrid* ordering_grid_;
+        const double* ordering_flux_;
+        // For multithreaded execution.
+        bool use_multithreading_;
+        std::vector<int> level_components_;
+        std::vector<int> levels_;
     };
 
 
@@ -28,11 +28,18 @@
 #include <opm/core/utility/miscUtilitiesBlackoil.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
 #include <fstream>
 #include <iterator>
 #include <numeric>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace Opm
 {
@@ -40,6 +47,22 @@ namespace Opm
     // Choose error policy for scalar solves here.
     typedef RegulaFalsi<WarnAndContinueOnError> RootFinder;
 
+    namespace
+    {
+        // Order columns by decreasing length.
+        void orderColumnsByLength(const std::vector<std::vector<int> >& columns,
+                                  std::vector<int>& order)
+        {
+            order.resize(columns.size());
+            for (int i = 0; i < int(order.size()); ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&columns](const int a, const int b)
+                             { return columns[a].size() > columns[b].size(); });
+        }
+    } // anonymous namespace
+
 
     TransportSolverCompressibleTwophaseReorder::TransportSolverCompressibleTwophaseReorder(
                                                    const UnstructuredGrid& grid,
@@ -104,18 +127,13 @@ namespace Opm
             OPM_THROW(std::runtime_error, "TransportModelCompressibleTwophase requires a property object without miscibility.");
         }
 
-        std::vector<int> seq(grid_.number_of_cells);
-        std::vector<int> comp(grid_.number_of_cells + 1);
-        int ncomp;
-        compute_sequence_graph(&grid_, darcyflux_,
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_upw_[0], &ja_upw_[0]);
-        const int nf = grid_.number_of_faces;
-        std::vector<double> neg_darcyflux(nf);
-        std::transform(darcyflux, darcyflux + nf, neg_darcyflux.begin(), std::negate<double>());
-        compute_sequence_graph(&grid_, &neg_darcyflux[0],
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_downw_[0], &ja_downw_[0]);
+        // The ordering is computed along with the graphs, and reused
+        // by reorderAndTransport().
+        invalidateOrdering();
+        computeOrderingAndGraphs(grid_, darcyflux_,
+                                 &ia_upw_[0], &ja_upw_[0],
+                                 &ia_downw_[0], &ja_downw_[0]);
+        setupWorkspaces();
         reorderAndTransport(grid_, darcyflux);
         toBothSat(saturation_, saturation);
 
@@ -123,6 +141,30 @@ namespace Opm
         computeSurfacevol(grid_.number_of_cells, props_.numPhases(), &A_[0], &saturation[0], &surfacevol[0]);
     }
 
+
+    void TransportSolverCompressibleTwophaseReorder::setupWorkspaces()
+    {
+        int num_threads = 1;
+#ifdef _OPENMP
+        if (multithreading()) {
+            num_threads = omp_get_max_threads();
+        }
+#endif
+        multicell_workspaces_.resize(num_threads);
+        for (int t = 0; t < num_threads; ++t) {
+            // New entries are -1, and solveMultiCell() restores
+            // entries it uses to -1 when done.
+            multicell_workspaces_[t].pos.resize(grid_.number_of_cells, -1);
+        }
+    }
+
+
+    TransportSolverCompressibleTwophaseReorder::MultiCellWorkspace&
+    TransportSolverCompressibleTwophaseReorder::threadWorkspace()
+    {
+        return multicell_workspaces_[threadWorkspaceIndex(multicell_workspaces_.size())];
+    }
+
     // Residual function r(s) for a single-cell implicit Euler transport
     //
     // [[ incompressible was: r(s) = s - s0 + dt/pv*( influx + outflux*f(s) ) ]]
@@ -207,10 +249,12 @@ namespace Opm
         //             to guide further updating. Clear mark in cell when
         //             its solution gets updated.
         // Verdict: this is a good one! Approx. halved total time.
-        std::vector<int> needs_update(num_cells, 1);
+        MultiCellWorkspace& ws = threadWorkspace();
+        std::vector<int>& needs_update = ws.needs_update;
+        needs_update.assign(num_cells, 1);
         // This one also needs the mapping from all cells to
         // the strongly connected subset to filter out connections
-        std::vector<int> pos(grid_.number_of_cells, -1);
+        std::vector<int>& pos = ws.pos;
         for (int i = 0; i < num_cells; ++i) {
             const int cell = cells[i];
             pos[cell] = i;
@@ -220,7 +264,8 @@ namespace Opm
         const double tol = 1e-9;
         const int max_iters = 300;
         // Must store s0 before we start.
-        std::vector<double> s0(num_cells);
+        std::vector<double>& s0 = ws.s0;
+        s0.resize(num_cells);
         // Must set initial fractional flows before we start.
         // Also, we compute the # of upstream neighbours.
         // std::vector<int> num_upstream(num_cells);
@@ -295,14 +340,15 @@ namespace Opm
             //        << std::accumulate(needs_update.begin(), needs_update.end(), 0) << std::endl;
         } while (update_count > 0 && ++num_iters < max_iters);
 
+        for (int i = 0; i < num_cells; ++i) {
+            pos[cells[i]] = -1;
+        }
+
         // Done with iterations, check if we succeeded.
         if (update_count > 0) {
             OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
                   << num_iters << " iterations. Remaining update count = " << update_count);
         }
-        std::cout << "Solved " << num_cells << " cell multicell problem in "
-                  << num_iters << " iterations." << std::endl;
-
     }
 
     double TransportSolverCompressibleTwophaseReorder::fracFlow(double s, int cell) const
@@ -454,11 +500,13 @@ namespace Opm
 
 
 
-    int TransportSolverCompressibleTwophaseReorder::solveGravityColumn(const std::vector<int>& cells)
+    int TransportSolverCompressibleTwophaseReorder::solveGravityColumn(const std::vector<int>& cells,
+                                                                       ColumnWorkspace& ws)
     {
         // Set up column gravflux.
         const int nc = cells.size();
-        std::vector<double> col_gravflux(nc - 1);
+        ws.gravflux.resize(std::max(nc - 1, 1));
+        double* col_gravflux = &ws.gravflux[0];
         for (int ci = 0; ci < nc - 1; ++ci) {
             const int cell = cells[ci];
             const int next_cell = cells[ci + 1];
@@ -474,9 +522,9 @@ namespace Opm
         }
 
         // Store initial saturation s0
-        s0_.resize(nc);
+        ws.s0.resize(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
+            ws.s0[ci] = saturation_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
@@ -488,10 +536,10 @@ namespace Opm
                 const int ci2 = nc - ci - 1;
                 double old_s[2] = { saturation_[cells[ci]],
                                     saturation_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
-                solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
-                solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
+                saturation_[cells[ci]] = ws.s0[ci];
+                solveSingleCellGravity(cells, ci, col_gravflux);
+                saturation_[cells[ci2]] = ws.s0[ci2];
+                solveSingleCellGravity(cells, ci2, col_gravflux);
                 max_s_change = std::max(max_s_change, std::max(std::fabs(saturation_[cells[ci]] - old_s[0]),
                                                                std::fabs(saturation_[cells[ci2]] - old_s[1])));
             }
@@ -541,14 +589,42 @@ namespace Opm
         dt_ = dt;
         toWaterSat(saturation, saturation_);
 
-        // Solve on all columns.
+        // Solve on all columns. The columns are independent, and are
+        // handed out longest first to balance the load between threads.
+        orderColumnsByLength(columns, column_order_);
+        int num_threads = 1;
+#ifdef _OPENMP
+        if (multithreading()) {
+            num_threads = omp_get_max_threads();
+        }
+#endif
+        column_workspaces_.resize(num_threads);
+        const int num_columns = columns.size();
         int num_iters = 0;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns[i]);
+        int max_iters = 0;
+        std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_iters) reduction(max:max_iters) if (multithreading())
+        for (int i = 0; i < num_columns; ++i) {
+            try {
+                ColumnWorkspace& ws = column_workspaces_[threadWorkspaceIndex(column_workspaces_.size())];
+                const int iters = solveGravityColumn(columns[column_order_[i]], ws);
+                num_iters += iters;
+                max_iters = std::max(max_iters, iters);
+            } catch (...) {
+#pragma omp critical(gravity_column_error)
+                {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
         }
         std::cout << "Gauss-Seidel column solver average iterations: "
-                  << double(num_iters)/double(columns.size()) << std::endl;
+                  << double(num_iters)/double(num_columns)
+                  << ", maximum: " << max_iters << std::endl;
         toBothSat(saturation_, saturation);
 
         // Compute surface volume as a postprocessing step from saturation and A_
@@ -75,6 +75,8 @@ namespace Opm
         /// It assumes that the input columns contain cells in a single
         /// vertical stack, that do not interact with other columns (for
         /// gravity segregation.
+        /// If multithreading is enabled (see setMultithreading()),
+        /// columns are solved concurrently.
         /// \param[in] columns           Vector of cell-columns.
         /// \param[in] dt                Time step.
         /// \param[in, out] saturation   Phase saturations.
@@ -87,10 +89,26 @@ namespace Opm
     private:
         virtual void solveSingleCell(const int cell);
         virtual void solveMultiCell(const int num_cells, const int* cells);
+        // Scratch data for multi-cell solves, one per thread. The
+        // cell-indexed array pos is reset sparsely after each component.
+        struct MultiCellWorkspace
+        {
+            std::vector<int> pos;           // cell -> position in component, or -1
+            std::vector<int> needs_update;
+            std::vector<double> s0;
+        };
+        void setupWorkspaces();
+        MultiCellWorkspace& threadWorkspace();
         void solveSingleCellGravity(const std::vector<int>& cells,
                                     const int pos,
                                     const double* gravflux);
-        int solveGravityColumn(const std::vector<int>& cells);
+        // Scratch data for column solves, one per thread.
+        struct ColumnWorkspace
+        {
+            std::vector<double> s0;         // saturation at start of solve
+            std::vector<double> gravflux;   // oriented towards next in column
+        };
+        int solveGravityColumn(const std::vector<int>& cells, ColumnWorkspace& ws);
         void initGravityDynamic();
 
     private:
@@ -118,7 +136,9 @@ namespace Opm
         std::vector<double> density_;
         std::vector<double> gravflux_;
         std::vector<double> mob_;
-        std::vector<double> s0_;
+        std::vector<ColumnWorkspace> column_workspaces_;
+        std::vector<int> column_order_;   // columns by decreasing length
+        std::vector<MultiCellWorkspace> multicell_workspaces_;
 
         // Storing the upwind and downwind graphs for experiments.
         std::vector<int> ia_upw_;
@@ -25,15 +25,27 @@
 #include <opm/core/grid/ColumnExtract.hpp>
 #include <opm/core/utility/RootFinders.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/Profiler.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/linalg/blas_lapack.h>
+#include <opm/common/OpmLog/OpmLog.hpp>
+#include <opm/core/linalg/sparse_sys.h>
+#if HAVE_SUITESPARSE_UMFPACK_H
+#include <opm/core/linalg/call_umfpack.h>
+#endif
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
 #include <fstream>
 #include <iterator>
 #include <numeric>
+#include <sstream>
 
-
-#define EXPERIMENT_GAUSS_SEIDEL
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 namespace Opm
@@ -42,6 +54,92 @@ namespace Opm
     // Choose error policy for scalar solves here.
     typedef RegulaFalsi<WarnAndContinueOnError> RootFinder;
 
+    namespace
+    {
+        // Parameters for multi-cell solves.
+        const double multicell_tol = 1e-9;
+        // Total Gauss-Seidel work allowed, in units of full sweeps.
+        const int gs_max_sweeps = 300;
+        // Gauss-Seidel work before switching to Newton.
+        const int gs_sweeps_before_newton = 20;
+        const int gs_sweeps_before_newton_large = 3;
+        // Components at least this large are considered large.
+        const int newton_large_component = 1000;
+        // Largest component solved with a dense Jacobian.
+        const int newton_max_dense = 400;
+        const int newton_max_iters = 30;
+        // Largest saturation change per Newton iteration.
+        const double newton_max_ds = 0.2;
+
+        // Most distinct curves handled by tabulated fractional flow.
+        const int max_fracflow_tables = 256;
+        // Cells per property call when setting up the tables.
+        const int fracflow_block = 1024;
+        // Relative permeabilities closer than this at all sample
+        // saturations are taken to be the same curve.
+        const double same_curve_tol = 1e-12;
+
+        bool sameCurve(const double* a, const double* b, const int n)
+        {
+            for (int i = 0; i < n; ++i) {
+                if (std::fabs(a[i] - b[i]) > same_curve_tol) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Interpolate (f, df/ds, mob_w, mob_o) at s in a table of
+        // num_points uniformly spaced saturations in [0, 1].
+        void interpolateTable(const double* table, const int num_points,
+                              const double s, double* vals)
+        {
+            const int n = num_points - 1;
+            const double pos = std::min(std::max(s, 0.0), 1.0)*n;
+            const int i = std::min(int(pos), n - 1);
+            const double w = pos - i;
+            const double* v = table + 4*i;
+            for (int k = 0; k < 4; ++k) {
+                vals[k] = (1.0 - w)*v[k] + w*v[k + 4];
+            }
+        }
+
+        // Largest deviation of the interpolated values at s from exact.
+        double tableDeviation(const double* table, const int num_points,
+                              const double s, const double* exact)
+        {
+            double vals[4];
+            interpolateTable(table, num_points, s, vals);
+            double dev = 0.0;
+            for (int k = 0; k < 4; ++k) {
+                dev = std::max(dev, std::fabs(vals[k] - exact[k]));
+            }
+            return dev;
+        }
+
+        bool sparseNewtonAvailable()
+        {
+#if HAVE_SUITESPARSE_UMFPACK_H
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Order columns by decreasing length.
+        void orderColumnsByLength(const std::vector<std::vector<int> >& columns,
+                                  std::vector<int>& order)
+        {
+            order.resize(columns.size());
+            for (int i = 0; i < int(order.size()); ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&columns](const int a, const int b)
+                             { return columns[a].size() > columns[b].size(); });
+        }
+    } // anonymous namespace
+
 
     TransportSolverTwophaseReorder::TransportSolverTwophaseReorder(const UnstructuredGrid& grid,
                                                                    const Opm::IncompPropertiesInterface& props,
@@ -58,13 +156,12 @@ namespace Opm
           saturation_(grid.number_of_cells, -1.0),
           fractionalflow_(grid.number_of_cells, -1.0),
           reorder_iterations_(grid.number_of_cells, 0),
-          mob_(2*grid.number_of_cells, -1.0)
-#ifdef EXPERIMENT_GAUSS_SEIDEL
-        , ia_upw_(grid.number_of_cells + 1, -1),
+          mob_(2*grid.number_of_cells, -1.0),
+          ia_upw_(grid.number_of_cells + 1, -1),
           ja_upw_(grid.number_of_faces, -1),
           ia_downw_(grid.number_of_cells + 1, -1),
-          ja_downw_(grid.number_of_faces, -1)
-#endif
+          ja_downw_(grid.number_of_faces, -1),
+          table_points_(0)
     {
         if (props.numPhases() != 2) {
             OPM_THROW(std::runtime_error, "Property object must have 2 phases");
@@ -95,28 +192,26 @@ namespace Opm
                                                const double dt,
                                                TwophaseState& state)
     {
+        ProfileScope scope("transport_solve");
         darcyflux_ = &state.faceflux()[0];
         porevolume_ = porevolume;
         source_ = source;
         dt_ = dt;
         toWaterSat(state.saturation(), saturation_);
 
-#ifdef EXPERIMENT_GAUSS_SEIDEL
-        std::vector<int> seq(grid_.number_of_cells);
-        std::vector<int> comp(grid_.number_of_cells + 1);
-        int ncomp;
-        compute_sequence_graph(&grid_, darcyflux_,
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_upw_[0], &ja_upw_[0]);
-        const int nf = grid_.number_of_faces;
-        std::vector<double> neg_darcyflux(nf);
-        std::transform(darcyflux_, darcyflux_ + nf, neg_darcyflux.begin(), std::negate<double>());
-        compute_sequence_graph(&grid_, &neg_darcyflux[0],
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_downw_[0], &ja_downw_[0]);
-#endif
         std::fill(reorder_iterations_.begin(),reorder_iterations_.end(),0);
+        invalidateOrdering();
+        // The ordering is computed along with the graphs, and reused
+        // by reorderAndTransport().
+        computeOrderingAndGraphs(grid_, darcyflux_,
+                                 &ia_upw_[0], &ja_upw_[0],
+                                 &ia_downw_[0], &ja_downw_[0]);
+        setupWorkspaces();
         reorderAndTransport(grid_, darcyflux_);
+        if (Profiler::instance().enabled()) {
+            Profiler::instance().addIterations(std::accumulate(reorder_iterations_.begin(),
+                                                               reorder_iterations_.end(), 0L));
+        }
         toBothSat(saturation_, state.saturation());
     }
 
@@ -127,6 +222,30 @@ namespace Opm
     }
 
 
+    void TransportSolverTwophaseReorder::setupWorkspaces()
+    {
+        int num_threads = 1;
+#ifdef _OPENMP
+        if (multithreading()) {
+            num_threads = omp_get_max_threads();
+        }
+#endif
+        workspaces_.resize(num_threads);
+        for (int t = 0; t < num_threads; ++t) {
+            // New entries are -1, and solveMultiCell() restores
+            // entries it uses to -1 when done.
+            workspaces_[t].pos.resize(grid_.number_of_cells, -1);
+        }
+    }
+
+
+    TransportSolverTwophaseReorder::MultiCellWorkspace&
+    TransportSolverTwophaseReorder::threadWorkspace()
+    {
+        return workspaces_[threadWorkspaceIndex(workspaces_.size())];
+    }
+
+
     // Residual function r(s) for a single-cell implicit Euler transport
     //
     //     r(s) = s - s0 + dt/pv*( influx + outflux*f(s) )
@@ -316,147 +435,284 @@ namespace Opm
         // std::cout << "Average distance from upstream neighbours: " << diffsum/double(num_cells)
         //        << std::endl;
 
-#ifdef EXPERIMENT_GAUSS_SEIDEL
-        // Experiment: when a cell changes more than the tolerance,
-        //             mark all downwind cells as needing updates. After
-        //             computing a single update in each cell, use marks
-        //             to guide further updating. Clear mark in cell when
-        //             its solution gets updated.
-        // Verdict: this is a good one! Approx. halved total time.
-        std::vector<int> needs_update(num_cells, 1);
-        // This one also needs the mapping from all cells to
-        // the strongly connected subset to filter out connections
-        std::vector<int> pos(grid_.number_of_cells, -1);
-        for (int i = 0; i < num_cells; ++i) {
-            const int cell = cells[i];
-            pos[cell] = i;
+        // Gauss-Seidel driven by a worklist: when a cell changes more
+        // than the tolerance, its downwind cells in the component are
+        // queued for another update. Initially all cells are queued,
+        // in sequence order. Scratch data is kept in a per-thread
+        // workspace, so that the cost of solving a component does not
+        // depend on the size of the grid.
+        MultiCellWorkspace& ws = threadWorkspace();
+        if (int(ws.s0.size()) < num_cells) {
+            ws.s0.resize(num_cells);
+            ws.queue.resize(num_cells);
+            ws.queued.resize(num_cells);
+            Profiler::instance().addAllocations(3);
         }
-
-        // Note: partially copied from below.
-        const double tol = 1e-9;
-        const int max_iters = 300;
-        // Must store s0 before we start.
-        std::vector<double> s0(num_cells);
-        // Must set initial fractional flows before we start.
-        // Also, we compute the # of upstream neighbours.
-        // std::vector<int> num_upstream(num_cells);
         for (int i = 0; i < num_cells; ++i) {
             const int cell = cells[i];
+            ws.pos[cell] = i;
+            ws.s0[i] = saturation_[cell];
+            // Must set initial fractional flows before we start.
             fractionalflow_[cell] = fracFlow(saturation_[cell], cell);
-            s0[i] = saturation_[cell];
-            // num_upstream[i] = ia_upw_[cell + 1] - ia_upw_[cell];
+            ws.queue[i] = i;
+            ws.queued[i] = 1;
         }
-        // Solve once in each cell.
-        // std::vector<int> fully_marked_stack;
-        // fully_marked_stack.reserve(num_cells);
-        int num_iters = 0;
-        int update_count = 0; // Change name/meaning to cells_updated?
-        do {
-            update_count = 0; // Must reset count for every iteration.
-            for (int i = 0; i < num_cells; ++i) {
-                // while (!fully_marked_stack.empty()) {
-                //     // std::cout << "# fully marked cells = " << fully_marked_stack.size() << std::endl;
-                //     const int fully_marked_ci = fully_marked_stack.back();
-                //     fully_marked_stack.pop_back();
-                //     ++update_count;
-                //     const int cell = cells[fully_marked_ci];
-                //     const double old_s = saturation_[cell];
-                //     saturation_[cell] = s0[fully_marked_ci];
-                //     solveSingleCell(cell);
-                //     const double s_change = std::fabs(saturation_[cell] - old_s);
-                //     if (s_change > tol) {
-                //      // Mark downwind cells.
-                //      for (int j = ia_downw_[cell]; j < ia_downw_[cell+1]; ++j) {
-                //          const int downwind_cell = ja_downw_[j];
-                //          int ci = pos[downwind_cell];
-                //          ++needs_update[ci];
-                //          if (needs_update[ci] == num_upstream[ci]) {
-                //              fully_marked_stack.push_back(ci);
-                //          }
-                //      }
-                //     }
-                //     // Unmark this cell.
-                //     needs_update[fully_marked_ci] = 0;
-                // }
-                if (!needs_update[i]) {
-                    continue;
+        int head = 0;
+        int num_queued = num_cells;
+
+        // Hand over to Newton when Gauss-Seidel is slow, and early
+        // for large components if a sparse solver is available.
+        const bool large = num_cells >= newton_large_component;
+        const bool newton_available = num_cells <= newton_max_dense || sparseNewtonAvailable();
+        const double newton_after = (large && sparseNewtonAvailable())
+            ? double(gs_sweeps_before_newton_large)*num_cells
+            : double(gs_sweeps_before_newton)*num_cells;
+        const double max_updates = double(gs_max_sweeps)*num_cells;
+        bool newton_tried = false;
+        double num_updates = 0;
+        while (num_queued > 0 && num_updates < max_updates) {
+            if (!newton_tried && newton_available && num_updates >= newton_after) {
+                newton_tried = true;
+                if (solveMultiCellNewton(num_cells, cells, ws)) {
+                    num_queued = 0;
+                    break;
                 }
-                ++update_count;
-                const int cell = cells[i];
-                const double old_s = saturation_[cell];
-                saturation_[cell] = s0[i];
-                solveSingleCell(cell);
-                const double s_change = std::fabs(saturation_[cell] - old_s);
-                if (s_change > tol) {
-                    // Mark downwind cells.
-                    for (int j = ia_downw_[cell]; j < ia_downw_[cell+1]; ++j) {
-                        const int downwind_cell = ja_downw_[j];
-                        int ci = pos[downwind_cell];
-                        if (ci != -1) {
-                            needs_update[ci] = 1;
-                        }
-                        // ++needs_update[ci];
-                        // if (needs_update[ci] == num_upstream[ci]) {
-                        //     fully_marked_stack.push_back(ci);
-                        // }
+            }
+            const int i = ws.queue[head];
+            head = (head + 1) % num_cells;
+            --num_queued;
+            ws.queued[i] = 0;
+            ++num_updates;
+
+            const int cell = cells[i];
+            const double old_s = saturation_[cell];
+            saturation_[cell] = ws.s0[i];
+            solveSingleCell(cell);
+            const double s_change = std::fabs(saturation_[cell] - old_s);
+            if (s_change > multicell_tol) {
+                // Queue downwind cells of this component.
+                for (int j = ia_downw_[cell]; j < ia_downw_[cell+1]; ++j) {
+                    const int ci = ws.pos[ja_downw_[j]];
+                    if (ci != -1 && !ws.queued[ci]) {
+                        ws.queue[(head + num_queued) % num_cells] = ci;
+                        ws.queued[ci] = 1;
+                        ++num_queued;
                     }
                 }
-                // Unmark this cell.
-                needs_update[i] = 0;
             }
-            // std::cout << "Iter = " << num_iters << "    update_count = " << update_count
-            //        << "    # marked cells = "
-            //        << std::accumulate(needs_update.begin(), needs_update.end(), 0) << std::endl;
-        } while (update_count > 0 && ++num_iters < max_iters);
+        }
+
+        // Reset the cell-indexed scratch data.
+        for (int i = 0; i < num_cells; ++i) {
+            ws.pos[cells[i]] = -1;
+        }
 
         // Done with iterations, check if we succeeded.
-        if (update_count > 0) {
+        if (num_queued > 0) {
             OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
-                  << num_iters << " iterations. Remaining update count = " << update_count);
+                      << num_updates << " single-cell updates in a " << num_cells
+                      << " cell component. Remaining update count = " << num_queued);
         }
-        std::cout << "Solved " << num_cells << " cell multicell problem in "
-                  << num_iters << " iterations." << std::endl;
+    }
 
-#else
-        double max_s_change = 0.0;
-        const double tol = 1e-9;
-        const int max_iters = 300;
-        int num_iters = 0;
-        // Must store s0 before we start.
-        std::vector<double> s0(num_cells);
-        // Must set initial fractional flows before we start.
+
+    // Solve the coupled system of a strongly connected component by
+    // Newton's method, starting from the current saturations. Uses a
+    // dense Jacobian for small components, and a sparse direct solver
+    // for larger ones. Returns false, with the state restored, if the
+    // iteration failed to converge.
+    bool TransportSolverTwophaseReorder::solveMultiCellNewton(const int num_cells,
+                                                              const int* cells,
+                                                              MultiCellWorkspace& ws)
+    {
+        const bool sparse = num_cells > newton_max_dense;
+        if (int(ws.s_save.size()) < num_cells) {
+            ws.s_save.resize(num_cells);
+            ws.f_save.resize(num_cells);
+            ws.df.resize(num_cells);
+            ws.residual.resize(num_cells);
+            ws.ds.resize(num_cells);
+            Profiler::instance().addAllocations(5);
+        }
         for (int i = 0; i < num_cells; ++i) {
-            const int cell = cells[i];
-            fractionalflow_[cell] = fracFlow(saturation_[cell], cell);
-            s0[i] = saturation_[cell];
+            ws.s_save[i] = saturation_[cells[i]];
+            ws.f_save[i] = fractionalflow_[cells[i]];
         }
-        do {
-            max_s_change = 0.0;
+
+        bool converged = false;
+        for (int iter = 0; iter <= newton_max_iters; ++iter) {
+            // Fractional flows and derivatives at the current state.
             for (int i = 0; i < num_cells; ++i) {
                 const int cell = cells[i];
-                const double old_s = saturation_[cell];
-                saturation_[cell] = s0[i];
-                solveSingleCell(cell);
-                double s_change = std::fabs(saturation_[cell] - old_s);
-                // std::cout << "cell = " << cell << "    delta s = " << s_change << std::endl;
-                if (max_s_change < s_change) {
-                    max_s_change = s_change;
+                fracFlowWithDerivative(saturation_[cell], cell, fractionalflow_[cell], ws.df[i]);
+            }
+            assembleMultiCellNewton(num_cells, cells, sparse, ws);
+            double max_res = 0.0;
+            for (int i = 0; i < num_cells; ++i) {
+                max_res = std::max(max_res, std::fabs(ws.residual[i]));
+            }
+            if (max_res < multicell_tol) {
+                converged = true;
+                break;
+            }
+            if (iter == newton_max_iters) {
+                break;
+            }
+
+            // Solve J ds = r.
+            bool solved = false;
+            if (!sparse) {
+                MAT_SIZE_T n = num_cells;
+                MAT_SIZE_T nrhs = 1;
+                MAT_SIZE_T info = 0;
+                if (int(ws.piv.size()) < num_cells) {
+                    ws.piv.resize(num_cells);
+                    Profiler::instance().addAllocations(1);
+                }
+                std::copy(ws.residual.begin(), ws.residual.begin() + num_cells, ws.ds.begin());
+                dgesv_(&n, &nrhs, &ws.jac[0], &n, &ws.piv[0], &ws.ds[0], &n, &info);
+                solved = (info == 0);
+            } else {
+#if HAVE_SUITESPARSE_UMFPACK_H
+                if (!ws.umfpack) {
+                    ws.umfpack.reset(call_UMFPACK_handle_create(), call_UMFPACK_handle_destroy);
                 }
+                CSRMatrix A;
+                A.m = num_cells;
+                A.nnz = ws.jac_ia[num_cells];
+                A.ia = &ws.jac_ia[0];
+                A.ja = &ws.jac_ja[0];
+                A.sa = &ws.jac_sa[0];
+                solved = ws.umfpack
+                    && call_UMFPACK_handle_solve(ws.umfpack.get(), &A, &ws.residual[0], &ws.ds[0]) >= 0;
+#endif
+            }
+            if (!solved) {
+                break;
+            }
+
+            // Damped update, chopped to the unit interval.
+            // A singular-matrix warning from UMFPACK leaves a
+            // non-finite step, which counts as a failed solve.
+            double max_ds = 0.0;
+            bool finite = true;
+            for (int i = 0; i < num_cells; ++i) {
+                finite = finite && std::isfinite(ws.ds[i]);
+                max_ds = std::max(max_ds, std::fabs(ws.ds[i]));
+            }
+            if (!finite) {
+                break;
+            }
+            const double damping = max_ds > newton_max_ds ? newton_max_ds/max_ds : 1.0;
+            for (int i = 0; i < num_cells; ++i) {
+                const int cell = cells[i];
+                const double s = saturation_[cell] - damping*ws.ds[i];
+                saturation_[cell] = std::min(std::max(s, 0.0), 1.0);
+                ++reorder_iterations_[cell];
+            }
+        }
+
+        if (!converged) {
+            for (int i = 0; i < num_cells; ++i) {
+                saturation_[cells[i]] = ws.s_save[i];
+                fractionalflow_[cells[i]] = ws.f_save[i];
+            }
+        }
+        return converged;
+    }
+
+
+    // Assemble the residual of the component, see Residual, and its
+    // Jacobian. Assumes fractionalflow_ and ws.df are evaluated at
+    // the current saturations, and ws.pos maps the component's cells.
+    void TransportSolverTwophaseReorder::assembleMultiCellNewton(const int num_cells,
+                                                                 const int* cells,
+                                                                 const bool sparse,
+                                                                 MultiCellWorkspace& ws) const
+    {
+        if (sparse) {
+            if (int(ws.slot.size()) < num_cells) {
+                ws.slot.resize(num_cells, -1);
+            }
+            ws.jac_ia.resize(num_cells + 1);
+            ws.jac_ja.clear();
+            ws.jac_sa.clear();
+            ws.jac_ia[0] = 0;
+        } else {
+            ws.jac.assign(num_cells*num_cells, 0.0);
+        }
+
+        for (int i = 0; i < num_cells; ++i) {
+            const int cell = cells[i];
+            const double src_flux = -source_[cell];
+            const bool src_is_inflow = src_flux < 0.0;
+            double influx  =  src_is_inflow ? src_flux : 0.0;
+            double outflux = !src_is_inflow ? src_flux : 0.0;
+            const double dtpv = dt_/porevolume_[cell];
+            if (sparse) {
+                // Diagonal first, value set below.
+                ws.slot[i] = ws.jac_ja.size();
+                ws.jac_ja.push_back(i);
+                ws.jac_sa.push_back(0.0);
+            }
+            for (int k = grid_.cell_facepos[cell]; k < grid_.cell_facepos[cell+1]; ++k) {
+                const int f = grid_.cell_faces[k];
+                double flux;
+                int other;
+                if (cell == grid_.face_cells[2*f]) {
+                    flux  = darcyflux_[f];
+                    other = grid_.face_cells[2*f+1];
+                } else {
+                    flux  =-darcyflux_[f];
+                    other = grid_.face_cells[2*f];
+                }
+                if (other == -1) {
+                    continue;
+                }
+                if (flux >= 0.0) {
+                    outflux += flux;
+                    continue;
+                }
+                influx += flux*fractionalflow_[other];
+                const int j = ws.pos[other];
+                if (j == -1) {
+                    // Upwind cell outside the component, already solved.
+                    continue;
+                }
+                const double dr = dtpv*flux*ws.df[j];
+                if (!sparse) {
+                    ws.jac[j*num_cells + i] += dr;
+                } else if (ws.slot[j] != -1) {
+                    ws.jac_sa[ws.slot[j]] += dr;
+                } else {
+                    ws.slot[j] = ws.jac_ja.size();
+                    ws.jac_ja.push_back(j);
+                    ws.jac_sa.push_back(dr);
+                }
+            }
+            ws.residual[i] = saturation_[cell] - ws.s0[i]
+                + dtpv*(outflux*fractionalflow_[cell] + influx);
+            const double diag = 1.0 + dtpv*outflux*ws.df[i];
+            if (sparse) {
+                const int row_begin = ws.jac_ia[i];
+                const int row_end = ws.jac_ja.size();
+                ws.jac_sa[row_begin] = diag;
+                for (int e = row_begin; e < row_end; ++e) {
+                    ws.slot[ws.jac_ja[e]] = -1;
+                }
+                ws.jac_ia[i + 1] = row_end;
+            } else {
+                ws.jac[i*num_cells + i] = diag;
             }
-            // std::cout << "Iter = " << num_iters << "    max_s_change = " << max_s_change
-            //        << "    in cell " << max_change_cell << std::endl;
-        } while (max_s_change > tol && ++num_iters < max_iters);
-        if (max_s_change > tol) {
-            OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
-                  << num_iters << " iterations. Delta s = " << max_s_change);
         }
-        std::cout << "Solved " << num_cells << " cell multicell problem in "
-                  << num_iters << " iterations." << std::endl;
-#endif // EXPERIMENT_GAUSS_SEIDEL
     }
 
     double TransportSolverTwophaseReorder::fracFlow(double s, int cell) const
     {
+        double vals[4];
+        if (tabulatedValues(s, cell, vals)) {
+            return vals[0];
+        }
         double sat[2] = { s, 1.0 - s };
         double mob[2];
         props_.relperm(1, sat, &cell, mob, 0);
@@ -465,6 +721,29 @@ namespace Opm
         return mob[0]/(mob[0] + mob[1]);
     }
 
+    void TransportSolverTwophaseReorder::fracFlowWithDerivative(double s, int cell,
+                                                                double& f, double& df) const
+    {
+        double vals[4];
+        if (tabulatedValues(s, cell, vals)) {
+            f = vals[0];
+            df = vals[1];
+            return;
+        }
+        double sat[2] = { s, 1.0 - s };
+        double mob[2];
+        double dmob[4];
+        props_.relperm(1, sat, &cell, mob, dmob);
+        mob[0] /= visc_[0];
+        mob[1] /= visc_[1];
+        // dmob is in Fortran order, the second saturation is 1 - s.
+        const double dmob_w = (dmob[0] - dmob[2])/visc_[0];
+        const double dmob_o = (dmob[1] - dmob[3])/visc_[1];
+        const double mob_tot = mob[0] + mob[1];
+        f = mob[0]/mob_tot;
+        df = (dmob_w*mob[1] - mob[0]*dmob_o)/(mob_tot*mob_tot);
+    }
+
 
 
 
@@ -530,6 +809,12 @@ namespace Opm
 
     void TransportSolverTwophaseReorder::mobility(double s, int cell, double* mob) const
     {
+        double vals[4];
+        if (tabulatedValues(s, cell, vals)) {
+            mob[0] = vals[2];
+            mob[1] = vals[3];
+            return;
+        }
         double sat[2] = { s, 1.0 - s };
         props_.relperm(1, sat, &cell, mob, 0);
         mob[0] /= visc_[0];
@@ -538,6 +823,241 @@ namespace Opm
 
 
 
+    // Scratch arrays of exactValues(), reused between calls.
+    struct TransportSolverTwophaseReorder::ExactValuesScratch
+    {
+        std::vector<double> sat;
+        std::vector<double> mob;
+        std::vector<double> dmob;
+    };
+
+
+
+    // Exact (f, df/ds, mob_w, mob_o) at n (cell, saturation) points,
+    // as computed by fracFlowWithDerivative() and mobility(), in a
+    // single property evaluation.
+    void TransportSolverTwophaseReorder::exactValues(const int n, const int* cells,
+                                                     const double* s, double* vals,
+                                                     ExactValuesScratch& scratch) const
+    {
+        scratch.sat.resize(2*n);
+        scratch.mob.resize(2*n);
+        scratch.dmob.resize(4*n);
+        for (int i = 0; i < n; ++i) {
+            scratch.sat[2*i] = s[i];
+            scratch.sat[2*i + 1] = 1.0 - s[i];
+        }
+        props_.relperm(n, &scratch.sat[0], cells, &scratch.mob[0], &scratch.dmob[0]);
+        for (int i = 0; i < n; ++i) {
+            const double mob_w = scratch.mob[2*i]/visc_[0];
+            const double mob_o = scratch.mob[2*i + 1]/visc_[1];
+            // dmob is in Fortran order, the second saturation is 1 - s.
+            const double* dm = &scratch.dmob[4*i];
+            const double dmob_w = (dm[0] - dm[2])/visc_[0];
+            const double dmob_o = (dm[1] - dm[3])/visc_[1];
+            const double mob_tot = mob_w + mob_o;
+            double* v = vals + 4*i;
+            v[0] = mob_w/mob_tot;
+            v[1] = (dmob_w*mob_o - mob_w*dmob_o)/(mob_tot*mob_tot);
+            v[2] = mob_w;
+            v[3] = mob_o;
+        }
+    }
+
+
+
+    void TransportSolverTwophaseReorder::setTabulatedFractionalFlow(const int num_points,
+                                                                    const double tolerance)
+    {
+        fracflow_table_.clear();
+        cell_table_.clear();
+        table_points_ = 0;
+        if (num_points == 0) {
+            return;
+        }
+        if (num_points < 2) {
+            OPM_THROW(std::runtime_error, "Tabulated fractional flow needs at least 2 points, got "
+                      << num_points);
+        }
+
+        // Group cells with the same curves, as identified by their
+        // values at a few saturations. Cells are evaluated in blocks,
+        // so that each property call covers many points.
+        const int num_samples = 11;
+        const double sample_sat[num_samples] = { 0.0, 0.013, 0.1, 0.2, 0.31, 0.5,
+                                                 0.63, 0.8, 0.9, 0.987, 1.0 };
+        const int nc = grid_.number_of_cells;
+        std::vector<double> sat(2*num_samples*fracflow_block);
+        for (int b = 0; b < fracflow_block; ++b) {
+            for (int k = 0; k < num_samples; ++k) {
+                sat[2*(num_samples*b + k)] = sample_sat[k];
+                sat[2*(num_samples*b + k) + 1] = 1.0 - sample_sat[k];
+            }
+        }
+        std::vector<int> block_cells(num_samples*fracflow_block);
+        std::vector<double> kr(2*num_samples*fracflow_block);
+        std::vector<double> curves;     // sampled curves of each table
+        std::vector<int> table_cell;    // representative cell of each table
+        // Must not be assigned to cell_table_ before the tables are
+        // built, since the exact evaluations below would use them.
+        std::vector<int> table_of_cell(nc);
+        int last = -1;
+        for (int begin = 0; begin < nc; begin += fracflow_block) {
+            const int nb = std::min(fracflow_block, nc - begin);
+            for (int b = 0; b < nb; ++b) {
+                std::fill_n(&block_cells[num_samples*b], num_samples, begin + b);
+            }
+            props_.relperm(num_samples*nb, &sat[0], &block_cells[0], &kr[0], 0);
+            for (int b = 0; b < nb; ++b) {
+                const double* curve = &kr[2*num_samples*b];
+                // Neighbouring cells usually share curves.
+                int t = (last >= 0 && sameCurve(curve, &curves[2*num_samples*last], 2*num_samples))
+                    ? last : -1;
+                for (int g = 0; t < 0 && g < int(table_cell.size()); ++g) {
+                    if (sameCurve(curve, &curves[2*num_samples*g], 2*num_samples)) {
+                        t = g;
+                    }
+                }
+                if (t < 0) {
+                    if (int(table_cell.size()) == max_fracflow_tables) {
+                        OpmLog::warning("Tabulated fractional flow disabled, more than "
+                                        + std::to_string(max_fracflow_tables)
+                                        + " distinct relative permeability curves.");
+                        return;
+                    }
+                    t = table_cell.size();
+                    table_cell.push_back(begin + b);
+                    curves.insert(curves.end(), curve, curve + 2*num_samples);
+                }
+                table_of_cell[begin + b] = last = t;
+            }
+        }
+
+        // Build one table per group from its representative cell.
+        ExactValuesScratch scratch;
+        const int num_tables = table_cell.size();
+        std::vector<double> tables(4*num_tables*num_points);
+        std::vector<int> point_cells(num_tables*num_points);
+        std::vector<double> point_sat(num_tables*num_points);
+        for (int t = 0; t < num_tables; ++t) {
+            for (int i = 0; i < num_points; ++i) {
+                point_cells[t*num_points + i] = table_cell[t];
+                point_sat[t*num_points + i] = double(i)/double(num_points - 1);
+            }
+        }
+        exactValues(num_tables*num_points, &point_cells[0], &point_sat[0], &tables[0], scratch);
+
+        // Check each table against its representative cell at the
+        // table points and the interval midpoints.
+        const int num_check = 2*num_points - 1;
+        point_cells.resize(num_tables*num_check);
+        point_sat.resize(num_tables*num_check);
+        for (int t = 0; t < num_tables; ++t) {
+            for (int j = 0; j < num_check; ++j) {
+                point_cells[t*num_check + j] = table_cell[t];
+                point_sat[t*num_check + j] = 0.5*double(j)/double(num_points - 1);
+            }
+        }
+        std::vector<double> exact(4*num_tables*num_check);
+        exactValues(num_tables*num_check, &point_cells[0], &point_sat[0], &exact[0], scratch);
+        std::vector<char> table_ok(num_tables);
+        double max_dev = 0.0;
+        for (int t = 0; t < num_tables; ++t) {
+            double dev = 0.0;
+            for (int j = 0; j < num_check; ++j) {
+                dev = std::max(dev, tableDeviation(&tables[4*t*num_points], num_points,
+                                                   point_sat[t*num_check + j],
+                                                   &exact[4*(t*num_check + j)]));
+            }
+            max_dev = std::max(max_dev, dev);
+            table_ok[t] = dev <= tolerance;
+        }
+
+        // Equal values at the sample saturations do not imply equal
+        // curves, so every cell is also checked against its group's
+        // table halfway between the sample saturations. Cells that
+        // fail, or whose table failed, are evaluated exactly.
+        const int num_between = num_samples - 1;
+        point_sat.resize(num_between*fracflow_block);
+        for (int b = 0; b < fracflow_block; ++b) {
+            for (int k = 0; k < num_between; ++k) {
+                point_sat[num_between*b + k] = 0.5*(sample_sat[k] + sample_sat[k + 1]);
+            }
+        }
+        exact.resize(4*num_between*fracflow_block);
+        std::vector<int> cells_of_table(num_tables, 0);
+        for (int begin = 0; begin < nc; begin += fracflow_block) {
+            const int nb = std::min(fracflow_block, nc - begin);
+            for (int b = 0; b < nb; ++b) {
+                std::fill_n(&block_cells[num_between*b], num_between, begin + b);
+            }
+            exactValues(num_between*nb, &block_cells[0], &point_sat[0], &exact[0], scratch);
+            for (int b = 0; b < nb; ++b) {
+                const int cell = begin + b;
+                const int t = table_of_cell[cell];
+                double dev = 0.0;
+                for (int k = 0; k < num_between; ++k) {
+                    const int p = num_between*b + k;
+                    dev = std::max(dev, tableDeviation(&tables[4*t*num_points], num_points,
+                                                       point_sat[p], &exact[4*p]));
+                }
+                max_dev = std::max(max_dev, dev);
+                if (table_ok[t] && dev <= tolerance) {
+                    ++cells_of_table[t];
+                } else {
+                    table_of_cell[cell] = -1;
+                }
+            }
+        }
+
+        // Keep only tables that are used by some cell.
+        std::vector<int> new_index(num_tables, -1);
+        int num_kept = 0;
+        for (int t = 0; t < num_tables; ++t) {
+            if (cells_of_table[t] > 0) {
+                std::copy(tables.begin() + 4*t*num_points, tables.begin() + 4*(t + 1)*num_points,
+                          tables.begin() + 4*num_kept*num_points);
+                new_index[t] = num_kept++;
+            }
+        }
+        tables.resize(4*num_kept*num_points);
+        fracflow_table_.swap(tables);
+        table_points_ = num_points;
+        int num_exact = 0;
+        for (int cell = 0; cell < nc; ++cell) {
+            if (table_of_cell[cell] >= 0) {
+                table_of_cell[cell] = new_index[table_of_cell[cell]];
+            } else {
+                ++num_exact;
+            }
+        }
+        cell_table_.swap(table_of_cell);
+        std::ostringstream os;
+        os << "Tabulated fractional flow: " << num_kept << " of " << num_tables
+           << " tables used with tolerance " << tolerance << " (maximum deviation "
+           << max_dev << "), " << num_exact << " cells evaluated exactly.";
+        if (num_exact > 0) {
+            OpmLog::warning(os.str());
+        } else {
+            OpmLog::info(os.str());
+        }
+    }
+
+
+
+    // Interpolate (f, df/ds, mob_w, mob_o) from the cell's table.
+    // Returns false if the cell is not tabulated.
+    bool TransportSolverTwophaseReorder::tabulatedValues(double s, int cell, double* vals) const
+    {
+        if (cell_table_.empty() || cell_table_[cell] < 0) {
+            return false;
+        }
+        interpolateTable(&fracflow_table_[4*cell_table_[cell]*table_points_], table_points_, s, vals);
+        return true;
+    }
+
+
+
     void TransportSolverTwophaseReorder::initGravity(const double* grav)
     {
         // Set up gravflux_ = T_ij g (rho_w - rho_o) (z_i - z_j)
@@ -565,6 +1085,7 @@ namespace Opm
     void TransportSolverTwophaseReorder::initColumns()
     {
         extractColumn(grid_, columns_);
+        orderColumnsByLength(columns_, column_order_);
     }
 
 
@@ -586,11 +1107,13 @@ namespace Opm
 
 
 
-    int TransportSolverTwophaseReorder::solveGravityColumn(const std::vector<int>& cells)
+    int TransportSolverTwophaseReorder::solveGravityColumn(const std::vector<int>& cells,
+                                                           ColumnWorkspace& ws)
     {
         // Set up column gravflux.
         const int nc = cells.size();
-        std::vector<double> col_gravflux(nc - 1);
+        ws.gravflux.resize(std::max(nc - 1, 1));
+        double* col_gravflux = &ws.gravflux[0];
         for (int ci = 0; ci < nc - 1; ++ci) {
             const int cell = cells[ci];
             const int next_cell = cells[ci + 1];
@@ -606,9 +1129,9 @@ namespace Opm
         }
 
         // Store initial saturation s0
-        s0_.resize(nc);
+        ws.s0.resize(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
+            ws.s0[ci] = saturation_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
@@ -620,10 +1143,10 @@ namespace Opm
                 const int ci2 = nc - ci - 1;
                 double old_s[2] = { saturation_[cells[ci]],
                                     saturation_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
-                solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
-                solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
+                saturation_[cells[ci]] = ws.s0[ci];
+                solveSingleCellGravity(cells, ci, col_gravflux);
+                saturation_[cells[ci2]] = ws.s0[ci2];
+                solveSingleCellGravity(cells, ci2, col_gravflux);
                 max_s_change = std::max(max_s_change, std::max(std::fabs(saturation_[cells[ci]] - old_s[0]),
                                                                std::fabs(saturation_[cells[ci2]] - old_s[1])));
             }
@@ -643,6 +1166,7 @@ namespace Opm
                                                       const double dt,
                                                       TwophaseState& state)
     {
+        ProfileScope scope("gravity_solve");
         // Initialize mobilities.
         const int nc = grid_.number_of_cells;
         std::vector<int> cells(nc);
@@ -662,14 +1186,41 @@ namespace Opm
         dt_ = dt;
         toWaterSat(state.saturation(), saturation_);
 
-        // Solve on all columns.
+        // Solve on all columns. The columns are independent, and are
+        // handed out longest first to balance the load between threads.
+        int num_threads = 1;
+#ifdef _OPENMP
+        if (multithreading()) {
+            num_threads = omp_get_max_threads();
+        }
+#endif
+        column_workspaces_.resize(num_threads);
+        const int num_columns = columns_.size();
         int num_iters = 0;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns_.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns_[i]);
+        int max_iters = 0;
+        std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:num_iters) reduction(max:max_iters) if (multithreading())
+        for (int i = 0; i < num_columns; ++i) {
+            try {
+                ColumnWorkspace& ws = column_workspaces_[threadWorkspaceIndex(column_workspaces_.size())];
+                const int iters = solveGravityColumn(columns_[column_order_[i]], ws);
+                num_iters += iters;
+                max_iters = std::max(max_iters, iters);
+            } catch (...) {
+#pragma omp critical(gravity_column_error)
+                {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
         }
         std::cout << "Gauss-Seidel column solver average iterations: "
-                  << double(num_iters)/double(columns_.size()) << std::endl;
+                  << double(num_iters)/double(num_columns)
+                  << ", maximum: " << max_iters << std::endl;
 
         toBothSat(saturation_, state.saturation());
     }
@@ -22,10 +22,13 @@
 
 #include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
 #include <opm/core/transport/TransportSolverTwophaseInterface.hpp>
+#include <opm/core/linalg/blas_lapack.h>
 #include <vector>
 #include <map>
+#include <memory>
 #include <ostream>
 struct UnstructuredGrid;
+struct UMFPACKHandle;
 
 namespace Opm
 {
@@ -33,6 +36,12 @@ namespace Opm
     class IncompPropertiesInterface;
 
     /// Implements a reordering transport solver for incompressible two-phase flow.
+    ///
+    /// Strongly connected components of the reordered sequence are
+    /// solved by a worklist-driven nonlinear Gauss-Seidel iteration,
+    /// revisiting only cells downwind of a changed cell. Components
+    /// that converge slowly, or are large, are handed over to a
+    /// Newton solver for the coupled system of the component.
     class TransportSolverTwophaseReorder : public TransportSolverTwophaseInterface, ReorderSolverInterface
     {
     public:
@@ -68,6 +77,7 @@ namespace Opm
         /// This uses a column-wise nonlinear Gauss-Seidel approach.
         /// It assumes that the grid can be divided into vertical columns
         /// that do not interact with each other (for gravity segregation).
+        /// If multithreading is enabled, columns are solved concurrently.
         /// \param[in] porevolume        Array of pore volumes.
         /// \param[in] dt                Time step.
         /// \param[in, out] state        Reservoir state. Calling solveGravity() will read state.faceflux() and
@@ -80,16 +90,71 @@ namespace Opm
         //// \return vector of iteration per cell
         const std::vector<int>& getReorderIterations() const;
 
+        /// Enable or disable concurrent solution of independent
+        /// components of the reordered sequence.
+        using ReorderSolverInterface::setMultithreading;
+
+        /// Evaluate fractional flow and mobilities by table lookup
+        /// instead of calling the property object. Cells are grouped
+        /// by the values of their relative permeability curves at a
+        /// few saturations, and each group gets a table with
+        /// num_points uniformly spaced saturations in [0, 1]. A table
+        /// is checked against its group's first cell at the table
+        /// points and interval midpoints, and every cell against its
+        /// table between the sampled saturations; a cell whose
+        /// fractional flow, its derivative or mobilities deviate more
+        /// than tolerance is evaluated exactly.
+        /// \param[in] num_points  Table size, 0 disables tabulation.
+        /// \param[in] tolerance   Accepted absolute deviation.
+        void setTabulatedFractionalFlow(const int num_points, const double tolerance);
+
     private:
         void initGravity(const double* grav);
         void initColumns();
         virtual void solveSingleCell(const int cell);
         virtual void solveMultiCell(const int num_cells, const int* cells);
 
+        // Scratch data for multi-cell solves. There is one workspace
+        // per thread. The cell-indexed array pos is reset sparsely
+        // after each component, the others are indexed by position
+        // in the component and only grow.
+        struct MultiCellWorkspace
+        {
+            std::vector<int> pos;           // cell -> position in component, or -1
+            std::vector<double> s0;         // saturation at start of time step
+            std::vector<int> queue;         // circular worklist of positions
+            std::vector<char> queued;       // is position in worklist?
+            // For the Newton solver.
+            std::vector<double> s_save;     // state to restore on failure
+            std::vector<double> f_save;
+            std::vector<double> df;         // fractional flow derivatives
+            std::vector<double> residual;
+            std::vector<double> ds;
+            std::vector<double> jac;        // dense Jacobian, column major
+            std::vector<MAT_SIZE_T> piv;    // pivots of dense factorisation
+            std::vector<int> jac_ia;        // sparse Jacobian, CSR
+            std::vector<int> jac_ja;
+            std::vector<double> jac_sa;
+            std::vector<int> slot;          // column -> entry in current row, or -1
+            std::shared_ptr<UMFPACKHandle> umfpack;
+        };
+        void setupWorkspaces();
+        MultiCellWorkspace& threadWorkspace();
+        bool solveMultiCellNewton(const int num_cells, const int* cells,
+                                  MultiCellWorkspace& ws);
+        void assembleMultiCellNewton(const int num_cells, const int* cells,
+                                     const bool sparse, MultiCellWorkspace& ws) const;
+
         void solveSingleCellGravity(const std::vector<int>& cells,
                                     const int pos,
                                     const double* gravflux);
-        int solveGravityColumn(const std::vector<int>& cells);
+        // Scratch data for column solves, one per thread.
+        struct ColumnWorkspace
+        {
+            std::vector<double> s0;         // saturation at start of solve
+            std::vector<double> gravflux;   // oriented towards next in column
+        };
+        int solveGravityColumn(const std::vector<int>& cells, ColumnWorkspace& ws);
     private:
         const UnstructuredGrid& grid_;
         const IncompPropertiesInterface& props_;
@@ -110,20 +175,35 @@ namespace Opm
         // For gravity segregation.
         std::vector<double> gravflux_;
         std::vector<double> mob_;
-        std::vector<double> s0_;
+        std::vector<ColumnWorkspace> column_workspaces_;
+        std::vector<int> column_order_;   // columns by decreasing length
         std::vector<std::vector<int> > columns_;
 
-        // Storing the upwind and downwind graphs for experiments.
+        // Upwind and downwind graphs, the latter drives the
+        // Gauss-Seidel worklist in solveMultiCell().
         std::vector<int> ia_upw_;
         std::vector<int> ja_upw_;
         std::vector<int> ia_downw_;
         std::vector<int> ja_downw_;
+        std::vector<MultiCellWorkspace> workspaces_;
 
         struct Residual;
         double fracFlow(double s, int cell) const;
+        void fracFlowWithDerivative(double s, int cell, double& f, double& df) const;
 
         struct GravityResidual;
         void mobility(double s, int cell, double* mob) const;
+        struct ExactValuesScratch;
+        void exactValues(const int n, const int* cells, const double* s, double* vals,
+                         ExactValuesScratch& scratch) const;
+
+        // Tabulated fractional flow, see setTabulatedFractionalFlow().
+        // For each table and saturation point, the entries are
+        // (f, df/ds, mob_w, mob_o), stored consecutively.
+        std::vector<double> fracflow_table_;
+        std::vector<int> cell_table_;     // table of each cell, -1 if exact
+        int table_points_;
+        bool tabulatedValues(double s, int cell, double* vals) const;
     };
 
 } // namespace Opm
@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <numeric>
 #include <vector>
 
 struct SortByAbsFlux
@@ -29,90 +30,101 @@ struct SortByAbsFlux
 };
 
 
-/* Construct adjacency matrix of upwind graph wrt flux.  Column
-   indices are not sorted. */
+/* Construct adjacency matrices of upwind graph and (optionally)
+   downwind graph wrt flux in a single pass over the half-faces.
+   Column indices are not sorted, but follow the half-face order of
+   each cell. */
 // ---------------------------------------------------------------------
 static void
-make_upwind_graph(int           nc       ,
-                  const int    *cellfaces,
-                  const int    *faceptr  ,
-                  const int    *face2cell,
-                  const double *flux     ,
-                  int          *ia       ,
-                  int          *ja       ,
-                  int          *work     )
+make_upwind_downwind_graphs(int           nc       ,
+                            const int    *cellfaces,
+                            const int    *faceptr  ,
+                            const int    *face2cell,
+                            const double *flux     ,
+                            int          *ia_upw   ,
+                            int          *ja_upw   ,
+                            int          *ia_downw ,
+                            int          *ja_downw )
 // ---------------------------------------------------------------------
 {
-    /* Using topology (conn, cptr), and direction, construct adjacency
-       matrix of graph. */
-
-    int i, j, p, f, positive_sign, boundaryface;
+    int i, j, f, other, p_upw, p_downw, positive_sign;
     double theflux;
 
-    /* For each face, store upwind cell in work array */
-    for (i=0; i<nc; ++i)
-    {
-        for (j=faceptr[i]; j<faceptr[i+1]; ++j)
-        {
-            f  = cellfaces[j];
-            positive_sign = (i == face2cell[2*f]);
-            theflux = positive_sign ? flux[f] : -flux[f];
+    const int downw = (ia_downw != 0) && (ja_downw != 0);
 
-            if ( theflux > 0  )
-            {
-                /* i is upwind cell for face f */
-                work[f] = i;
-            }
-        }
-    }
+    p_upw   = 0;
+    p_downw = 0;
+    ia_upw[0] = p_upw;
+    if (downw) { ia_downw[0] = p_downw; }
 
-    /* Fill ia and ja */
-    p = 0;
-    ia[0] = p;
     for (i=0; i<nc; ++i)
     {
         for (j=faceptr[i]; j<faceptr[i+1]; ++j)
         {
+            f     = cellfaces[j];
+            positive_sign = (i == face2cell[2*f]);
+            other = face2cell[2*f + positive_sign];
 
-            f  = cellfaces[j];
-            boundaryface = (face2cell[2*f+0] == -1) ||
-                           (face2cell[2*f+1] == -1);
-
-            if ( boundaryface )
+            if ( other == -1 )
             {
+                /* Boundary face */
                 continue;
             }
 
-            positive_sign = (i == face2cell[2*f]);
             theflux = positive_sign ? flux[f] : -flux[f];
 
-            if ( theflux < 0)
+            if ( theflux < 0 )
+            {
+                /* other is upwind cell for face f */
+                ja_upw[p_upw++] = other;
+            }
+            else if ( downw && (theflux > 0) )
             {
-                ja[p++] = work[f];
+                /* other is downwind cell for face f */
+                ja_downw[p_downw++] = other;
             }
         }
-        ia[i+1] = p;
+        ia_upw[i+1] = p_upw;
+        if (downw) { ia_downw[i+1] = p_downw; }
     }
 }
 
 
 // ---------------------------------------------------------------------
-static void
-compute_reorder_sequence_graph(int           nc,
-                               const int    *cellfaces,
-                               const int    *facepos,
-                               const int    *face2cell,
-                               const double *flux,
-                               int          *sequence,
-                               int          *components,
-                               int          *ncomponents,
-                               int *ia, int *ja, int* work)
+std::size_t
+compute_sequence_worksize(const struct UnstructuredGrid* grid)
+// ---------------------------------------------------------------------
+{
+    /* Tarjan's algorithm is the only consumer. */
+    return 3 * static_cast<std::size_t>(grid->number_of_cells);
+}
+
+
+// ---------------------------------------------------------------------
+void
+compute_sequence_graphs(const struct UnstructuredGrid* grid       ,
+                        const double*                  flux       ,
+                        int*                           sequence   ,
+                        int*                           components ,
+                        int*                           ncomponents,
+                        int*                           ia_upw     ,
+                        int*                           ja_upw     ,
+                        int*                           ia_downw   ,
+                        int*                           ja_downw   ,
+                        int*                           work       )
 // ---------------------------------------------------------------------
 {
-    make_upwind_graph(nc, cellfaces, facepos, face2cell,
-                      flux, ia, ja, work);
+    const int nc = grid->number_of_cells;
+
+    make_upwind_downwind_graphs(nc,
+                                grid->cell_faces,
+                                grid->cell_facepos,
+                                grid->face_cells,
+                                flux,
+                                ia_upw, ja_upw,
+                                ia_downw, ja_downw);
 
-    tarjan (nc, ia, ja, sequence, components, ncomponents, work);
+    tarjan (nc, ia_upw, ja_upw, sequence, components, ncomponents, work);
 
     assert (0 < *ncomponents);
     assert (*ncomponents <= nc);
@@ -130,21 +142,13 @@ compute_sequence(const struct UnstructuredGrid* grid       ,
 {
     const std::size_t nc = grid->number_of_cells;
     const std::size_t nf = grid->number_of_faces;
-    const std::size_t sz = std::max(nf, 3 * nc);
 
-    std::vector<int> work(sz);
+    std::vector<int> work(compute_sequence_worksize(grid));
     std::vector<int> ia  (nc + 1);
     std::vector<int> ja  (nf);  // A bit too much.
 
-    compute_reorder_sequence_graph(grid->number_of_cells,
-                                   grid->cell_faces,
-                                   grid->cell_facepos,
-                                   grid->face_cells,
-                                   flux,
-                                   sequence,
-                                   components,
-                                   ncomponents,
-                                   & ia[0], & ja[0], & work[0]);
+    compute_sequence_graphs(grid, flux, sequence, components, ncomponents,
+                            & ia[0], & ja[0], 0, 0, & work[0]);
 }
 
 
@@ -159,21 +163,73 @@ compute_sequence_graph(const struct UnstructuredGrid* grid       ,
                        int*                           ja         )
 // ---------------------------------------------------------------------
 {
-    const std::size_t nc = grid->number_of_cells;
-    const std::size_t nf = grid->number_of_faces;
-    const std::size_t sz = std::max(nf, 3 * nc);
-
-    std::vector<int> work(sz);
-
-    compute_reorder_sequence_graph(grid->number_of_cells,
-                                   grid->cell_faces,
-                                   grid->cell_facepos,
-                                   grid->face_cells,
-                                   flux,
-                                   sequence,
-                                   components,
-                                   ncomponents,
-                                   ia, ja, & work[0]);
+    std::vector<int> work(compute_sequence_worksize(grid));
+
+    compute_sequence_graphs(grid, flux, sequence, components, ncomponents,
+                            ia, ja, 0, 0, & work[0]);
+}
+
+
+// ---------------------------------------------------------------------
+void
+compute_component_levels(const struct UnstructuredGrid* grid            ,
+                         const double*                  flux            ,
+                         const int*                     sequence        ,
+                         const int*                     components      ,
+                         int                            ncomponents     ,
+                         int*                           level_components,
+                         int*                           levels          ,
+                         int*                           nlevels         )
+// ---------------------------------------------------------------------
+{
+    const int nc = grid->number_of_cells;
+
+    std::vector<int> comp_of_cell(nc, -1);
+    for (int comp = 0; comp < ncomponents; ++comp) {
+        for (int i = components[comp]; i < components[comp + 1]; ++i) {
+            comp_of_cell[sequence[i]] = comp;
+        }
+    }
+
+    /* Components are in causal order, so the levels of all upwind
+       components are known when a component is visited. */
+    std::vector<int> level(ncomponents, 0);
+    int maxlevel = 0;
+    for (int comp = 0; comp < ncomponents; ++comp) {
+        int l = 0;
+        for (int i = components[comp]; i < components[comp + 1]; ++i) {
+            const int cell = sequence[i];
+            for (int j = grid->cell_facepos[cell]; j < grid->cell_facepos[cell + 1]; ++j) {
+                const int f = grid->cell_faces[j];
+                const int positive_sign = (cell == grid->face_cells[2*f]);
+                const int other = grid->face_cells[2*f + positive_sign];
+                const double theflux = positive_sign ? flux[f] : -flux[f];
+                if (other != -1 && theflux < 0.0) {
+                    const int other_comp = comp_of_cell[other];
+                    if (other_comp != comp) {
+                        assert (other_comp < comp);
+                        l = std::max(l, level[other_comp] + 1);
+                    }
+                }
+            }
+        }
+        level[comp] = l;
+        maxlevel = std::max(maxlevel, l);
+    }
+    *nlevels = maxlevel + 1;
+
+    /* Counting sort of components by level, stable within levels. */
+    std::fill(levels, levels + *nlevels + 1, 0);
+    for (int comp = 0; comp < ncomponents; ++comp) {
+        ++levels[level[comp] + 1];
+    }
+    std::partial_sum(levels, levels + *nlevels + 1, levels);
+    std::vector<int> insert_pos(levels, levels + *nlevels);
+    for (int comp = 0; comp < ncomponents; ++comp) {
+        level_components[insert_pos[level[comp]]++] = comp;
+    }
+
+    assert (levels[*nlevels] == ncomponents);
 }
 
 
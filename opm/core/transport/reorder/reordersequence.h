@@ -11,6 +11,8 @@
  * down-stream cells.
  */
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
@@ -138,6 +140,112 @@ compute_sequence_graph(const struct UnstructuredGrid *grid       ,
                        int                           *ia         ,
                        int                           *ja         );
 
+
+/**
+ * Size of the scratch array needed by compute_sequence_graphs().
+ *
+ * \param[in] grid Grid structure for which to compute causal cell
+ *                 permutation.
+ *
+ * \return Number of <CODE>int</CODE> elements in scratch array.
+ */
+size_t
+compute_sequence_worksize(const struct UnstructuredGrid *grid);
+
+
+/**
+ * Compute causal permutation sequence of grid cells with respect to
+ * specific Darcy flux field, along with the upwind graph and,
+ * optionally, the downwind graph (the transpose of the upwind graph).
+ * Both graphs are built in a single pass over the grid's half-faces,
+ * and the routine does not allocate memory, so repeated calls may
+ * reuse all arrays.
+ *
+ * Parameters <CODE>grid</CODE>, <CODE>flux</CODE>,
+ * <CODE>sequence</CODE>, <CODE>components</CODE>,
+ * <CODE>ncomponents</CODE>, <CODE>ia_upw</CODE> and
+ * <CODE>ja_upw</CODE> are as for compute_sequence_graph().
+ *
+ * \param[out] ia_downw
+ * \param[out] ja_downw
+ *                 Compressed-sparse representation of the downwind
+ *                 graph.  The downwind cells influenced by cell
+ *                 \f$i\f$ are <CODE>ja_downw[ia_downw[i]
+ *                 .. ia_downw[i+1]-1]</CODE>.  Same sizes as
+ *                 <CODE>ia_upw</CODE> and <CODE>ja_upw</CODE>.  If
+ *                 either is <CODE>NULL</CODE>, the downwind graph is
+ *                 not computed.
+ *
+ * \param[out] work Scratch array of at least
+ *                 <CODE>compute_sequence_worksize(grid)</CODE>
+ *                 elements.
+ */
+void
+compute_sequence_graphs(const struct UnstructuredGrid *grid       ,
+                        const double                  *flux       ,
+                        int                           *sequence   ,
+                        int                           *components ,
+                        int                           *ncomponents,
+                        int                           *ia_upw     ,
+                        int                           *ja_upw     ,
+                        int                           *ia_downw   ,
+                        int                           *ja_downw   ,
+                        int                           *work       );
+
+
+/**
+ * Partition the strongly connected components of a causal cell
+ * permutation into levels (wavefronts) of mutually independent
+ * components.  All upwind dependencies of a component in level
+ * \f$l\f$ belong to components in levels \f$0, \dots, l-1\f$,
+ * whence all components of a single level may be solved
+ * concurrently once the preceding levels are complete.
+ *
+ * \param[in] grid Grid structure for which the causal permutation
+ *                 was computed.
+ *
+ * \param[in] flux Darcy flux field.  Must be the same flux that was
+ *                 used to compute <CODE>sequence</CODE> and
+ *                 <CODE>components</CODE>.
+ *
+ * \param[in] sequence
+ *                 Causal grid cell permutation as computed by
+ *                 compute_sequence().
+ *
+ * \param[in] components
+ *                 Strongly connected component indirection pointers
+ *                 as computed by compute_sequence().
+ *
+ * \param[in] ncomponents
+ *                 Number of strongly connected components.
+ *
+ * \param[out] level_components
+ *                 Component indices sorted by level, and in causal
+ *                 order within each level.  Array of size
+ *                 <CODE>ncomponents</CODE>.
+ *
+ * \param[out] levels
+ *                 Indirection pointers into
+ *                 <CODE>level_components</CODE>.  The \f$l\f$'th
+ *                 level constitutes components
+ *                 <CODE>level_components[levels[l] ... levels[l + 1]
+ *                 - 1]</CODE>.  Array of size at least
+ *                 <CODE>ncomponents + 1</CODE>.
+ *
+ * \param[out] nlevels
+ *                 Number of levels.  Pointer to a single integer in
+ *                 the interval <CODE>[1 .. ncomponents]</CODE>.
+ */
+void
+compute_component_levels(const struct UnstructuredGrid *grid            ,
+                         const double                  *flux            ,
+                         const int                     *sequence        ,
+                         const int                     *components      ,
+                         int                            ncomponents     ,
+                         int                           *level_components,
+                         int                           *levels          ,
+                         int                           *nlevels         );
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -39,7 +39,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
-#include <map>
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -56,6 +56,13 @@ using namespace std;
    - sorting slightly more complex.
    - insertion of further values bad.
 
+   ** This is used currently: **
+  three sorted vectors for x-, f- and d-values
+   - contiguous storage, cheap binary search and linear scans
+     in evaluate(), which is what most callers do.
+   - insertion of additional values is linear in the number of
+     points, but the derivatives must be recomputed anyway.
+
   vector<double,double>
    - easy sorting
    - code complexity almost as for map.
@@ -65,7 +72,6 @@ using namespace std;
    - nice code
    - not as sortable, insertion is cumbersome.
 
-   ** This is used currently: **
   map<double, double> one for (x,f) and one for (x,d)
    - Naturally sorted on x-values (done by the map-construction)
    - Slower to set up, awkward loop coding (?)
@@ -103,13 +109,12 @@ MonotCubicInterpolator(const vector<double> & x, const vector<double> & f) {
     throw("Unable to constuct MonotCubicInterpolator from vectors.") ;
   }
 
-  // Add the contents of the input vectors to our map of values.
-  vector<double>::const_iterator posx, posf;
-  for (posx = x.begin(), posf = f.begin(); posx != x.end(); ++posx, ++posf) {
-    data[*posx] = *posf ;
+  vector<pair<double,double> > xf;
+  xf.reserve(x.size());
+  for (vector<double>::size_type i = 0; i < x.size(); ++i) {
+    xf.push_back(make_pair(x[i], f[i]));
   }
-
-  computeInternalFunctionData();
+  setData(xf);
 }
 
 
@@ -118,8 +123,8 @@ bool
 MonotCubicInterpolator::
 read(const std::string & datafilename, int xColumn, int fColumn)
 {
-  data.clear() ;
-  ddata.clear() ;
+  vector<pair<double,double> > xf;
+  setData(xf);
 
   ifstream datafile_fs(datafilename.c_str());
   if (!datafile_fs) {
@@ -150,27 +155,61 @@ read(const std::string & datafilename, int xColumn, int fColumn)
         }
     }
     if (columnindex >= (max(xColumn, fColumn))) {
-      data[value[xColumn-1]] =  value[fColumn-1] ;
+      xf.push_back(make_pair(value[xColumn-1], value[fColumn-1]));
     }
   }
   datafile_fs.close();
 
-  if (data.size() == 0) {
+  if (xf.size() == 0) {
     return false ;
   }
 
-  computeInternalFunctionData();
+  setData(xf);
   return true ;
 }
 
 
+void
+MonotCubicInterpolator::
+setData(vector<pair<double,double> >& xf)
+{
+  // Sort on x, keeping the last of equal x-values, which is what
+  // repeated assignment into a map would give.
+  stable_sort(xf.begin(), xf.end(),
+              [](const pair<double,double>& a, const pair<double,double>& b)
+              { return a.first < b.first; });
+
+  xdata.clear();
+  fdata.clear();
+  xdata.reserve(xf.size());
+  fdata.reserve(xf.size());
+  for (vector<pair<double,double> >::size_type i = 0; i < xf.size(); ++i) {
+    if (!xdata.empty() && xdata.back() == xf[i].first) {
+      fdata.back() = xf[i].second;
+    } else {
+      xdata.push_back(xf[i].first);
+      fdata.push_back(xf[i].second);
+    }
+  }
+
+  computeInternalFunctionData();
+}
+
+
 void
 MonotCubicInterpolator::
 addPair(double newx, double newf) {
   if (std::isnan(newx) || std::isinf(newx) || std::isnan(newf) || std::isinf(newf)) {
     throw("MonotCubicInterpolator: addPair() received inf/nan input.");
   }
-  data[newx] = newf ;
+  vector<double>::iterator pos = lower_bound(xdata.begin(), xdata.end(), newx);
+  const vector<double>::difference_type i = pos - xdata.begin();
+  if (pos != xdata.end() && *pos == newx) {
+    fdata[i] = newf;
+  } else {
+    xdata.insert(pos, newx);
+    fdata.insert(fdata.begin() + i, newf);
+  }
 
   // In a critical application, we should only update the
   // internal function data for the offended interval,
@@ -179,6 +218,42 @@ addPair(double newx, double newf) {
 }
 
 
+int
+MonotCubicInterpolator::
+findInterval(double x) const
+{
+  // Binary search among the left endpoints of the intervals. The
+  // loop body compiles to a conditional move, so the search does
+  // not suffer from branch mispredictions.
+  const double* base = &xdata[0];
+  int len = xdata.size() - 1;
+  while (len > 1) {
+    const int half = len / 2;
+    base = (base[half] <= x) ? base + half : base;
+    len -= half;
+  }
+  return base - &xdata[0];
+}
+
+
+double
+MonotCubicInterpolator::
+evaluateInterval(int i, double x) const
+{
+  // Cubic Hermite spline
+  const double x1 = xdata[i];
+  const double x2 = xdata[i + 1];
+  double t = (x - x1)/(x2 - x1); // t \in [0,1]
+  double h = x2 - x1;
+  double finterp
+    = fdata[i]       * H00(t)
+    + ddata[i]       * H10(t) * h
+    + fdata[i + 1]   * H01(t)
+    + ddata[i + 1]   * H11(t) * h ;
+  return finterp;
+}
+
+
 double
 MonotCubicInterpolator::
 evaluate(double x) const {
@@ -186,50 +261,61 @@ evaluate(double x) const {
   if (std::isnan(x) || std::isinf(x)) {
     throw("MonotCubicInterpolator: evaluate() received inf/nan input.");
   }
-
-  // xf becomes the first (xdata,fdata) pair where xdata >= x
-  map<double,double>::const_iterator xf_iterator = data.lower_bound(x);
+  if (xdata.empty()) {
+    throw("MonotCubicInterpolator: evaluate() called without data.");
+  }
 
   // First check if we must extrapolate:
-  if (xf_iterator == data.begin()) {
-    if (data.begin()->first == x) { // Just on the interval limit
-      return data.begin()->second;
-    }
-    else {
-      // Constant extrapolation (!!)
-      return data.begin()->second;
-    }
+  if (x <= xdata.front()) {
+    // Constant extrapolation (!!)
+    return fdata.front();
   }
-  if (xf_iterator == data.end()) {
-      // Constant extrapolation (!!)
-      return data.rbegin()->second;
+  if (x >= xdata.back()) {
+    // Constant extrapolation (!!)
+    return fdata.back();
   }
 
-
   // Ok, we have x_min < x < x_max
+  return evaluateInterval(findInterval(x), x);
+}
 
-  pair<double,double> xf2 = *xf_iterator;
-  pair<double,double> xf1 = *(--xf_iterator);
-  // we now have: xf2.first > x
 
-  // Linear interpolation if derivative data is not available:
-  if (ddata.size() != data.size()) {
-    double finterp =  xf1.second +
-      (xf2.second - xf1.second) / (xf2.first - xf1.first)
-      * (x - xf1.first);
-    return finterp;
-  }
-  else { // Do Cubic Hermite spline
-    double t = (x - xf1.first)/(xf2.first - xf1.first); // t \in [0,1]
-    double h = xf2.first - xf1.first;
-    double finterp
-      = xf1.second       * H00(t)
-      + ddata[xf1.first] * H10(t) * h
-      + xf2.second       * H01(t)
-      + ddata[xf2.first] * H11(t) * h ;
-    return finterp;
+void
+MonotCubicInterpolator::
+evaluate(const double* x, double* f, int num) const {
+
+  if (xdata.empty()) {
+    throw("MonotCubicInterpolator: evaluate() called without data.");
   }
 
+  const double xmin = xdata.front();
+  const double xmax = xdata.back();
+  const int last = xdata.size() - 1;
+
+  // Interval of the previous interior x value, tried first.
+  int i = 0;
+  for (int k = 0; k < num; ++k) {
+    const double xk = x[k];
+    if (std::isnan(xk) || std::isinf(xk)) {
+      throw("MonotCubicInterpolator: evaluate() received inf/nan input.");
+    }
+    if (xk <= xmin) {
+      f[k] = fdata.front();
+      continue;
+    }
+    if (xk >= xmax) {
+      f[k] = fdata.back();
+      continue;
+    }
+    if (xk < xdata[i] || xk >= xdata[i + 1]) {
+      if (i + 2 <= last && xk >= xdata[i + 1] && xk < xdata[i + 2]) {
+        ++i;
+      } else {
+        i = findInterval(xk);
+      }
+    }
+    f[k] = evaluateInterval(i, xk);
+  }
 }
 
 
@@ -245,14 +331,7 @@ vector<double>
 MonotCubicInterpolator::
 get_xVector() const
 {
-  map<double,double>::const_iterator xf_iterator = data.begin();
-
-  vector<double> outputvector;
-  outputvector.reserve(data.size());
-  for (xf_iterator = data.begin(); xf_iterator != data.end(); ++xf_iterator) {
-    outputvector.push_back(xf_iterator->first);
-  }
-  return outputvector;
+  return xdata;
 }
 
 
@@ -260,15 +339,7 @@ vector<double>
 MonotCubicInterpolator::
 get_fVector() const
 {
-
-  map<double,double>::const_iterator xf_iterator = data.begin();
-
-  vector<double> outputvector;
-  outputvector.reserve(data.size());
-  for (xf_iterator = data.begin(); xf_iterator != data.end(); ++xf_iterator) {
-    outputvector.push_back(xf_iterator->second);
-  }
-  return outputvector;
+  return fdata;
 }
 
 
@@ -280,19 +351,17 @@ toString() const
   const int precision = 20;
   std::string dataString;
   std::stringstream dataStringStream;
-  for (map<double,double>::const_iterator it = data.begin();
-       it != data.end(); ++it) {
-      dataStringStream << setprecision(precision) << it->first;
+  for (vector<double>::size_type i = 0; i < xdata.size(); ++i) {
+    dataStringStream << setprecision(precision) << xdata[i];
     dataStringStream << '\t';
-    dataStringStream << setprecision(precision) << it->second;
+    dataStringStream << setprecision(precision) << fdata[i];
     dataStringStream << '\n';
   }
   dataStringStream << "Derivative values:" << endl;
-  for (map<double,double>::const_iterator it = ddata.begin();
-       it != ddata.end(); ++it) {
-    dataStringStream << setprecision(precision) << it->first;
+  for (vector<double>::size_type i = 0; i < ddata.size(); ++i) {
+    dataStringStream << setprecision(precision) << xdata[i];
     dataStringStream << '\t';
-    dataStringStream << setprecision(precision) << it->second;
+    dataStringStream << setprecision(precision) << ddata[i];
     dataStringStream << '\n';
   }
 
@@ -305,30 +374,24 @@ pair<double,double>
 MonotCubicInterpolator::
 getMissingX() const
 {
-  if( data.size() < 2) {
+  if( xdata.size() < 2) {
     throw("MonotCubicInterpolator::getMissingX() only one datapoint.");
   }
 
   // Search for biggest difference value in function-datavalues:
 
-  map<double,double>::const_iterator  maxfDiffPair_iterator = data.begin();;
+  vector<double>::size_type maxfDiffIndex = 0;
   double maxfDiffValue = 0;
 
-  map<double,double>::const_iterator xf_iterator;
-  map<double,double>::const_iterator xf_next_iterator;
-
-  for (xf_iterator = data.begin(), xf_next_iterator = ++(data.begin());
-       xf_next_iterator != data.end();
-       ++xf_iterator, ++xf_next_iterator) {
-    double absfDiff = fabs((double)(*xf_next_iterator).second
-                           - (double)(*xf_iterator).second);
+  for (vector<double>::size_type i = 0; i + 1 < xdata.size(); ++i) {
+    double absfDiff = fabs(fdata[i + 1] - fdata[i]);
     if (absfDiff > maxfDiffValue) {
-      maxfDiffPair_iterator = xf_iterator;
+      maxfDiffIndex = i;
       maxfDiffValue = absfDiff;
     }
   }
 
-  double newXvalue = ((*maxfDiffPair_iterator).first + ((*(++maxfDiffPair_iterator)).first))/2;
+  double newXvalue = (xdata[maxfDiffIndex] + xdata[maxfDiffIndex + 1])/2;
   return make_pair(newXvalue, maxfDiffValue);
 
 }
@@ -338,19 +401,18 @@ getMissingX() const
 pair<double,double>
 MonotCubicInterpolator::
 getMaximumF() const {
-  if (data.size() <= 1) {
+  if (xdata.size() <= 1) {
     throw ("MonotCubicInterpolator::getMaximumF() empty data.") ;
   }
   if (strictlyIncreasing)
-    return *data.rbegin();
+    return getMaximumX();
   else if (strictlyDecreasing)
-    return *data.begin();
+    return getMinimumX();
   else {
-    pair<double,double> maxf = *data.rbegin() ;
-    map<double,double>::const_iterator xf_iterator;
-    for (xf_iterator = data.begin() ; xf_iterator != data.end(); ++xf_iterator) {
-      if (xf_iterator->second > maxf.second) {
-        maxf = *xf_iterator ;
+    pair<double,double> maxf = getMaximumX() ;
+    for (vector<double>::size_type i = 0; i < xdata.size(); ++i) {
+      if (fdata[i] > maxf.second) {
+        maxf = make_pair(xdata[i], fdata[i]) ;
       } ;
     }
     return maxf ;
@@ -361,20 +423,19 @@ getMaximumF() const {
 pair<double,double>
 MonotCubicInterpolator::
 getMinimumF() const {
-  if (data.size() <= 1) {
+  if (xdata.size() <= 1) {
     throw ("MonotCubicInterpolator::getMinimumF() empty data.") ;
   }
   if (strictlyIncreasing)
-    return *data.begin();
+    return getMinimumX();
   else if (strictlyDecreasing) {
-    return *data.rbegin();
+    return getMaximumX();
   }
   else {
-    pair<double,double> minf = *data.rbegin() ;
-    map<double,double>::const_iterator xf_iterator;
-    for (xf_iterator = data.begin() ; xf_iterator != data.end(); ++xf_iterator) {
-      if (xf_iterator->second < minf.second) {
-        minf = *xf_iterator ;
+    pair<double,double> minf = getMaximumX() ;
+    for (vector<double>::size_type i = 0; i < xdata.size(); ++i) {
+      if (fdata[i] < minf.second) {
+        minf = make_pair(xdata[i], fdata[i]) ;
       } ;
     }
     return minf ;
@@ -384,24 +445,12 @@ getMinimumF() const {
 
 void
 MonotCubicInterpolator::
-computeInternalFunctionData() const {
-
-  /* The contents of this function is meaningless if there is only one datapoint */
-  if (data.size() <= 1) {
-    return;
-  }
-
-  /* We do not check the caching flag if we are instructed
-     to do this computation */
+computeInternalFunctionData() {
 
   /* We compute monotoneness and directions by assuming
      monotoneness, and setting to false if the function is not for
      some value */
 
-  map<double,double>::const_iterator xf_iterator;
-  map<double,double>::const_iterator xf_next_iterator;
-
-
   strictlyMonotone = true; // We assume this is true, and will set to false if not
   monotone = true;
   strictlyDecreasing = true;
@@ -409,57 +458,63 @@ computeInternalFunctionData() const {
   strictlyIncreasing = true;
   increasing = true;
 
+  /* Derivatives are meaningless if there is only one datapoint */
+  ddata.clear();
+  const vector<double>::size_type n = xdata.size();
+  if (n <= 1) {
+    strictlyMonotone = false;
+    strictlyDecreasing = false;
+    strictlyIncreasing = false;
+    return;
+  }
+
   // Increasing or decreasing??
-  xf_iterator = data.begin();
-  xf_next_iterator = ++(data.begin());
+  vector<double>::size_type i = 0;
   /* Cater for non-strictness, search for direction for monotoneness */
-  while (xf_next_iterator != data.end() &&
-         xf_iterator->second == xf_next_iterator->second) {
+  while (i + 1 < n && fdata[i] == fdata[i + 1]) {
     /* Ok, equal values, this is not strict. */
     strictlyMonotone = false;
     strictlyIncreasing = false;
     strictlyDecreasing = false;
-
-    ++xf_iterator;
-    ++xf_next_iterator;
+    ++i;
   }
 
 
-  if (xf_next_iterator != data.end()) {
+  if (i + 1 < n) {
 
-    if ( xf_iterator->second > xf_next_iterator->second) {
+    if (fdata[i] > fdata[i + 1]) {
       // Ok, decreasing, check monotoneness:
       strictlyDecreasing = true;// if strictlyMonotone == false, this one should not be trusted anyway
       decreasing = true;
       strictlyIncreasing = false;
       increasing = false;
-      while(++xf_iterator, ++xf_next_iterator != data.end()) {
-        if ((*xf_iterator).second <  (*xf_next_iterator).second) {
+      while (++i + 1 < n) {
+        if (fdata[i] <  fdata[i + 1]) {
           monotone = false;
           strictlyMonotone = false;
           strictlyDecreasing = false; // meaningless now
           break; // out of while loop
         }
-        if ((*xf_iterator).second <= (*xf_next_iterator).second) {
+        if (fdata[i] <= fdata[i + 1]) {
           strictlyMonotone = false;
           strictlyDecreasing = false; // meaningless now
         }
       }
     }
-    else if (xf_iterator->second < xf_next_iterator->second) {
+    else if (fdata[i] < fdata[i + 1]) {
       // Ok, assume increasing, check monotoneness:
       strictlyDecreasing = false;
       strictlyIncreasing = true;
       decreasing = false;
       increasing = true;
-      while(++xf_iterator, ++xf_next_iterator != data.end()) {
-        if ((*xf_iterator).second >  (*xf_next_iterator).second) {
+      while (++i + 1 < n) {
+        if (fdata[i] >  fdata[i + 1]) {
           monotone = false;
           strictlyMonotone = false;
           strictlyIncreasing = false; // meaningless now
           break; // out of while loop
         }
-        if ((*xf_iterator).second >= (*xf_next_iterator).second) {
+        if (fdata[i] >= fdata[i + 1]) {
           strictlyMonotone = false;
           strictlyIncreasing = false; // meaningless now
         }
@@ -485,9 +540,6 @@ computeInternalFunctionData() const {
   if (monotone) {
     adjustDerivativesForMonotoneness();
   }
-
-  strictlyMonotoneCached = true;
-  monotoneCached = true;
 }
 
 //       Checks if the function curve is flat (zero derivative) at the
@@ -515,36 +567,26 @@ chopFlatEndpoints(const double epsilon) {
         return;
     }
 
-    map<double,double>::iterator xf_iterator;
-    map<double,double>::iterator xf_next_iterator;
-
-    // Clear flags:
-    strictlyMonotoneCached = false;
-    monotoneCached = false;
-
-    // Chop left end:
-    xf_iterator = data.begin();
-    xf_next_iterator = ++(data.begin());
-    // Erase data points that are similar to its right value from the left end.
-    while ((xf_next_iterator != data.end()) &&
-           (fabs(xf_iterator->second - xf_next_iterator->second) < epsilon )) {
-        xf_next_iterator++;
-        data.erase(xf_iterator);
-	xf_iterator++;
+    // Skip data points that are similar to their right value from the left end.
+    vector<double>::size_type first = 0;
+    while ((first + 1 < xdata.size()) &&
+           (fabs(fdata[first] - fdata[first + 1]) < epsilon )) {
+        ++first;
     }
 
-    xf_iterator = data.end();
-    xf_iterator--;   // (data.end() points beyond the last element)
-    xf_next_iterator = xf_iterator;
-    xf_next_iterator--;
-    // Erase data points that are similar to its left value from the right end.
-    while ((xf_next_iterator != data.begin()) &&
-           (fabs(xf_iterator->second - xf_next_iterator->second) < epsilon )) {
-        xf_next_iterator--;
-        data.erase(xf_iterator);
-	xf_iterator--;
+    // Skip data points that are similar to their left value from
+    // the right end, leaving at least two data points.
+    vector<double>::size_type last = xdata.size() - 1;
+    while ((last > first + 1) &&
+           (fabs(fdata[last] - fdata[last - 1]) < epsilon )) {
+        --last;
     }
 
+    xdata.erase(xdata.begin() + last + 1, xdata.end());
+    fdata.erase(fdata.begin() + last + 1, fdata.end());
+    xdata.erase(xdata.begin(), xdata.begin() + first);
+    fdata.erase(fdata.begin(), fdata.begin() + first);
+
     // Finished chopping, so recompute function data:
     computeInternalFunctionData();
 }
@@ -573,10 +615,6 @@ shrinkFlatAreas(const double epsilon) {
         return;
     }
 
-    map<double,double>::iterator xf_iterator;
-    map<double,double>::iterator xf_next_iterator;
-
-
     // Nothing to do if we already are strictly monotone
     if (isStrictlyMonotone()) {
         return;
@@ -587,86 +625,51 @@ shrinkFlatAreas(const double epsilon) {
         return;
     }
 
-    // Clear flags, they are not to be trusted after we modify the
-    // data
-    strictlyMonotoneCached = false;
-    monotoneCached = false;
-
     // Iterate through data values, if two data pairs
     // have equal values, delete one of the data pair.
     // Do not trust the source code on which data point is being
     // removed (x-values of equal y-points might be averaged in the future)
-    xf_iterator = data.begin();
-    xf_next_iterator = ++(data.begin());
-
-    while (xf_next_iterator != data.end()) {
-        //cout << xf_iterator->first << "," << xf_iterator->second << " " << xf_next_iterator->first << "," << xf_next_iterator->second << "\n";
-        if (fabs(xf_iterator->second - xf_next_iterator->second) < epsilon ) {
-            //cout << "erasing data pair" << xf_next_iterator->first << " " << xf_next_iterator->second << "\n";
-            map <double,double>::iterator xf_tobedeleted_iterator = xf_next_iterator;
-            xf_next_iterator++;
-            data.erase(xf_tobedeleted_iterator);
-        }
-        else {
-            xf_iterator++;
-            xf_next_iterator++;
+    vector<double>::size_type kept = 0;
+    for (vector<double>::size_type i = 1; i < xdata.size(); ++i) {
+        if (fabs(fdata[kept] - fdata[i]) >= epsilon ) {
+            ++kept;
+            xdata[kept] = xdata[i];
+            fdata[kept] = fdata[i];
         }
     }
+    xdata.resize(kept + 1);
+    fdata.resize(kept + 1);
 
+    computeInternalFunctionData();
 }
 
 
 void
 MonotCubicInterpolator::
-computeSimpleDerivatives() const {
-
-  ddata.clear();
+computeSimpleDerivatives() {
 
-  // Do endpoints first:
-  map<double,double>::const_iterator xf_prev_iterator;
-  map<double,double>::const_iterator xf_iterator;
-  map<double,double>::const_iterator xf_next_iterator;
-  double diff;
+  const vector<double>::size_type n = xdata.size();
+  ddata.resize(n);
 
   // Leftmost interval:
-  xf_iterator = data.begin();
-  xf_next_iterator = ++(data.begin());
-  diff =
-    (xf_next_iterator->second - xf_iterator->second) /
-    (xf_next_iterator->first  - xf_iterator->first);
-  ddata[xf_iterator->first] = diff ;
+  ddata[0] = (fdata[1] - fdata[0]) / (xdata[1] - xdata[0]);
 
   // Rightmost interval:
-  xf_iterator = --(--(data.end()));
-  xf_next_iterator = --(data.end());
-  diff =
-    (xf_next_iterator->second - xf_iterator->second) /
-    (xf_next_iterator->first  - xf_iterator->first);
-  ddata[xf_next_iterator->first] = diff ;
+  ddata[n - 1] = (fdata[n - 1] - fdata[n - 2]) / (xdata[n - 1] - xdata[n - 2]);
 
   // If we have more than two intervals, loop over internal points:
-  if (data.size() > 2) {
-
-    map<double,double>::const_iterator intpoint;
-    for (intpoint = ++data.begin(); intpoint != --data.end(); ++intpoint) {
-      /*
-        diff = (f2 - f1)/(x2-x1)/w + (f3-f1)/(x3-x2)/2
-
-        average of the forward and backward difference.
-        Weights are equal, should we weigh with h_i?
-      */
-
-      map<double,double>::const_iterator lastpoint = intpoint; --lastpoint;
-      map<double,double>::const_iterator nextpoint = intpoint; ++nextpoint;
-
-      diff = (nextpoint->second - intpoint->second)/
-        (2*(nextpoint->first - intpoint->first))
-        +
-        (intpoint->second - lastpoint->second) /
-        (2*(intpoint->first - lastpoint->first));
-
-      ddata[intpoint->first] = diff ;
-    }
+  for (vector<double>::size_type i = 1; i + 1 < n; ++i) {
+    /*
+      diff = (f2 - f1)/(x2-x1)/w + (f3-f1)/(x3-x2)/2
+
+      average of the forward and backward difference.
+      Weights are equal, should we weigh with h_i?
+    */
+    ddata[i] = (fdata[i + 1] - fdata[i])/
+      (2*(xdata[i + 1] - xdata[i]))
+      +
+      (fdata[i] - fdata[i - 1]) /
+      (2*(xdata[i] - xdata[i - 1]));
   }
 }
 
@@ -674,40 +677,29 @@ computeSimpleDerivatives() const {
 
 void
 MonotCubicInterpolator::
-adjustDerivativesForMonotoneness() const {
-  map<double,double>::const_iterator point, dpoint;
+adjustDerivativesForMonotoneness() {
 
   /* Loop over all intervals, ie. loop over all points and look
      at the interval to the right of the point */
-  for (point = data.begin(), dpoint = ddata.begin();
-       point != --data.end();
-       ++point, ++dpoint) {
-    map<double,double>::const_iterator nextpoint, nextdpoint;
-    nextpoint = point; ++nextpoint;
-    nextdpoint = dpoint; ++nextdpoint;
-
+  for (vector<double>::size_type i = 0; i + 1 < xdata.size(); ++i) {
     double delta =
-      (nextpoint->second - point->second) /
-      (nextpoint->first  - point->first);
+      (fdata[i + 1] - fdata[i]) /
+      (xdata[i + 1] - xdata[i]);
     if (fabs(delta) < 1e-14) {
-      ddata[point->first] = 0.0;
-      ddata[nextpoint->first] = 0.0;
+      ddata[i] = 0.0;
+      ddata[i + 1] = 0.0;
     } else {
-      double alpha = ddata[point->first] / delta;
-      double beta = ddata[nextpoint->first] / delta;
+      double alpha = ddata[i] / delta;
+      double beta = ddata[i + 1] / delta;
 
       if (! isMonotoneCoeff(alpha, beta)) {
         double tau = 3/sqrt(alpha*alpha + beta*beta);
 
-        ddata[point->first]     = tau*alpha*delta;
-        ddata[nextpoint->first] = tau*beta*delta;
+        ddata[i]     = tau*alpha*delta;
+        ddata[i + 1] = tau*beta*delta;
       }
     }
-
-
   }
-
-
 }
 
 
@@ -716,17 +708,11 @@ adjustDerivativesForMonotoneness() const {
 void
 MonotCubicInterpolator::
 scaleData(double factor) {
-  map<double,double>::iterator it , itd  ;
-  if (data.size() == ddata.size()) {
-    for (it = data.begin() , itd = ddata.begin() ; it != data.end() ; ++it , ++itd) {
-      it->second  *= factor ;
-      itd->second *= factor ;
-    } ;
-  } else {
-    for (it = data.begin() ; it != data.end() ; ++it ) {
-      it->second  *= factor ;
-    }
+  for (vector<double>::size_type i = 0; i < fdata.size(); ++i) {
+    fdata[i] *= factor ;
   }
+  // A negative factor changes the direction of monotonicity.
+  computeInternalFunctionData();
 }
 
 
@@ -4,8 +4,8 @@
 #define _MONOTCUBICINTERPOLATOR_H
 
 #include <vector>
-#include <map>
 #include <string>
+#include <utility>
 
 /*
   MonotCubicInterpolator
@@ -53,6 +53,12 @@ namespace Opm
    Algorithm also described here:
    http://en.wikipedia.org/wiki/Monotone_cubic_interpolation
 
+   The data points and derivatives are kept in sorted contiguous
+   arrays, and everything derived from them is recomputed whenever
+   the data is modified. Hence the const member functions do not
+   modify the object, and may be called concurrently from several
+   threads.
+
 
    @author Håvard Berland <havb (at) statoil.com>, December 2006
    @brief Represents one dimensional function f with single valued argument x that can be interpolated using monotone cubic interpolation
@@ -147,7 +153,10 @@ class MonotCubicInterpolator {
       This object must be treated with care until
       populated.
    */
-   MonotCubicInterpolator() { }
+   MonotCubicInterpolator()
+   {
+       computeInternalFunctionData();
+   }
 
 
 
@@ -206,6 +215,17 @@ class MonotCubicInterpolator {
    */
    double evaluate(double x) const;
 
+   /**
+      @param x Array of x values
+      @param f Array of num function values, output
+      @param num Number of values to evaluate
+
+      Computes f[i] = evaluate(x[i]) for all i. Consecutive x values
+      in the same or the next interval are found without searching,
+      so evaluating sorted (increasing) x values is particularly fast.
+   */
+   void evaluate(const double* x, double* f, int num) const;
+
    /**
       @param x x value
       @param errorestimate_output
@@ -235,7 +255,7 @@ class MonotCubicInterpolator {
    */
    std::pair<double,double> getMinimumX() const {
        // Easy since the data is sorted on x:
-       return *data.begin();
+       return std::make_pair(xdata.front(), fdata.front());
    }
 
    /**
@@ -246,7 +266,7 @@ class MonotCubicInterpolator {
    */
    std::pair<double,double> getMaximumX() const {
        // Easy since the data is sorted on x:
-       return *data.rbegin();
+       return std::make_pair(xdata.back(), fdata.back());
    }
 
    /**
@@ -269,16 +289,16 @@ class MonotCubicInterpolator {
    /**
       Provide a copy of the x-data as a vector
 
-      Unspecified order, but corresponds to get_fVector.
+      Increasing order, corresponds to get_fVector.
 
       @return x values as a vector
    */
    std::vector<double> get_xVector() const ;
 
    /**
-      Provide a copy of tghe function data as a vector
+      Provide a copy of the function data as a vector
 
-      Unspecified order, but corresponds to get_xVector
+      Corresponds to get_xVector
 
       @return f values as a vector
 
@@ -299,16 +319,8 @@ class MonotCubicInterpolator {
 
       @return True if f(x) is strictly monotone, else False
    */
-   bool isStrictlyMonotone() {
-
-       /* Use cached value if it can be trusted */
-       if (strictlyMonotoneCached) {
-           return strictlyMonotone;
-       }
-       else {
-           computeInternalFunctionData();
-           return strictlyMonotone;
-       }
+   bool isStrictlyMonotone() const {
+       return strictlyMonotone;
    }
 
    /**
@@ -317,13 +329,7 @@ class MonotCubicInterpolator {
       @return True if f(x) is monotone, else False
    */
    bool isMonotone() const {
-       if (monotoneCached) {
-           return monotone;
-       }
-       else {
-           computeInternalFunctionData();
-           return monotone;
-       }
+       return monotone;
    }
    /**
       Determines if the current function-value-data is strictly
@@ -332,16 +338,8 @@ class MonotCubicInterpolator {
 
       @return True if f(x) is strictly increasing, else False
    */
-   bool isStrictlyIncreasing() {
-
-       /* Use cached value if it can be trusted */
-       if (strictlyMonotoneCached) {
-           return (strictlyMonotone && strictlyIncreasing);
-       }
-       else {
-           computeInternalFunctionData();
-           return (strictlyMonotone && strictlyIncreasing);
-       }
+   bool isStrictlyIncreasing() const {
+       return (strictlyMonotone && strictlyIncreasing);
    }
 
    /**
@@ -350,13 +348,7 @@ class MonotCubicInterpolator {
       @return True if f(x) is monotone and increasing, else False
    */
    bool isMonotoneIncreasing() const {
-       if (monotoneCached) {
-           return (monotone && increasing);
-       }
-       else {
-           computeInternalFunctionData();
-           return (monotone && increasing);
-       }
+       return (monotone && increasing);
    }
    /**
       Determines if the current function-value-data is strictly
@@ -365,16 +357,8 @@ class MonotCubicInterpolator {
 
       @return True if f(x) is strictly decreasing, else False
    */
-   bool isStrictlyDecreasing() {
-
-       /* Use cached value if it can be trusted */
-       if (strictlyMonotoneCached) {
-           return (strictlyMonotone && strictlyDecreasing);
-       }
-       else {
-           computeInternalFunctionData();
-           return (strictlyMonotone && strictlyDecreasing);
-       }
+   bool isStrictlyDecreasing() const {
+       return (strictlyMonotone && strictlyDecreasing);
    }
 
    /**
@@ -383,13 +367,7 @@ class MonotCubicInterpolator {
       @return True if f(x) is monotone and decreasing, else False
    */
    bool isMonotoneDecreasing() const {
-       if (monotoneCached) {
-           return (monotone && decreasing);
-       }
-       else {
-           computeInternalFunctionData();
-           return (monotone && decreasing);
-       }
+       return (monotone && decreasing);
    }
 
 
@@ -434,7 +412,7 @@ class MonotCubicInterpolator {
      @return Number of datapoint pairs in this object
    */
    int getSize() const {
-       return data.size();
+       return xdata.size();
    }
 
     /**
@@ -494,29 +472,23 @@ class MonotCubicInterpolator {
 
 private:
 
-   // Data structure to store x- and f-values
-   std::map<double, double> data;
+   // Data points sorted on x, without duplicate x-values.
+   std::vector<double> xdata;
+   std::vector<double> fdata;
 
-   // Data structure to store x- and d-values
-   mutable std::map<double, double> ddata;
+   // Derivatives in the Hermite interpolation, one per data point.
+   // Empty if there are less than two data points.
+   std::vector<double> ddata;
 
+   // Monotonicity of the data, computed along with the derivatives.
+   bool strictlyMonotone;
+   bool monotone; /* only monotone, not stricly montone */
 
-   // Storage containers for precomputed interpolation data
-   //   std::vector<double> dvalues; // derivatives in Hermite interpolation.
-
-   // Flag to determine whether the boolean strictlyMonotone can be
-   // trusted.
-   mutable bool strictlyMonotoneCached;
-   mutable bool monotoneCached; /* only monotone, not stricly montone */
-
-   mutable bool strictlyMonotone;
-   mutable bool monotone;
-
-   // if strictlyMonotone is true (and can be trusted), the two next are meaningful
-   mutable bool strictlyDecreasing;
-   mutable bool strictlyIncreasing;
-   mutable bool decreasing;
-   mutable bool increasing;
+   // if strictlyMonotone is true, the two next are meaningful
+   bool strictlyDecreasing;
+   bool strictlyIncreasing;
+   bool decreasing;
+   bool increasing;
 
 
    /* Hermite basis functions, t \in [0,1] ,
@@ -538,16 +510,33 @@ private:
    }
 
 
-   void computeInternalFunctionData() const ;
+   /**
+       Replaces the data by the given pairs, which need not be sorted.
+       If an x-value occurs more than once, the last pair wins.
+   */
+   void setData(std::vector<std::pair<double, double> >& xf);
+
+   /**
+       Index i of the interval such that xdata[i] <= x < xdata[i+1].
+       Requires xdata.front() <= x < xdata.back().
+   */
+   int findInterval(double x) const;
+
+   /**
+       Hermite interpolation in the interval starting at xdata[i].
+   */
+   double evaluateInterval(int i, double x) const;
+
+   void computeInternalFunctionData();
 
    /**
        Computes initial derivative values using centered (second order) difference
        for internal datapoints, and one-sided derivative for endpoints
 
-       The internal datastructure map<double,double> ddata is populated by this method.
+       The internal array ddata is populated by this method.
    */
 
-   void computeSimpleDerivatives() const ;
+   void computeSimpleDerivatives();
 
 
    /**
@@ -556,7 +545,7 @@ private:
       done according to the algorithm of Fritsch and Carlsson 1980,
       see Section 4, especially the two last lines.
    */
-  void adjustDerivativesForMonotoneness() const ;
+  void adjustDerivativesForMonotoneness();
 
    /**
        Checks if the coefficient alpha and beta is in
@@ -21,6 +21,7 @@
 #ifndef OPM_NONUNIFORMTABLELINEAR_HEADER_INCLUDED
 #define OPM_NONUNIFORMTABLELINEAR_HEADER_INCLUDED
 
+#include <algorithm>
 #include <cmath>
 #include <exception>
 #include <vector>
@@ -39,6 +40,11 @@ namespace Opm
     ///        (and its derivative) of a function f sampled at possibly
     ///         nonuniform points. If values outside the domain are sought,
     ///         values will be extrapolated linearly.
+    ///
+    ///        The table is not modified by the const member functions,
+    ///        which may therefore be called concurrently. Lookups that
+    ///        walk monotonically through the table may pass a
+    ///        TableCursor to avoid searching.
     /// @tparam T the range type of the function (should be an algebraic ring type)
     template<typename T>
     class NonuniformTableLinear
@@ -77,6 +83,27 @@ namespace Opm
         /// @return f'(x)
         double derivative(const double x) const;
 
+        /// @brief Evaluate the value at x, starting the lookup from
+        ///        the interval of the previous lookup with the cursor.
+        /// @param x a domain value
+        /// @param cursor updated to the interval containing x
+        /// @return f(x)
+        double operator()(const double x, TableCursor& cursor) const;
+
+        /// @brief Evaluate the derivative at x, starting the lookup
+        ///        from the interval of the previous lookup with the cursor.
+        /// @param x a domain value
+        /// @param cursor updated to the interval containing x
+        /// @return f'(x)
+        double derivative(const double x, TableCursor& cursor) const;
+
+        /// @brief Evaluate values and derivatives at several points.
+        /// @param n number of points
+        /// @param x n domain values
+        /// @param[out] y n values f(x[i])
+        /// @param[out] dydx if non-null, n derivatives f'(x[i])
+        void evaluate(const int n, const double* x, double* y, double* dydx) const;
+
         /// @brief Evaluate the inverse at y. Requires T to be a double.
         /// @param y a range value
         /// @return f^{-1}(y)
@@ -90,8 +117,13 @@ namespace Opm
     protected:
         std::vector<double> x_values_;
         std::vector<T> y_values_;
-        mutable std::vector<T> x_values_reversed_;
-        mutable std::vector<T> y_values_reversed_;
+        // Reversed copies of the above, used by inverse() when the
+        // values are decreasing.
+        std::vector<double> x_values_reversed_;
+        std::vector<T> y_values_reversed_;
+
+    private:
+        void setupReversed();
     };
 
 
@@ -138,6 +170,7 @@ namespace Opm
           y_values_( y_column.begin() , y_column.end())
     {
         assert(isNondecreasing(x_values_.begin(), x_values_.end()));
+        setupReversed();
     }
 
 
@@ -150,6 +183,7 @@ namespace Opm
           y_values_(y_values)
     {
         assert(isNondecreasing(x_values_.begin(), x_values_.end()));
+        setupReversed();
     }
 
 
@@ -162,6 +196,16 @@ namespace Opm
         : x_values_(x_values), y_values_(y_values)
     {
         assert(isNondecreasing(x_values.begin(), x_values.end()));
+        setupReversed();
+    }
+
+    template<typename T>
+    inline void
+    NonuniformTableLinear<T>
+    ::setupReversed()
+    {
+        x_values_reversed_.assign(x_values_.rbegin(), x_values_.rend());
+        y_values_reversed_.assign(y_values_.rbegin(), y_values_.rend());
     }
 
     template<typename T>
@@ -185,6 +229,7 @@ namespace Opm
         for (int i = 0; i < int(x_values_.size()); ++i) {
             x_values_[i] = (x_values_[i] - a)*(d - c)/(b - a) + c;
         }
+        setupReversed();
     }
 
     template<typename T>
@@ -203,6 +248,30 @@ namespace Opm
         return Opm::linearInterpolationDerivative(x_values_, y_values_, x);
     }
 
+    template<typename T>
+    inline double
+    NonuniformTableLinear<T>
+    ::operator()(const double x, TableCursor& cursor) const
+    {
+        return Opm::linearInterpolation(x_values_, y_values_, x, cursor);
+    }
+
+    template<typename T>
+    inline double
+    NonuniformTableLinear<T>
+    ::derivative(const double x, TableCursor& cursor) const
+    {
+        return Opm::linearInterpolationDerivative(x_values_, y_values_, x, cursor);
+    }
+
+    template<typename T>
+    inline void
+    NonuniformTableLinear<T>
+    ::evaluate(const int n, const double* x, double* y, double* dydx) const
+    {
+        Opm::linearInterpolation(x_values_, y_values_, n, x, y, dydx);
+    }
+
     template<typename T>
     inline double
     NonuniformTableLinear<T>
@@ -211,13 +280,7 @@ namespace Opm
         if (y_values_.front() < y_values_.back()) {
             return Opm::linearInterpolation(y_values_, x_values_, y);
         } else {
-            if (y_values_reversed_.empty()) {
-                y_values_reversed_ = y_values_;
-                std::reverse(y_values_reversed_.begin(), y_values_reversed_.end());
-                assert(isNondecreasing(y_values_reversed_.begin(), y_values_reversed_.end()));
-                x_values_reversed_ = x_values_;
-                std::reverse(x_values_reversed_.begin(), x_values_reversed_.end());
-            }
+            assert(isNondecreasing(y_values_reversed_.begin(), y_values_reversed_.end()));
             return Opm::linearInterpolation(y_values_reversed_, x_values_reversed_, y);
         }
     }
@@ -0,0 +1,317 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/utility/Profiler.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Opm
+{
+
+    // ----------------- ProfileNode -----------------
+
+    ProfileNode::ProfileNode(const std::string& node_name)
+        : name(node_name),
+          calls(0),
+          total_time(0.0),
+          min_time(std::numeric_limits<double>::max()),
+          max_time(0.0),
+          iterations(0),
+          allocations(0)
+    {
+    }
+
+
+
+    double ProfileNode::meanTime() const
+    {
+        return calls > 0 ? total_time/calls : 0.0;
+    }
+
+
+
+    ProfileNode& ProfileNode::child(const char* child_name)
+    {
+        for (ProfileNode& c : children) {
+            if (c.name == child_name) {
+                return c;
+            }
+        }
+        children.push_back(ProfileNode(child_name));
+        return children.back();
+    }
+
+
+
+    ProfileNode* ProfileNode::find(const std::string& node_name)
+    {
+        if (name == node_name) {
+            return this;
+        }
+        for (ProfileNode& c : children) {
+            ProfileNode* found = c.find(node_name);
+            if (found) {
+                return found;
+            }
+        }
+        return 0;
+    }
+
+
+
+    void ProfileNode::merge(const ProfileNode& other)
+    {
+        calls += other.calls;
+        total_time += other.total_time;
+        min_time = std::min(min_time, other.min_time);
+        max_time = std::max(max_time, other.max_time);
+        iterations += other.iterations;
+        allocations += other.allocations;
+        for (const ProfileNode& oc : other.children) {
+            child(oc.name.c_str()).merge(oc);
+        }
+    }
+
+
+
+    namespace
+    {
+        void printTree(const ProfileNode& node, const int depth, std::ostream& os)
+        {
+            for (const ProfileNode& c : node.children) {
+                const std::string label = std::string(2*depth, ' ') + c.name;
+                os << std::left << std::setw(40) << label << std::right
+                   << std::setw(10) << c.calls
+                   << std::setw(12) << c.total_time
+                   << std::setw(12) << c.meanTime()
+                   << std::setw(12) << (c.calls > 0 ? c.min_time : 0.0)
+                   << std::setw(12) << c.max_time
+                   << std::setw(12) << c.iterations
+                   << std::setw(12) << c.allocations << '\n';
+                printTree(c, depth + 1, os);
+            }
+        }
+
+        void writeJsonArray(const ProfileNode& node, const int depth, std::ostream& os)
+        {
+            const std::string indent(2*depth, ' ');
+            os << "[";
+            for (size_t i = 0; i < node.children.size(); ++i) {
+                const ProfileNode& c = node.children[i];
+                os << (i == 0 ? "\n" : ",\n") << indent << "  {"
+                   << " \"name\": \"" << c.name << "\","
+                   << " \"calls\": " << c.calls << ","
+                   << " \"total_time\": " << c.total_time << ","
+                   << " \"mean_time\": " << c.meanTime() << ","
+                   << " \"min_time\": " << (c.calls > 0 ? c.min_time : 0.0) << ","
+                   << " \"max_time\": " << c.max_time << ","
+                   << " \"iterations\": " << c.iterations << ","
+                   << " \"allocations\": " << c.allocations << ","
+                   << " \"children\": ";
+                writeJsonArray(c, depth + 1, os);
+                os << " }";
+            }
+            if (!node.children.empty()) {
+                os << "\n" << indent;
+            }
+            os << "]";
+        }
+    } // anonymous namespace
+
+
+
+    void ProfileNode::print(std::ostream& os) const
+    {
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision(4);
+        os << std::left << std::setw(40) << "Scope" << std::right
+           << std::setw(10) << "Calls"
+           << std::setw(12) << "Total (s)"
+           << std::setw(12) << "Mean (s)"
+           << std::setw(12) << "Min (s)"
+           << std::setw(12) << "Max (s)"
+           << std::setw(12) << "Iterations"
+           << std::setw(12) << "Allocs" << '\n';
+        printTree(*this, 0, os);
+        os.precision(precision);
+        os.flags(flags);
+    }
+
+
+
+    void ProfileNode::writeJson(std::ostream& os) const
+    {
+        const std::streamsize precision = os.precision(9);
+        writeJsonArray(*this, 0, os);
+        os << '\n';
+        os.precision(precision);
+    }
+
+
+
+
+    // ----------------- Profiler -----------------
+
+    Profiler& Profiler::instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+
+
+    Profiler::Profiler()
+        : enabled_(false)
+    {
+#ifdef _OPENMP
+        threads_.resize(omp_get_max_threads());
+#else
+        threads_.resize(1);
+#endif
+    }
+
+
+
+    void Profiler::setEnabled(const bool enabled)
+    {
+        enabled_ = enabled;
+    }
+
+
+
+    void Profiler::addIterations(const long count)
+    {
+        ThreadData* td = enabled_ ? threadData() : 0;
+        if (td && !td->stack.empty()) {
+            td->stack.back()->iterations += count;
+        }
+    }
+
+
+
+    void Profiler::addAllocations(const long count)
+    {
+        ThreadData* td = enabled_ ? threadData() : 0;
+        if (td && !td->stack.empty()) {
+            td->stack.back()->allocations += count;
+        }
+    }
+
+
+
+    ProfileNode Profiler::snapshot() const
+    {
+        // Worker trees mirror the master's path down to their scopes,
+        // so merging by name level by level matches full paths.
+        ProfileNode result = threads_[0].root;
+        for (size_t t = 1; t < threads_.size(); ++t) {
+            result.merge(threads_[t].root);
+        }
+        return result;
+    }
+
+
+
+    void Profiler::reset()
+    {
+        for (ThreadData& td : threads_) {
+            td.root = ProfileNode();
+            td.stack.clear();
+        }
+        serial_path_.clear();
+    }
+
+
+
+    // Data of the calling thread, null for threads beyond those
+    // available when the profiler was created.
+    Profiler::ThreadData* Profiler::threadData()
+    {
+#ifdef _OPENMP
+        const int thread = omp_get_thread_num();
+#else
+        const int thread = 0;
+#endif
+        return thread < int(threads_.size()) ? &threads_[thread] : 0;
+    }
+
+
+
+    // True for the master thread outside parallel regions.
+    bool Profiler::serialThread(const ThreadData* td) const
+    {
+#ifdef _OPENMP
+        return td == &threads_[0] && !omp_in_parallel();
+#else
+        return td == &threads_[0];
+#endif
+    }
+
+
+
+    ProfileNode* Profiler::enter(const char* name)
+    {
+        ThreadData* td = threadData();
+        if (!td) {
+            return 0;
+        }
+        ProfileNode* parent = td->stack.empty() ? &td->root : td->stack.back();
+        if (td->stack.empty() && td != &threads_[0]) {
+            // Outermost scope of a worker thread. The master thread
+            // does not change serial_path_ inside a parallel region.
+            for (const char* path_name : serial_path_) {
+                parent = &parent->child(path_name);
+            }
+        }
+        if (serialThread(td)) {
+            serial_path_.push_back(name);
+        }
+        ProfileNode* node = &parent->child(name);
+        td->stack.push_back(node);
+        return node;
+    }
+
+
+
+    void Profiler::leave(ProfileNode* node, const double seconds)
+    {
+        ThreadData* td = threadData();
+        if (!td || td->stack.empty() || td->stack.back() != node) {
+            // Scope was reset or entered on another thread.
+            return;
+        }
+        if (serialThread(td) && !serial_path_.empty()) {
+            serial_path_.pop_back();
+        }
+        td->stack.pop_back();
+        ++node->calls;
+        node->total_time += seconds;
+        node->min_time = std::min(node->min_time, seconds);
+        node->max_time = std::max(node->max_time, seconds);
+    }
+
+} // namespace Opm
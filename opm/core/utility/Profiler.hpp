@@ -0,0 +1,177 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PROFILER_HEADER_INCLUDED
+#define OPM_PROFILER_HEADER_INCLUDED
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Accumulated statistics of a named profiling scope, and of the
+    /// scopes nested inside it.
+    struct ProfileNode
+    {
+        explicit ProfileNode(const std::string& name = std::string());
+
+        std::string name;
+        long calls;
+        double total_time;    // Seconds, summed over all calls.
+        double min_time;
+        double max_time;
+        long iterations;
+        long allocations;
+        std::vector<ProfileNode> children;
+
+        /// Mean time per call, zero if never called.
+        double meanTime() const;
+
+        /// Child with the given name, created if missing.
+        ProfileNode& child(const char* child_name);
+
+        /// Depth-first search (this node included) for a node with
+        /// the given name. Returns null if not found.
+        ProfileNode* find(const std::string& node_name);
+
+        /// Add the statistics of 'other' to this node, merging
+        /// children with equal names.
+        void merge(const ProfileNode& other);
+
+        /// Print the children of this node as an indented tree.
+        void print(std::ostream& os) const;
+
+        /// Write the children of this node as a JSON array.
+        void writeJson(std::ostream& os) const;
+    };
+
+
+
+    /// Process-wide registry of nested timing scopes and counters.
+    ///
+    /// Scopes are entered and left through ProfileScope objects. Each
+    /// thread records into its own tree, so no locking is needed on
+    /// entry and exit. The outermost scope a worker thread enters in
+    /// a parallel region is recorded under the path of scopes the
+    /// master thread had entered before the region started. When a
+    /// snapshot is taken, the worker trees are merged into that of the
+    /// master thread along these paths, which attaches the work done
+    /// inside parallel loops to the scope that started them.
+    ///
+    /// The profiler is disabled by default, in which case entering a
+    /// scope costs one test of a flag.
+    class Profiler
+    {
+    public:
+        /// The process-wide instance.
+        static Profiler& instance();
+
+        void setEnabled(const bool enabled);
+        bool enabled() const
+        {
+            return enabled_;
+        }
+
+        /// Add to the iteration count of the innermost scope of the
+        /// calling thread.
+        void addIterations(const long count);
+
+        /// Add to the allocation count of the innermost scope of the
+        /// calling thread.
+        void addAllocations(const long count);
+
+        /// Merged statistics of all threads. The returned root node
+        /// is unnamed and its children are the top-level scopes.
+        /// Must not be called while scopes are active on other threads.
+        ProfileNode snapshot() const;
+
+        /// Clear all statistics. Must not be called while any scope
+        /// is active.
+        void reset();
+
+    private:
+        friend class ProfileScope;
+
+        struct ThreadData
+        {
+            ProfileNode root;
+            std::vector<ProfileNode*> stack;
+        };
+
+        Profiler();
+
+        ThreadData* threadData();
+        bool serialThread(const ThreadData* td) const;
+        ProfileNode* enter(const char* name);
+        void leave(ProfileNode* node, const double seconds);
+
+        bool enabled_;
+        std::vector<ThreadData> threads_;
+        // Scopes entered by the master thread outside parallel regions.
+        std::vector<const char*> serial_path_;
+    };
+
+
+
+    /// Times the enclosing block as a scope of the profiler.
+    ///
+    /// Usage:
+    /// \code
+    /// {
+    ///     ProfileScope scope("pressure_assemble");
+    ///     ...
+    /// }
+    /// \endcode
+    /// The name must outlive the scope object, normally it is a
+    /// string literal.
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name)
+            : node_(0)
+        {
+            Profiler& profiler = Profiler::instance();
+            if (profiler.enabled()) {
+                node_ = profiler.enter(name);
+                start_ = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~ProfileScope()
+        {
+            if (node_) {
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+                Profiler::instance().leave(node_, elapsed.count());
+            }
+        }
+
+    private:
+        ProfileScope(const ProfileScope&);
+        ProfileScope& operator=(const ProfileScope&);
+
+        ProfileNode* node_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_PROFILER_HEADER_INCLUDED
@@ -22,9 +22,17 @@
 
 #include <boost/range.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Opm
 {
 
@@ -33,6 +41,12 @@ namespace Opm
      * regions/partitions (e.g., the ECLIPSE-style 'SATNUM',
      * 'PVTNUM', or 'EQUILNUM' arrays).
      *
+     * When the region IDs are integers in a range no larger than
+     * the number of cells (or 1024), regions are looked up in a
+     * direct offset table, and the reverse mapping is built by a
+     * parallel counting sort.  Other region IDs are looked up in a
+     * hash table.
+     *
      * \tparam Region Type of a forward region mapping.  Expected
      *                to provide indexed access through
      *                operator[]() as well as inner types
@@ -84,6 +98,11 @@ namespace Opm
         RegionId
         region(const CellId c) const { return reg_[c]; }
 
+        /**
+         * Regions containing at least one cell.  In increasing order
+         * if the region IDs are in a small integer range.  Results of
+         * the per-region reductions below are ordered as this vector.
+         */
         const std::vector<RegionId>&
         activeRegions() const
         {
@@ -100,19 +119,92 @@ namespace Opm
          */
         Range
         cells(const RegionId r) const {
-            const auto id = rev_.binid.find(r);
+            typename Reverse::Pos i;
 
-            if (id == rev_.binid.end()) {
+            if (! rev_.bin(r, i)) {
                 // Region 'r' not an active region.  Return empty.
                 return Range(rev_.c.end(), rev_.c.end());
             }
 
-            const auto i = id->second;
-
             return Range(rev_.c.begin() + rev_.p[i + 0],
                          rev_.c.begin() + rev_.p[i + 1]);
         }
 
+        /**
+         * Sum of a cell field over each active region.
+         *
+         * \param[in] x Cell field, indexed by active cell.
+         *
+         * \return Region sums, ordered as activeRegions().
+         */
+        template <class Field>
+        std::vector<double>
+        sum(const Field& x) const
+        {
+            return reduce(0.0, [&x](const double s, const CellId c)
+                          { return s + x[c]; });
+        }
+
+        /**
+         * Weighted average of a cell field over each active region,
+         * e.g., the pore-volume weighted average pressure.
+         *
+         * \param[in] x Cell field, indexed by active cell.
+         *
+         * \param[in] w Cell weights, indexed by active cell.
+         *
+         * \return Region averages, ordered as activeRegions().  Zero
+         * for regions whose weights sum to zero.
+         */
+        template <class Field, class Weight>
+        std::vector<double>
+        weightedAverage(const Field& x, const Weight& w) const
+        {
+            std::vector<double> avg =
+                reduce(0.0, [&x, &w](const double s, const CellId c)
+                       { return s + w[c]*x[c]; });
+
+            const std::vector<double> wsum = sum(w);
+
+            for (decltype(avg.size()) i = 0, n = avg.size(); i < n; ++i) {
+                avg[i] = (wsum[i] != 0.0) ? avg[i] / wsum[i] : 0.0;
+            }
+
+            return avg;
+        }
+
+        /**
+         * Minimum of a cell field over each active region.
+         *
+         * \param[in] x Cell field, indexed by active cell.
+         *
+         * \return Region minima, ordered as activeRegions().
+         */
+        template <class Field>
+        std::vector<double>
+        minimum(const Field& x) const
+        {
+            return reduce(std::numeric_limits<double>::max(),
+                          [&x](const double m, const CellId c)
+                          { return std::min(m, double(x[c])); });
+        }
+
+        /**
+         * Maximum of a cell field over each active region.
+         *
+         * \param[in] x Cell field, indexed by active cell.
+         *
+         * \return Region maxima, ordered as activeRegions().
+         */
+        template <class Field>
+        std::vector<double>
+        maximum(const Field& x) const
+        {
+            return reduce(std::numeric_limits<double>::lowest(),
+                          [&x](const double m, const CellId c)
+                          { return std::max(m, double(x[c])); });
+        }
+
     private:
         /**
          * Copy of forward region mapping (cell-to-region).
@@ -122,9 +214,12 @@ namespace Opm
         /**
          * Reverse mapping (region-to-cell).
          */
-        struct {
+        struct Reverse {
             typedef typename std::vector<CellId>::size_type Pos;
 
+            bool                              dense;
+            RegionId                          min_id;
+            std::vector<Pos>                  dense_binid; /**< Bin of region min_id + k, or npos */
             std::unordered_map<RegionId, Pos> binid;
             std::vector<RegionId>             active;
 
@@ -132,12 +227,153 @@ namespace Opm
             std::vector<CellId> c;   /**< Region cells */
 
             /**
-             * Compute reverse mapping.  Standard linear insertion
-             * sort algorithm.
+             * Bin of region 'r' in 'p'.  False if 'r' is not an
+             * active region.
+             */
+            bool
+            bin(const RegionId r, Pos& i) const
+            {
+                if (dense) {
+                    const Pos npos = std::numeric_limits<Pos>::max();
+
+                    if (r < min_id) { return false; }
+
+                    const Pos k = static_cast<Pos>(r - min_id);
+                    if ((k >= dense_binid.size()) || (dense_binid[k] == npos)) {
+                        return false;
+                    }
+
+                    i = dense_binid[k];
+                    return true;
+                }
+
+                const auto id = binid.find(r);
+                if (id == binid.end()) {
+                    return false;
+                }
+
+                i = id->second;
+                return true;
+            }
+
+            /**
+             * Compute reverse mapping.
              */
             void
             init(const Region& reg)
             {
+                dense = initDense(reg);
+
+                if (! dense) {
+                    initSparse(reg);
+                }
+            }
+
+            /**
+             * Compute reverse mapping by a counting sort over a
+             * direct offset table.  Each thread counts and then
+             * places the cells of a contiguous chunk, which keeps
+             * the cells of each region in increasing order.
+             *
+             * Returns false, doing nothing, if the region IDs are not
+             * integers in a small range.
+             */
+            bool
+            initDense(const Region& reg)
+            {
+                const Pos n = reg.size();
+
+                if (! std::is_integral<RegionId>::value || (n == 0)) {
+                    return false;
+                }
+
+                RegionId lo = reg[0], hi = reg[0];
+                for (Pos i = 1; i < n; ++i) {
+                    lo = std::min(lo, reg[i]);
+                    hi = std::max(hi, reg[i]);
+                }
+
+                if (double(hi) - double(lo) >= double(std::max(n, Pos(1024)))) {
+                    return false;
+                }
+
+                const Pos span = static_cast<Pos>(hi - lo) + 1;
+                const Pos npos = std::numeric_limits<Pos>::max();
+
+                // Limit the per-thread counts to about one entry per cell.
+                int nthreads = 1;
+#ifdef _OPENMP
+                nthreads = std::max(1, std::min(omp_get_max_threads(),
+                                                static_cast<int>(std::min(n / span, Pos(1024)))));
+#endif
+
+                std::vector<Pos> count(nthreads * span, 0);
+
+                min_id = lo;
+                dense_binid.assign(span, npos);
+                binid.clear();
+
+#pragma omp parallel num_threads(nthreads)
+                {
+                    int t = 0, nt = 1;
+#ifdef _OPENMP
+                    t  = omp_get_thread_num();
+                    nt = omp_get_num_threads();
+#endif
+                    const Pos begin = (n *  t     ) / nt;
+                    const Pos end   = (n * (t + 1)) / nt;
+
+                    Pos* my_count = &count[t * span];
+                    for (Pos i = begin; i < end; ++i) {
+                        ++my_count[ static_cast<Pos>(reg[i] - lo) ];
+                    }
+
+#pragma omp barrier
+#pragma omp single
+                    {
+                        // Number the regions with cells in increasing
+                        // order, and turn the counts into the start
+                        // position of each thread within each region.
+                        active.clear();
+                        p.assign(1, 0);
+
+                        Pos pos = 0;
+                        for (Pos k = 0; k < span; ++k) {
+                            for (int tt = 0; tt < nt; ++tt) {
+                                const Pos cnt = count[tt*span + k];
+                                count[tt*span + k] = pos;
+                                pos += cnt;
+                            }
+
+                            if (pos != p.back()) {
+                                dense_binid[k] = active.size();
+                                active.push_back(static_cast<RegionId>(lo + k));
+                                p.push_back(pos);
+                            }
+                        }
+
+                        assert (pos == n);
+
+                        c.resize(n);
+                    }
+
+                    for (Pos i = begin; i < end; ++i) {
+                        c[ my_count[ static_cast<Pos>(reg[i] - lo) ]++ ] = i;
+                    }
+                }
+
+                return true;
+            }
+
+            /**
+             * Compute reverse mapping for general region IDs.
+             * Standard linear insertion sort algorithm.
+             */
+            void
+            initSparse(const Region& reg)
+            {
+                dense_binid.clear();
+
                 binid.clear();
                 for (const auto& r : reg) {
                     ++binid[r];
@@ -174,6 +410,34 @@ namespace Opm
                 p[0] = 0;
             }
         } rev_; /**< Reverse mapping instance */
+
+        /**
+         * Apply 'acc' to the cells of each active region, starting
+         * from 'init'.  Regions are processed in parallel, each by a
+         * single thread, so the results do not depend on the number
+         * of threads.
+         */
+        template <class Accumulate>
+        std::vector<double>
+        reduce(const double init, const Accumulate& acc) const
+        {
+            const auto& p = rev_.p;
+            const auto& c = rev_.c;
+
+            const int nreg = rev_.active.size();
+            std::vector<double> result(nreg, init);
+
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < nreg; ++i) {
+                double r = init;
+                for (auto k = p[i]; k < p[i + 1]; ++k) {
+                    r = acc(r, c[k]);
+                }
+                result[i] = r;
+            }
+
+            return result;
+        }
     };
 
 } // namespace Opm
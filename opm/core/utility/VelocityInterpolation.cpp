@@ -169,14 +169,24 @@ namespace Opm
     {
         const int n = bcmethod_.numCorners(cell);
         const int dim = grid_.dimensions;
-        bary_coord_.resize(n);
-        bcmethod_.cartToBary(cell, x, &bary_coord_[0]);
+        // Local storage for the barycentric coordinates, so that
+        // concurrent calls are safe. Only unusually complex cells
+        // need to allocate.
+        enum { MaxStackCorners = 32 };
+        double bary_stack[MaxStackCorners];
+        std::vector<double> bary_heap;
+        double* bary_coord = bary_stack;
+        if (n > MaxStackCorners) {
+            bary_heap.resize(n);
+            bary_coord = &bary_heap[0];
+        }
+        bcmethod_.cartToBary(cell, x, bary_coord);
         std::fill(v, v + dim, 0.0);
         const SparseTable<WachspressCoord::CornerInfo>& all_ci = bcmethod_.cornerInfo();
         for (int i = 0; i < n; ++i) {
             const int cid = all_ci[cell][i].corner_id;
             for (int dd = 0; dd < dim; ++dd) {
-                v[dd] += corner_velocity_[dim*cid + dd] * bary_coord_[i];
+                v[dd] += corner_velocity_[dim*cid + dd] * bary_coord[i];
             }
         }
     }
@@ -44,6 +44,7 @@ namespace Opm
         ///                    Must be array of length grid.dimensions.
         /// \param[out] v      Interpolated velocity.
         ///                    Must be array of length grid.dimensions.
+        /// Implementations must allow concurrent calls.
         virtual void interpolate(const int cell,
                                  const double* x,
                                  double* v) const = 0;
@@ -110,7 +111,6 @@ namespace Opm
     private:
         WachspressCoord bcmethod_;
         const UnstructuredGrid& grid_;
-        mutable std::vector<double> bary_coord_;
         std::vector<double> corner_velocity_; // size = dim * #corners
     };
 
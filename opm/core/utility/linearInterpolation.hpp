@@ -52,6 +52,58 @@ namespace Opm
     }
 
 
+    /// Remembers the table interval found by the previous lookup, so
+    /// that lookups walking monotonically through a table need not
+    /// search. A cursor is owned by the caller: use one per thread
+    /// and, preferably, one per table.
+    struct TableCursor
+    {
+        TableCursor() : interval(0) {}
+        int interval;
+    };
+
+
+    inline bool isTableInterval(const std::vector<double>& table, const int j,
+                                const double x, const bool ascend)
+    {
+        // True if tableIndex(table, x) is j, for a table with at
+        // least three entries. The first and last intervals extend
+        // to infinity.
+        const int n = table.size() - 1;
+        if (ascend) {
+            return (j == 0 || x >= table[j]) && (j == n - 1 || x < table[j + 1]);
+        } else {
+            return (j == 0 || x < table[j]) && (j == n - 1 || x >= table[j + 1]);
+        }
+    }
+
+
+    inline int tableIndex(const std::vector<double>& table, double x,
+                          TableCursor& cursor)
+    {
+        // Same result as tableIndex(table, x), but the interval of
+        // the previous lookup and the one following it are tried
+        // before searching.
+        const int n = table.size() - 1;
+        if (n < 2) {
+            return 0;
+        }
+        const bool ascend = (table[n] > table[0]);
+        const int j = cursor.interval;
+        if (j >= 0 && j < n) {
+            if (isTableInterval(table, j, x, ascend)) {
+                return j;
+            }
+            if (j + 1 < n && isTableInterval(table, j + 1, x, ascend)) {
+                cursor.interval = j + 1;
+                return j + 1;
+            }
+        }
+        cursor.interval = tableIndex(table, x);
+        return cursor.interval;
+    }
+
+
     inline double linearInterpolationDerivative(const std::vector<double>& xv,
                                                 const std::vector<double>& yv, double x)
     {
@@ -96,6 +148,75 @@ namespace Opm
 	return (yv[ix2] - yv[ix1])/(xv[ix2] - xv[ix1])*(x - xv[ix1]) + yv[ix1];
     }
 
+    inline double linearInterpolation(const std::vector<double>& xv,
+                                      const std::vector<double>& yv,
+                                      double x, TableCursor& cursor)
+    {
+        // Extrapolates if x is outside xv
+        int ix1 = tableIndex(xv, x, cursor);
+        int ix2 = ix1 + 1;
+        return (yv[ix2] - yv[ix1])/(xv[ix2] - xv[ix1])*(x - xv[ix1]) + yv[ix1];
+    }
+
+    inline double linearInterpolationDerivative(const std::vector<double>& xv,
+                                                const std::vector<double>& yv,
+                                                double x, TableCursor& cursor)
+    {
+        // Extrapolates if x is outside xv
+        int ix1 = tableIndex(xv, x, cursor);
+        int ix2 = ix1 + 1;
+        return (yv[ix2] - yv[ix1])/(xv[ix2] - xv[ix1]);
+    }
+
+    inline double linearInterpolationAndDerivative(const std::vector<double>& xv,
+                                                   const std::vector<double>& yv,
+                                                   double x, double& dydx)
+    {
+        // Value and derivative with a single lookup.
+        // Extrapolates if x is outside xv
+        int ix1 = tableIndex(xv, x);
+        int ix2 = ix1 + 1;
+        dydx = (yv[ix2] - yv[ix1])/(xv[ix2] - xv[ix1]);
+        return dydx*(x - xv[ix1]) + yv[ix1];
+    }
+
+    inline void linearInterpolation(const std::vector<double>& xv,
+                                    const std::vector<double>& yv,
+                                    const int num, const double* x,
+                                    double* y, double* dydx)
+    {
+        // Evaluates y[i] = f(x[i]) and, if dydx is non-null,
+        // dydx[i] = f'(x[i]) for num points, extrapolating outside
+        // xv. Each block of points is first located in the table,
+        // using a cursor, and then evaluated in loops without
+        // dependencies between iterations, which the compiler can
+        // vectorize.
+        const int block = 64;
+        int ix[block];
+        TableCursor cursor;
+        for (int start = 0; start < num; start += block) {
+            const int len = std::min(block, num - start);
+            const double* xb = x + start;
+            double* yb = y + start;
+            for (int i = 0; i < len; ++i) {
+                ix[i] = tableIndex(xv, xb[i], cursor);
+            }
+            if (dydx) {
+                double* db = dydx + start;
+                for (int i = 0; i < len; ++i) {
+                    const int j = ix[i];
+                    db[i] = (yv[j + 1] - yv[j])/(xv[j + 1] - xv[j]);
+                    yb[i] = db[i]*(xb[i] - xv[j]) + yv[j];
+                }
+            } else {
+                for (int i = 0; i < len; ++i) {
+                    const int j = ix[i];
+                    yb[i] = (yv[j + 1] - yv[j])/(xv[j + 1] - xv[j])*(xb[i] - xv[j]) + yv[j];
+                }
+            }
+        }
+    }
+
 
 
 } // namespace Opm
@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include <opm/core/wells/WellCollection.hpp>
+#include <opm/core/utility/Profiler.hpp>
 
 #include <opm/parser/eclipse/EclipseState/Schedule/Well.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/Group.hpp>
@@ -36,6 +37,7 @@ namespace Opm
         }
 
         roots_.push_back(createGroupWellsGroup(fieldGroup, timeStep, phaseUsage));
+        indexNode(roots_.back().get());
     }
 
     void WellCollection::addGroup(const Group& groupChild, std::string parent_name,
@@ -66,6 +68,7 @@ namespace Opm
         }
         parent_as_group->addChild(child);
         child->setParent(parent);
+        indexNode(child.get());
     }
 
     void WellCollection::addWell(const Well* wellChild, size_t timeStep, const PhaseUsage& phaseUsage) {
@@ -90,6 +93,7 @@ namespace Opm
         leaf_nodes_.push_back(static_cast<WellNode*>(child.get()));
 
         child->setParent(parent);
+        indexNode(child.get());
     }
 
     const std::vector<WellNode*>& WellCollection::getLeafNodes() const {
@@ -98,6 +102,10 @@ namespace Opm
 
     WellsGroupInterface* WellCollection::findNode(const std::string& name)
     {
+        auto indexed = node_index_.find(name);
+        if (indexed != node_index_.end()) {
+            return indexed->second;
+        }
 
         for (size_t i = 0; i < roots_.size(); i++) {
             WellsGroupInterface* result = roots_[i]->findGroup(name);
@@ -110,6 +118,10 @@ namespace Opm
 
     const WellsGroupInterface* WellCollection::findNode(const std::string& name) const
     {
+        auto indexed = node_index_.find(name);
+        if (indexed != node_index_.end()) {
+            return indexed->second;
+        }
 
         for (size_t i = 0; i < roots_.size(); i++) {
             WellsGroupInterface* result = roots_[i]->findGroup(name);
@@ -123,6 +135,11 @@ namespace Opm
 
     WellNode& WellCollection::findWellNode(const std::string& name) const
     {
+        auto indexed = node_index_.find(name);
+        if (indexed != node_index_.end() && indexed->second->isLeafNode()) {
+            return *static_cast<WellNode*>(indexed->second);
+        }
+
         auto well_node = std::find_if(leaf_nodes_.begin(), leaf_nodes_.end(),
                     [&] ( WellNode* w) {
                     return w->name() == name;
@@ -153,6 +170,7 @@ namespace Opm
         if (child_node->isLeafNode()) {
             leaf_nodes_.push_back(static_cast<WellNode*>(child_node.get()));
         }
+        indexNode(child_node.get());
 
     }
 
@@ -164,12 +182,20 @@ namespace Opm
         if (child_node->isLeafNode()) {
             leaf_nodes_.push_back(static_cast<WellNode*> (child_node.get()));
         }
+        indexNode(child_node.get());
+    }
+
+    // Keeps the first node added under a given name.
+    void WellCollection::indexNode(WellsGroupInterface* node)
+    {
+        node_index_.emplace(node->name(), node);
     }
 
     bool WellCollection::conditionsMet(const std::vector<double>& well_bhp,
                                        const std::vector<double>& well_reservoirrates_phase,
                                        const std::vector<double>& well_surfacerates_phase)
     {
+        ProfileScope scope("well_conditions");
         for (size_t i = 0; i < roots_.size(); i++) {
             WellPhasesSummed phases;
             if (!roots_[i]->conditionsMet(well_bhp,
@@ -190,6 +216,7 @@ namespace Opm
 
     void WellCollection::applyGroupControls()
     {
+        ProfileScope scope("well_group_controls");
         for (size_t i = 0; i < roots_.size(); ++i) {
             roots_[i]->applyProdGroupControls();
             roots_[i]->applyInjGroupControls();
@@ -209,6 +236,7 @@ namespace Opm
     void WellCollection::applyExplicitReinjectionControls(const std::vector<double>& well_reservoirrates_phase,
                                                           const std::vector<double>& well_surfacerates_phase)
     {
+        ProfileScope scope("well_reinjection_controls");
         for (size_t i = 0; i < roots_.size(); ++i) {
             roots_[i]->applyExplicitReinjectionControls(well_reservoirrates_phase, well_surfacerates_phase);
         }
@@ -218,6 +246,7 @@ namespace Opm
     void WellCollection::applyVREPGroupControls(const std::vector<double>& well_voidage_rates,
                                                 const std::vector<double>& conversion_coeffs)
     {
+        ProfileScope scope("well_vrep_controls");
         for (size_t i = 0; i < roots_.size(); ++i) {
             roots_[i]->applyVREPGroupControls(well_voidage_rates, conversion_coeffs);
         }
@@ -282,6 +311,7 @@ namespace Opm
 
     void WellCollection::updateWellTargets(const std::vector<double>& well_rates)
     {
+        ProfileScope scope("well_targets");
         if ( !needUpdateWellTargets() && groupTargetConverged(well_rates)) {
             return;
         }
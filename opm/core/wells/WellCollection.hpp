@@ -21,6 +21,8 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <opm/core/wells/WellsGroup.hpp>
 #include <opm/core/grid.h>
@@ -153,6 +155,13 @@ namespace Opm
         // This will be used to traverse the bottom nodes.
         std::vector<WellNode*> leaf_nodes_;
 
+        // Nodes added through this collection, by name, for fast lookup.
+        // Nodes only reachable through a subtree passed to addChild()
+        // are found by searching the trees.
+        std::unordered_map<std::string, WellsGroupInterface*> node_index_;
+
+        void indexNode(WellsGroupInterface* node);
+
         bool having_vrep_groups_ = false;
 
         bool group_control_active_ = false;
@@ -404,18 +404,23 @@ namespace Opm
     }
 
     void WellsManager::setupCompressedToCartesian(const int* global_cell, int number_of_cells,
-                                                  std::map<int,int>& cartesian_to_compressed ) {
+                                                  const int* cart_dims,
+                                                  std::vector<int>& cartesian_to_compressed ) {
         // global_cell is a map from compressed cells to Cartesian grid cells.
-        // We must make the inverse lookup.
+        // We must make the inverse lookup. The table is dense over the
+        // Cartesian grid, with -1 for inactive cells.
 
         if (global_cell) {
+            const int num_cartesian = cart_dims[0]*cart_dims[1]*cart_dims[2];
+            cartesian_to_compressed.assign(num_cartesian, -1);
             for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(global_cell[i], i));
+                cartesian_to_compressed[global_cell[i]] = i;
             }
         }
         else {
+            cartesian_to_compressed.resize(number_of_cells);
             for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(i, i));
+                cartesian_to_compressed[i] = i;
             }
         }
 
@@ -734,7 +739,7 @@ namespace Opm
 
     }
 
-    void WellsManager::setupGuideRates(std::vector< const Well* >& wells, const size_t timeStep, std::vector<WellData>& well_data, std::map<std::string, int>& well_names_to_index,
+    void WellsManager::setupGuideRates(std::vector< const Well* >& wells, const size_t timeStep, std::vector<WellData>& well_data, std::unordered_map<std::string, int>& well_names_to_index,
                                        const PhaseUsage& phaseUsage, const std::vector<double>& well_potentials)
     {
         const int np = phaseUsage.num_phases;
@@ -20,6 +20,7 @@
 #ifndef OPM_WELLSMANAGER_HEADER_INCLUDED
 #define OPM_WELLSMANAGER_HEADER_INCLUDED
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -168,7 +169,8 @@ namespace Opm
         // Disable copying and assignment.
         WellsManager(const WellsManager& other);
         WellsManager& operator=(const WellsManager& other);
-        static void setupCompressedToCartesian(const int* global_cell, int number_of_cells, std::map<int,int>& cartesian_to_compressed );
+        static void setupCompressedToCartesian(const int* global_cell, int number_of_cells, const int* cart_dims,
+                                               std::vector<int>& cartesian_to_compressed);
         void setupWellControls(std::vector<const Well*>& wells, size_t timeStep,
                                std::vector<std::string>& well_names, const PhaseUsage& phaseUsage,
                                const std::vector<int>& wells_on_proc,
@@ -183,16 +185,16 @@ namespace Opm
                                    std::vector<double>& dz,
                                    std::vector<std::string>& well_names,
                                    std::vector<WellData>& well_data,
-                                   std::map<std::string, int> & well_names_to_index,
+                                   std::unordered_map<std::string, int> & well_names_to_index,
                                    const PhaseUsage& phaseUsage,
-                                   const std::map<int,int>& cartesian_to_compressed,
+                                   const std::vector<int>& cartesian_to_compressed,
                                    const double* permeability,
                                    const NTG& ntg,
                                    std::vector<int>& wells_on_proc,
                                    const std::unordered_set<std::string>& deactivated_wells,
                                    const DynamicListEconLimited& list_econ_limited);
 
-        void setupGuideRates(std::vector<const Well*>& wells, const size_t timeStep, std::vector<WellData>& well_data, std::map<std::string, int>& well_names_to_index,
+        void setupGuideRates(std::vector<const Well*>& wells, const size_t timeStep, std::vector<WellData>& well_data, std::unordered_map<std::string, int>& well_names_to_index,
                              const PhaseUsage& phaseUsage, const std::vector<double>& well_potentials);
         // Data
         Wells* w_;
@@ -116,9 +116,9 @@ void WellsManager::createWellsFromSpecs(std::vector<const Well*>& wells, size_t
                                         std::vector<double>& dz,
                                         std::vector<std::string>& well_names,
                                         std::vector<WellData>& well_data,
-                                        std::map<std::string, int>& well_names_to_index,
+                                        std::unordered_map<std::string, int>& well_names_to_index,
                                         const PhaseUsage& phaseUsage,
-                                        const std::map<int,int>& cartesian_to_compressed,
+                                        const std::vector<int>& cartesian_to_compressed,
                                         const double* permeability,
                                         const NTG& ntg,
                                         std::vector<int>& wells_on_proc,
@@ -172,15 +172,15 @@ void WellsManager::createWellsFromSpecs(std::vector<const Well*>& wells, size_t
 
                     const int* cpgdim = cart_dims;
                     int cart_grid_indx = i + cpgdim[0]*(j + cpgdim[1]*k);
-                    std::map<int, int>::const_iterator cgit = cartesian_to_compressed.find(cart_grid_indx);
-                    if (cgit == cartesian_to_compressed.end()) {
+                    const int cell = (cart_grid_indx >= 0 && cart_grid_indx < int(cartesian_to_compressed.size()))
+                        ? cartesian_to_compressed[cart_grid_indx] : -1;
+                    if (cell < 0) {
                         OPM_MESSAGE("****Warning: Cell with i,j,k indices " << i << ' ' << j << ' '
                                     << k << " not found in grid. The completion will be igored (well = "
                                     << well->name() << ')');
                     }
                     else
                     {
-                        int cell = cgit->second;
                         // check if the connection is closed due to economic limits
                         if (!cells_connection_closed.empty()) {
                             const bool connection_found = std::find(cells_connection_closed.begin(),
@@ -354,8 +354,8 @@ WellsManager::init(const Opm::EclipseState& eclipseState,
         return;
     }
 
-    std::map<int,int> cartesian_to_compressed;
-    setupCompressedToCartesian(global_cell, number_of_cells,
+    std::vector<int> cartesian_to_compressed;
+    setupCompressedToCartesian(global_cell, number_of_cells, cart_dims,
                                cartesian_to_compressed);
 
     // Obtain phase usage data.
@@ -368,7 +368,7 @@ WellsManager::init(const Opm::EclipseState& eclipseState,
 
 
     // For easy lookup:
-    std::map<std::string, int> well_names_to_index;
+    std::unordered_map<std::string, int> well_names_to_index;
 
     const auto& schedule = eclipseState.getSchedule();
     auto wells           = schedule.getWells(timeStep);
@@ -0,0 +1,57 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPM_PRESSURETESTHELPERS_HEADER
+#define OPM_PRESSURETESTHELPERS_HEADER
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+
+#include <memory>
+#include <vector>
+
+/// Cartesian grid with a heterogeneous, anisotropic, diagonal
+/// permeability tensor in each cell.
+struct PermeableCartGrid
+{
+    PermeableCartGrid(const int nx, const int ny, const int nz)
+        : grid(create_grid_cart3d(nx, ny, nz), destroy_grid),
+          nc(grid->number_of_cells),
+          perm(9*nc, 0.0)
+    {
+        for (int c = 0; c < nc; ++c) {
+            perm[9*c + 0] = 1.0 + 0.1*(c % 7);
+            perm[9*c + 4] = 0.5 + 0.05*(c % 5);
+            perm[9*c + 8] = 0.1 + 0.01*(c % 3);
+        }
+    }
+
+    std::shared_ptr<UnstructuredGrid> grid;
+    int nc;
+    std::vector<double> perm;
+};
+
+/// Deleter that lets std::unique_ptr own an object of the C
+/// interfaces, which is released by the function Free.
+template <class T, void (*Free)(T*)>
+struct FreeWith
+{
+    void operator()(T* p) const { Free(p); }
+};
+
+#endif // OPM_PRESSURETESTHELPERS_HEADER
@@ -37,8 +37,6 @@
 
 using namespace Opm;
 
-#if BOOST_HEAP_AVAILABLE
-
 BOOST_AUTO_TEST_CASE(cartesian_2d_a)
 {
     const GridManager gm(2, 2);
@@ -90,11 +88,38 @@ BOOST_AUTO_TEST_CASE(cartesian_2d_b)
     }
 }
 
-#else // BOOST_HEAP_AVAILABLE is false
 
-BOOST_AUTO_TEST_CASE(dummy)
+BOOST_AUTO_TEST_CASE(cartesian_2d_symmetric)
 {
-    BOOST_CHECK(true);
-}
+    // Isotropic metric with a start cell in the centre, large enough
+    // that the accepted front moves away from the start cell.
+    const int n = 9;
+    const GridManager gm(n, n);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    AnisotropicEikonal2d ae(grid);
 
-#endif // BOOST_HEAP_AVAILABLE
+    std::vector<double> metric;
+    for (int cell = 0; cell < grid.number_of_cells; ++cell) {
+        const double m[] = { 1, 0, 0, 1 };
+        metric.insert(metric.end(), m, m + 4);
+    }
+    const int centre = n*n/2;
+    const std::vector<int> start = { centre };
+    std::vector<double> sol;
+    ae.solve(metric.data(), start, sol);
+    BOOST_REQUIRE_EQUAL(sol.size(), grid.number_of_cells);
+    BOOST_CHECK_EQUAL(sol[centre], 0.0);
+    BOOST_CHECK_CLOSE(sol[centre + n/2], n/2, 1e-8);
+    BOOST_CHECK_CLOSE(sol[0], (n/2)*std::sqrt(2.0), 1e-8);
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const int cell = i + n*j;
+            if (cell == centre) {
+                continue;
+            }
+            BOOST_CHECK_CLOSE(sol[cell], sol[j + n*i], 1e-8);
+            BOOST_CHECK_CLOSE(sol[cell], sol[(n - 1 - i) + n*j], 1e-8);
+            BOOST_CHECK_CLOSE(sol[cell], sol[i + n*(n - 1 - j)], 1e-8);
+        }
+    }
+}
@@ -0,0 +1,223 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE CoarseSysTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/msmfem/coarse_conn.h>
+#include <opm/core/pressure/msmfem/coarse_sys.h>
+#include <opm/core/pressure/msmfem/partition.h>
+
+#include "PressureTestHelpers.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Gaussian elimination with partial pivoting on a dense copy of
+    // the CSR matrix.  All storage is local, so concurrent calls are
+    // safe.
+    void denseSolve(struct CSRMatrix* A, double* b, double* x)
+    {
+        const int n = static_cast<int>(A->m);
+        std::vector<double> M(n*n, 0.0);
+        for (int i = 0; i < n; ++i) {
+            for (int k = A->ia[i]; k < A->ia[i + 1]; ++k) {
+                M[i*n + A->ja[k]] += A->sa[k];
+            }
+        }
+        std::vector<double> rhs(b, b + n);
+
+        for (int j = 0; j < n; ++j) {
+            int piv = j;
+            for (int i = j + 1; i < n; ++i) {
+                if (std::fabs(M[i*n + j]) > std::fabs(M[piv*n + j])) {
+                    piv = i;
+                }
+            }
+            if (piv != j) {
+                std::swap_ranges(&M[j*n], &M[j*n] + n, &M[piv*n]);
+                std::swap(rhs[j], rhs[piv]);
+            }
+            for (int i = j + 1; i < n; ++i) {
+                const double f = M[i*n + j] / M[j*n + j];
+                for (int k = j; k < n; ++k) {
+                    M[i*n + k] -= f * M[j*n + k];
+                }
+                rhs[i] -= f * rhs[j];
+            }
+        }
+        for (int i = n - 1; i >= 0; --i) {
+            double s = rhs[i];
+            for (int k = i + 1; k < n; ++k) {
+                s -= M[i*n + k] * x[k];
+            }
+            x[i] = s / M[i*n + i];
+        }
+    }
+
+    typedef std::unique_ptr<struct coarse_sys,
+                            FreeWith<struct coarse_sys, coarse_sys_destroy> > CoarseSysPtr;
+
+    // 8x6x2 grid partitioned into 2x2x1 coarse blocks.
+    struct CoarseProblem : PermeableCartGrid
+    {
+        CoarseProblem()
+            : PermeableCartGrid(8, 6, 2),
+              p(nc),
+              src(nc, 0.0),
+              totmob(nc)
+        {
+            const int fine_d[3]   = { 8, 6, 2 };
+            const int coarse_d[3] = { 2, 2, 1 };
+            std::vector<int> idx(nc);
+            for (int c = 0; c < nc; ++c) {
+                idx[c]    = c;
+                totmob[c] = 1.0 + 0.01*c;
+            }
+            partition_unif_idx(3, nc, fine_d, coarse_d, &idx[0], &p[0]);
+
+            ct.reset(coarse_topology_create(nc, grid->number_of_faces, 256,
+                                            &p[0], grid->face_cells));
+        }
+
+        std::vector<int> p;
+        std::vector<double> src;
+        std::vector<double> totmob;
+        std::unique_ptr<struct coarse_topology,
+                        FreeWith<struct coarse_topology, coarse_topology_destroy> > ct;
+
+        CoarseSysPtr construct(const std::vector<double>& mob, const bool parallel)
+        {
+            return CoarseSysPtr(parallel
+                                ? coarse_sys_construct_parallel(grid.get(), &p[0], ct.get(),
+                                                                &perm[0], &src[0], &mob[0],
+                                                                denseSolve)
+                                : coarse_sys_construct(grid.get(), &p[0], ct.get(),
+                                                       &perm[0], &src[0], &mob[0],
+                                                       denseSolve));
+        }
+    };
+
+    void checkSame(const CoarseProblem& s, const struct coarse_sys* a, const struct coarse_sys* b)
+    {
+        const int nb = s.ct->nblocks;
+        BOOST_REQUIRE_EQUAL(a->basis_pos[nb], b->basis_pos[nb]);
+        for (int i = 0; i < a->basis_pos[nb]; ++i) {
+            BOOST_CHECK_SMALL(a->basis[i] - b->basis[i], 1.0e-12);
+        }
+        BOOST_REQUIRE_EQUAL(a->cell_ip_pos[nb], b->cell_ip_pos[nb]);
+        for (int i = 0; i < a->cell_ip_pos[nb]; ++i) {
+            BOOST_CHECK_CLOSE(a->cell_ip[i], b->cell_ip[i], 1.0e-10);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (ParallelMatchesSerial)
+{
+    CoarseProblem s;
+    CoarseSysPtr serial   = s.construct(s.totmob, false);
+    CoarseSysPtr parallel = s.construct(s.totmob, true);
+    BOOST_REQUIRE(serial);
+    BOOST_REQUIRE(parallel);
+
+    checkSame(s, serial.get(), parallel.get());
+}
+
+
+BOOST_AUTO_TEST_CASE (UpdateMatchesRebuild)
+{
+    CoarseProblem s;
+    CoarseSysPtr sys = s.construct(s.totmob, false);
+    BOOST_REQUIRE(sys);
+
+    // Unchanged mobility: nothing to do.
+    BOOST_CHECK_EQUAL(coarse_sys_update(s.grid.get(), &s.p[0], s.ct.get(),
+                                        &s.perm[0], &s.src[0], &s.totmob[0],
+                                        1.0e-8, 0, denseSolve, sys.get()), 0);
+
+    // Change mobility in block 0 only.
+    std::vector<double> mob = s.totmob;
+    for (int c = 0; c < s.nc; ++c) {
+        if (s.p[c] == 0) {
+            mob[c] *= 3.0;
+        }
+    }
+
+    const int nbf = coarse_sys_update(s.grid.get(), &s.p[0], s.ct.get(),
+                                      &s.perm[0], &s.src[0], &mob[0],
+                                      1.0e-8, 1, denseSolve, sys.get());
+    BOOST_CHECK(nbf > 0);
+    BOOST_CHECK(nbf < s.ct->nfaces);
+
+    CoarseSysPtr rebuilt = s.construct(mob, false);
+    BOOST_REQUIRE(rebuilt);
+    checkSame(s, sys.get(), rebuilt.get());
+    for (int c = 0; c < s.nc; ++c) {
+        BOOST_CHECK_EQUAL(sys->totmob[c], mob[c]);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE (UpdateRecordsChangedBlocksOnly)
+{
+    CoarseProblem s;
+    CoarseSysPtr sys = s.construct(s.totmob, false);
+    BOOST_REQUIRE(sys);
+
+    // Block 0 changes, its neighbours drift below the tolerance.
+    std::vector<double> mob = s.totmob;
+    for (int c = 0; c < s.nc; ++c) {
+        mob[c] *= (s.p[c] == 0) ? 3.0 : (1.0 + 1.0e-4);
+    }
+
+    const int nbf = coarse_sys_update(s.grid.get(), &s.p[0], s.ct.get(),
+                                      &s.perm[0], &s.src[0], &mob[0],
+                                      1.0e-3, 0, denseSolve, sys.get());
+    BOOST_CHECK(nbf > 0);
+
+    for (int c = 0; c < s.nc; ++c) {
+        const double expected = (s.p[c] == 0) ? mob[c] : s.totmob[c];
+        BOOST_CHECK_EQUAL(sys->totmob[c], expected);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -70,4 +70,53 @@ BOOST_AUTO_TEST_CASE (cubic)
     BOOST_REQUIRE_CLOSE (interp.evaluate(4.0), 2., 0.00001);
 }
 
+BOOST_AUTO_TEST_CASE (batched)
+{
+    const int num_v = 5;
+    double xv[num_v] = {0.0, 0.5, 1.0, 2.0, 4.0};
+    double fv[num_v] = {0.0, 0.1, 0.5, 0.9, 1.0};
+    std::vector<double> x(xv, xv + num_v);
+    std::vector<double> f(fv, fv + num_v);
+    MonotCubicInterpolator interp(x, f);
+    BOOST_CHECK(interp.isStrictlyIncreasing());
+
+    // Sorted input, then unsorted input with repeats.
+    std::vector<double> xs;
+    for (int i = -10; i <= 50; ++i) {
+        xs.push_back(0.1*i);
+    }
+    for (int i = 0; i < 40; ++i) {
+        xs.push_back(0.37*((i*17) % 13) - 0.5);
+    }
+    std::vector<double> fs(xs.size());
+    interp.evaluate(&xs[0], &fs[0], xs.size());
+    for (std::vector<double>::size_type i = 0; i < xs.size(); ++i) {
+        BOOST_CHECK_EQUAL(fs[i], interp.evaluate(xs[i]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (flatareas)
+{
+    const int num_v = 6;
+    double xv[num_v] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    double fv[num_v] = {3.0, 3.0, 4.0, 5.0, 5.0, 5.0};
+    std::vector<double> x(xv, xv + num_v);
+    std::vector<double> f(fv, fv + num_v);
+
+    MonotCubicInterpolator chopped(x, f);
+    BOOST_CHECK(chopped.isMonotone());
+    BOOST_CHECK(!chopped.isStrictlyMonotone());
+    chopped.chopFlatEndpoints();
+    BOOST_REQUIRE_EQUAL(chopped.getSize(), 3);
+    BOOST_CHECK_EQUAL(chopped.getMinimumX().first, 2.0);
+    BOOST_CHECK_EQUAL(chopped.getMaximumX().first, 4.0);
+    BOOST_CHECK(chopped.isStrictlyIncreasing());
+
+    MonotCubicInterpolator shrunk(x, f);
+    shrunk.shrinkFlatAreas();
+    BOOST_REQUIRE_EQUAL(shrunk.getSize(), 3);
+    BOOST_CHECK_EQUAL(shrunk.get_xVector()[1], 3.0);
+    BOOST_CHECK(shrunk.isStrictlyIncreasing());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
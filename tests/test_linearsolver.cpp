@@ -123,6 +123,33 @@ void run_test(const Opm::parameter::ParameterGroup& param)
              &(x[0]));
 }
 
+// Solve a sequence of systems with the same pattern but changing
+// values using one solver object, as a time stepping loop would.
+void run_repeated_test(const Opm::parameter::ParameterGroup& param)
+{
+    int N=4;
+    auto mat = createLaplacian(N);
+    Opm::LinearSolverFactory ls(param);
+    for (int step = 0; step < 5; ++step) {
+        for (std::size_t i = 0; i < mat->data.size(); ++i) {
+            if (mat->data[i] > 0.0) {
+                mat->data[i] = 4.0 + 0.1*step;
+            }
+        }
+        std::vector<double> x, b;
+        createRandomVectors(N*N, x, b, *mat);
+        std::vector<double> exact(x);
+        std::fill(x.begin(), x.end(), 0.0);
+        auto rep = ls.solve(N*N, mat->data.size(), &(mat->rowStart[0]),
+                            &(mat->colIndex[0]), &(mat->data[0]), &(b[0]),
+                            &(x[0]));
+        BOOST_CHECK(rep.converged);
+        for (int i = 0; i < N*N; ++i) {
+            BOOST_CHECK_SMALL(x[i] - exact[i], 1e-5);
+        }
+    }
+}
+
 
 BOOST_AUTO_TEST_CASE(DefaultTest)
 {
@@ -132,6 +159,15 @@ BOOST_AUTO_TEST_CASE(DefaultTest)
     run_test(param);
 }
 
+#if HAVE_SUITESPARSE_UMFPACK_H
+BOOST_AUTO_TEST_CASE(UmfpackRepeatedTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("umfpack"));
+    run_repeated_test(param);
+}
+#endif
+
 #ifdef HAVE_DUNE_ISTL
 BOOST_AUTO_TEST_CASE(CGAMGTest)
 {
@@ -163,6 +199,16 @@ BOOST_AUTO_TEST_CASE(BiCGILUTest)
     run_test(param);
 }
 
+BOOST_AUTO_TEST_CASE(CGAMGReuseTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_type"), std::string("1"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_reuse_preconditioner"), std::string("3"));
+    run_repeated_test(param);
+}
+
 #if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
 BOOST_AUTO_TEST_CASE(FastAMGTest)
 {
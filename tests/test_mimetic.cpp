@@ -0,0 +1,210 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE MimeticTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/pressure/mimetic/hybsys.h>
+#include <opm/core/pressure/mimetic/mimetic.h>
+
+#include "PressureTestHelpers.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Inner products of a 6x5x3 grid.
+    struct IPProblem : PermeableCartGrid
+    {
+        IPProblem()
+            : PermeableCartGrid(6, 5, 3),
+              max_nconn(0),
+              ip_pos(nc + 1, 0)
+        {
+            for (int c = 0; c < nc; ++c) {
+                const int n = grid->cell_facepos[c + 1] - grid->cell_facepos[c];
+                max_nconn     = std::max(max_nconn, n);
+                ip_pos[c + 1] = ip_pos[c] + n*n;
+            }
+        }
+
+        // Reference: one cell at a time through mim_ip_simple().
+        std::vector<double> serialIP() const
+        {
+            const int d     = grid->dimensions;
+            const int lwork = 64 * (max_nconn * d);
+
+            std::vector<double> Binv(ip_pos[nc]);
+            std::vector<double> C(max_nconn*d), N(max_nconn*d), A(max_nconn);
+            std::vector<double> work(lwork);
+
+            for (int c = 0; c < nc; ++c) {
+                const int n = grid->cell_facepos[c + 1] - grid->cell_facepos[c];
+                for (int i = 0; i < n; ++i) {
+                    const int    f = grid->cell_faces[grid->cell_facepos[c] + i];
+                    const double s = (grid->face_cells[2*f] == c) ? 1.0 : -1.0;
+
+                    A[i] = grid->face_areas[f];
+                    for (int j = 0; j < d; ++j) {
+                        C[i + j*n] = grid->face_centroids[j + f*d]
+                                   - grid->cell_centroids[j + c*d];
+                        N[i + j*n] = s * grid->face_normals[j + f*d];
+                    }
+                }
+
+                mim_ip_simple(n, n, d, grid->cell_volumes[c],
+                              const_cast<double*>(&perm[c*d*d]),
+                              &C[0], &A[0], &N[0], &Binv[ip_pos[c]],
+                              &work[0], lwork);
+            }
+
+            return Binv;
+        }
+
+        std::vector<double> simpleAllIP()
+        {
+            std::vector<double> Binv(ip_pos[nc]);
+
+            const int ok =
+                mim_ip_simple_all(nc, grid->dimensions, max_nconn,
+                                  grid->cell_facepos, grid->cell_faces,
+                                  grid->face_cells, grid->face_centroids,
+                                  grid->face_normals, grid->face_areas,
+                                  grid->cell_centroids, grid->cell_volumes,
+                                  &perm[0], &Binv[0]);
+            BOOST_REQUIRE(ok);
+
+            return Binv;
+        }
+
+        int max_nconn;
+        std::vector<int> ip_pos;
+    };
+
+    typedef std::unique_ptr<struct hybsys, FreeWith<struct hybsys, hybsys_free> > HybsysPtr;
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (SimpleAllMatchesPerCellIP)
+{
+    IPProblem s;
+
+    const std::vector<double> ref  = s.serialIP();
+    const std::vector<double> Binv = s.simpleAllIP();
+
+    BOOST_REQUIRE_EQUAL(ref.size(), Binv.size());
+    for (std::size_t i = 0; i < ref.size(); ++i) {
+        BOOST_CHECK_EQUAL(Binv[i], ref[i]);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE (MobilityUpdate)
+{
+    IPProblem s;
+
+    const std::vector<double> Binv0 = s.simpleAllIP();
+    std::vector<double> totmob(s.nc), Binv(Binv0.size());
+    for (int c = 0; c < s.nc; ++c) {
+        totmob[c] = 0.5 + 0.1*c;
+    }
+
+    BOOST_REQUIRE(mim_ip_mobility_update(s.nc, s.grid->cell_facepos, &totmob[0],
+                                         &Binv0[0], &Binv[0]));
+
+    for (int c = 0; c < s.nc; ++c) {
+        for (int i = s.ip_pos[c]; i < s.ip_pos[c + 1]; ++i) {
+            BOOST_CHECK_EQUAL(Binv[i], totmob[c] * Binv0[i]);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE (SchurComplementMatchesDenseProducts)
+{
+    IPProblem s;
+
+    const std::vector<double> Binv = s.simpleAllIP();
+    const int* pconn     = s.grid->cell_facepos;
+    const int  nconn_tot = pconn[s.nc];
+
+    std::vector<double> C2(nconn_tot), P(s.nc);
+    for (int i = 0; i < nconn_tot; ++i) {
+        C2[i] = 1.0 + 0.25*(i % 3);
+    }
+    for (int c = 0; c < s.nc; ++c) {
+        P[c] = 0.01*c;
+    }
+
+    HybsysPtr symm(hybsys_allocate_symm(s.max_nconn, s.nc, nconn_tot));
+    HybsysPtr gen (hybsys_allocate_unsymm(s.max_nconn, s.nc, nconn_tot));
+    BOOST_REQUIRE(symm);
+    BOOST_REQUIRE(gen);
+    hybsys_init(s.max_nconn, symm.get());
+    hybsys_init(s.max_nconn, gen.get());
+
+    BOOST_REQUIRE(hybsys_schur_comp_symm(s.nc, pconn, &Binv[0], symm.get()));
+    BOOST_REQUIRE(hybsys_schur_comp_gen (s.nc, pconn, &Binv[0], &C2[0], &P[0], gen.get()));
+
+    // Reference: F1 = inv(B)*1, F2 = inv(B)*C2, L = sum(F), cell by cell.
+    for (int c = 0; c < s.nc; ++c) {
+        const int     n  = pconn[c + 1] - pconn[c];
+        const double* B  = &Binv[s.ip_pos[c]];
+        double        L1 = 0.0, L2 = 0.0;
+
+        for (int i = 0; i < n; ++i) {
+            double f1 = 0.0, f2 = 0.0;
+            for (int j = 0; j < n; ++j) {
+                f1 += B[i + j*n];
+                f2 += B[i + j*n] * C2[pconn[c] + j];
+            }
+
+            BOOST_CHECK_CLOSE(symm->F1[pconn[c] + i], f1, 1.0e-12);
+            BOOST_CHECK_CLOSE(gen ->F1[pconn[c] + i], f1, 1.0e-12);
+            BOOST_CHECK_CLOSE(gen ->F2[pconn[c] + i], f2, 1.0e-12);
+
+            L1 += f1;
+            L2 += f2;
+        }
+
+        BOOST_CHECK_CLOSE(symm->L[c], L1, 1.0e-12);
+        BOOST_CHECK_CLOSE(gen ->L[c], L2 - P[c], 1.0e-12);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
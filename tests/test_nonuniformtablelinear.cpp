@@ -89,3 +89,83 @@ BOOST_AUTO_TEST_CASE(table_operations)
     BOOST_CHECK_EQUAL(t1(0.0), 3.0);
     BOOST_CHECK(std::fabs(t1.derivative(0.0)  + 1.0/20.0) < 1e-11);
 }
+
+BOOST_AUTO_TEST_CASE(cursor_and_batched_lookup)
+{
+    // Nondecreasing table with a repeated x value.
+    double xva[] = { -1.0, 2.0, 2.0, 2.2, 3.0, 5.0 };
+    const int numvals = sizeof(xva)/sizeof(xva[0]);
+    std::vector<double> xv(xva, xva + numvals);
+    double yva[numvals] = { 1.0, 2.0, 2.5, 3.0, 4.0, 2.0 };
+    std::vector<double> yv(yva, yva + numvals);
+    Opm::NonuniformTableLinear<double> t1(xv, yv);
+
+    // Increasing, decreasing and scattered query points, including
+    // the table points themselves and points outside the domain.
+    std::vector<double> x;
+    for (int i = 0; i <= 80; ++i) {
+        x.push_back(-2.0 + 0.1*i);
+    }
+    for (int i = 80; i >= 0; --i) {
+        x.push_back(-2.0 + 0.1*i);
+    }
+    for (int i = 0; i < 40; ++i) {
+        x.push_back(-2.0 + 0.19*((7*i) % 41));
+    }
+    x.insert(x.end(), xv.begin(), xv.end());
+
+    const int n = x.size();
+    std::vector<double> y(n), dydx(n), y_only(n);
+    t1.evaluate(n, &x[0], &y[0], &dydx[0]);
+    t1.evaluate(n, &x[0], &y_only[0], 0);
+    Opm::TableCursor cursor, interp_cursor;
+    for (int i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(Opm::tableIndex(xv, x[i], cursor), Opm::tableIndex(xv, x[i]));
+        BOOST_CHECK_EQUAL(Opm::linearInterpolation(xv, yv, x[i], interp_cursor),
+                          Opm::linearInterpolation(xv, yv, x[i]));
+        BOOST_CHECK_EQUAL(Opm::linearInterpolationDerivative(xv, yv, x[i], interp_cursor),
+                          Opm::linearInterpolationDerivative(xv, yv, x[i]));
+        BOOST_CHECK_EQUAL(t1(x[i], cursor), t1(x[i]));
+        BOOST_CHECK_EQUAL(t1.derivative(x[i], cursor), t1.derivative(x[i]));
+        BOOST_CHECK_EQUAL(y[i], t1(x[i]));
+        BOOST_CHECK_EQUAL(y_only[i], t1(x[i]));
+        BOOST_CHECK_EQUAL(dydx[i], t1.derivative(x[i]));
+
+        double d = 0.0;
+        BOOST_CHECK_EQUAL(Opm::linearInterpolationAndDerivative(xv, yv, x[i], d), t1(x[i]));
+        BOOST_CHECK_EQUAL(d, t1.derivative(x[i]));
+    }
+
+    // Lookup and interpolation in a strictly decreasing table.
+    double xva_decr[] = { 5.0, 3.0, 2.2, 2.0, 0.5, -1.0 };
+    const int numvals_decr = sizeof(xva_decr)/sizeof(xva_decr[0]);
+    std::vector<double> xv_decr(xva_decr, xva_decr + numvals_decr);
+    double yva_decr[numvals_decr] = { 2.0, 4.0, 3.0, 2.5, 2.0, 1.0 };
+    std::vector<double> yv_decr(yva_decr, yva_decr + numvals_decr);
+    Opm::TableCursor cursor_decr, interp_cursor_decr;
+    for (int i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(Opm::tableIndex(xv_decr, x[i], cursor_decr),
+                          Opm::tableIndex(xv_decr, x[i]));
+        BOOST_CHECK_EQUAL(Opm::linearInterpolation(xv_decr, yv_decr, x[i], interp_cursor_decr),
+                          Opm::linearInterpolation(xv_decr, yv_decr, x[i]));
+        BOOST_CHECK_EQUAL(Opm::linearInterpolationDerivative(xv_decr, yv_decr, x[i], interp_cursor_decr),
+                          Opm::linearInterpolationDerivative(xv_decr, yv_decr, x[i]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(inverse)
+{
+    double xva[] = { 0.0, 1.0, 2.0, 4.0 };
+    const int numvals = sizeof(xva)/sizeof(xva[0]);
+    std::vector<double> xv(xva, xva + numvals);
+    double yva_incr[numvals] = { 1.0, 2.0, 4.0, 5.0 };
+    double yva_decr[numvals] = { 5.0, 4.0, 2.0, 1.0 };
+    const Opm::NonuniformTableLinear<double> incr(xv, std::vector<double>(yva_incr, yva_incr + numvals));
+    const Opm::NonuniformTableLinear<double> decr(xv, std::vector<double>(yva_decr, yva_decr + numvals));
+    for (int i = 0; i < numvals; ++i) {
+        BOOST_CHECK_CLOSE(incr.inverse(yva_incr[i]), xv[i], 1e-13);
+        BOOST_CHECK_CLOSE(decr.inverse(yva_decr[i]), xv[i], 1e-13);
+    }
+    BOOST_CHECK_CLOSE(incr.inverse(3.0), 1.5, 1e-13);
+    BOOST_CHECK_CLOSE(decr.inverse(3.0), 1.5, 1e-13);
+}
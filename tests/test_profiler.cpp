@@ -0,0 +1,173 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE ProfilerTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/utility/Profiler.hpp>
+#include <opm/core/simulator/SimulatorReport.hpp>
+
+#include <sstream>
+
+namespace
+{
+    void nestedWork()
+    {
+        Opm::ProfileScope outer("outer");
+        for (int i = 0; i < 3; ++i) {
+            Opm::ProfileScope inner("inner");
+            Opm::Profiler::instance().addIterations(2);
+        }
+        Opm::Profiler::instance().addAllocations(1);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (DisabledByDefault)
+{
+    Opm::Profiler& profiler = Opm::Profiler::instance();
+    BOOST_CHECK(!profiler.enabled());
+
+    nestedWork();
+    BOOST_CHECK(profiler.snapshot().children.empty());
+}
+
+
+BOOST_AUTO_TEST_CASE (Nesting)
+{
+    Opm::Profiler& profiler = Opm::Profiler::instance();
+    profiler.reset();
+    profiler.setEnabled(true);
+
+    nestedWork();
+    nestedWork();
+
+    Opm::ProfileNode root = profiler.snapshot();
+    BOOST_REQUIRE_EQUAL(root.children.size(), 1u);
+
+    const Opm::ProfileNode& outer = root.children[0];
+    BOOST_CHECK_EQUAL(outer.name, "outer");
+    BOOST_CHECK_EQUAL(outer.calls, 2);
+    BOOST_CHECK_EQUAL(outer.iterations, 0);
+    BOOST_CHECK_EQUAL(outer.allocations, 2);
+    BOOST_REQUIRE_EQUAL(outer.children.size(), 1u);
+
+    const Opm::ProfileNode& inner = outer.children[0];
+    BOOST_CHECK_EQUAL(inner.name, "inner");
+    BOOST_CHECK_EQUAL(inner.calls, 6);
+    BOOST_CHECK_EQUAL(inner.iterations, 12);
+    // The mean is total/calls, which may round below the minimum
+    // when all calls take the same time.
+    const double eps = 1.0e-12*inner.max_time;
+    BOOST_CHECK(inner.min_time <= inner.meanTime() + eps);
+    BOOST_CHECK(inner.meanTime() <= inner.max_time + eps);
+    BOOST_CHECK(inner.total_time <= outer.total_time);
+
+    profiler.setEnabled(false);
+    profiler.reset();
+}
+
+
+BOOST_AUTO_TEST_CASE (WorkerScopesFollowMasterPath)
+{
+    Opm::Profiler& profiler = Opm::Profiler::instance();
+    profiler.reset();
+    profiler.setEnabled(true);
+
+    // An earlier scope of the same name elsewhere in the tree must not
+    // receive the worker threads' records.
+    {
+        Opm::ProfileScope work("work");
+    }
+    int num_threads = 0;
+    {
+        Opm::ProfileScope region("region");
+#pragma omp parallel
+        {
+            Opm::ProfileScope work("work");
+#pragma omp atomic
+            ++num_threads;
+        }
+    }
+    profiler.setEnabled(false);
+
+    Opm::ProfileNode root = profiler.snapshot();
+    BOOST_REQUIRE_EQUAL(root.children.size(), 2u);
+    BOOST_CHECK_EQUAL(root.children[0].name, "work");
+    BOOST_CHECK_EQUAL(root.children[0].calls, 1);
+
+    const Opm::ProfileNode& region = root.children[1];
+    BOOST_CHECK_EQUAL(region.name, "region");
+    BOOST_CHECK_EQUAL(region.calls, 1);
+    BOOST_REQUIRE_EQUAL(region.children.size(), 1u);
+    BOOST_CHECK_EQUAL(region.children[0].name, "work");
+    BOOST_CHECK_EQUAL(region.children[0].calls, num_threads);
+
+    profiler.reset();
+}
+
+
+BOOST_AUTO_TEST_CASE (Report)
+{
+    Opm::Profiler& profiler = Opm::Profiler::instance();
+    profiler.reset();
+    profiler.setEnabled(true);
+
+    Opm::SimulatorReport total;
+    for (int step = 0; step < 2; ++step) {
+        nestedWork();
+        Opm::SimulatorReport step_report;
+        step_report.collectProfile();
+        total += step_report;
+    }
+    profiler.setEnabled(false);
+
+    BOOST_CHECK(profiler.snapshot().children.empty());
+    Opm::ProfileNode* inner = total.profile.find("inner");
+    BOOST_REQUIRE(inner != 0);
+    BOOST_CHECK_EQUAL(inner->calls, 6);
+
+    std::ostringstream tree;
+    total.reportProfile(tree);
+    BOOST_CHECK(tree.str().find("  inner") != std::string::npos);
+
+    std::ostringstream json;
+    total.reportProfileJson(json);
+    BOOST_CHECK(json.str().find("\"name\": \"outer\"") != std::string::npos);
+    BOOST_CHECK(json.str().find("\"iterations\": 12") != std::string::npos);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -152,4 +152,65 @@ BOOST_AUTO_TEST_CASE (NonConsecutive)
 }
 
 
+BOOST_AUTO_TEST_CASE (SparseIds)
+{
+    // Region IDs spread too widely for a direct offset table.
+    //                           0        1  2        3   4
+    std::vector<int> regions = { 1000000, 5, 1000000, -3, 5 };
+
+    Opm::RegionMapping<> rm(regions);
+
+    BOOST_CHECK_EQUAL(rm.activeRegions().size(), 3u);
+
+    const std::vector<int> expect_big = { 0, 2 };
+    const std::vector<int> expect_5   = { 1, 4 };
+    const std::vector<int> expect_neg = { 3 };
+
+    const auto& big = rm.cells(1000000);
+    const auto& r5  = rm.cells(5);
+    const auto& neg = rm.cells(-3);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(big.begin(), big.end(),
+                                  expect_big.begin(), expect_big.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(r5.begin(), r5.end(),
+                                  expect_5.begin(), expect_5.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(neg.begin(), neg.end(),
+                                  expect_neg.begin(), expect_neg.end());
+
+    BOOST_CHECK(rm.cells(0).empty());
+}
+
+
+BOOST_AUTO_TEST_CASE (Reductions)
+{
+    std::vector<int>    regions = { 2,   5,   2,   4,   2,   7,   6,   3,   6   };
+    std::vector<double> press   = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0 };
+    std::vector<double> pv      = { 1.0, 1.0, 2.0, 1.0, 1.0, 1.0, 0.0, 1.0, 0.0 };
+
+    Opm::RegionMapping<> rm(regions);
+
+    // Small integer IDs: active regions in increasing order.
+    const std::vector<int> expect_regions = { 2, 3, 4, 5, 6, 7 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(rm.activeRegions().begin(), rm.activeRegions().end(),
+                                  expect_regions.begin(), expect_regions.end());
+
+    const std::vector<double> sum  = rm.sum(press);
+    const std::vector<double> avg  = rm.weightedAverage(press, pv);
+    const std::vector<double> pmin = rm.minimum(press);
+    const std::vector<double> pmax = rm.maximum(press);
+
+    const std::vector<double> expect_sum = { 9.0, 8.0, 4.0, 2.0, 16.0, 6.0 };
+    const std::vector<double> expect_avg = { 3.0, 8.0, 4.0, 2.0,  0.0, 6.0 };
+    const std::vector<double> expect_min = { 1.0, 8.0, 4.0, 2.0,  7.0, 6.0 };
+    const std::vector<double> expect_max = { 5.0, 8.0, 4.0, 2.0,  9.0, 6.0 };
+
+    for (decltype(sum.size()) i = 0; i < expect_sum.size(); ++i) {
+        BOOST_CHECK_CLOSE(sum[i], expect_sum[i], 1.0e-12);
+        BOOST_CHECK_SMALL(avg[i] - expect_avg[i], 1.0e-12);
+        BOOST_CHECK_EQUAL(pmin[i], expect_min[i]);
+        BOOST_CHECK_EQUAL(pmax[i], expect_max[i]);
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
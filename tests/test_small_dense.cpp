@@ -0,0 +1,139 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE SmallDense
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/linalg/small_dense.h>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Column major test matrix of size n, diagonally dominant.
+    std::vector<double> testMatrix(const int n)
+    {
+        std::vector<double> A(n*n);
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                A[i + n*j] = (i == j) ? 4.0 + i : 0.5*(i + 1) - 0.25*j;
+            }
+        }
+        return A;
+    }
+
+    // Reference product C = A*B, A is n-by-k, B is k-by-m.
+    std::vector<double> reference(const int n, const int k, const int m,
+                                  const std::vector<double>& A,
+                                  const std::vector<double>& B)
+    {
+        std::vector<double> C(n*m, 0.0);
+        for (int j = 0; j < m; ++j) {
+            for (int l = 0; l < k; ++l) {
+                for (int i = 0; i < n; ++i) {
+                    C[i + n*j] += A[i + n*l]*B[l + k*j];
+                }
+            }
+        }
+        return C;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (Products)
+{
+    const int ncol = 5;
+    for (int n = 1; n <= 3; ++n) {
+        const std::vector<double> A = testMatrix(n);
+        std::vector<double> B(n*ncol);
+        for (int i = 0; i < n*ncol; ++i) {
+            B[i] = 1.0 + 0.1*i*i;
+        }
+
+        const std::vector<double> C_ref = reference(n, n, ncol, A, B);
+        std::vector<double> C(n*ncol);
+        small_dense_matmat(n, ncol, &A[0], &B[0], &C[0]);
+        for (int i = 0; i < n*ncol; ++i) {
+            BOOST_CHECK_CLOSE(C[i], C_ref[i], 1.0e-12);
+        }
+
+        std::vector<double> B_inplace = B;
+        small_dense_matmat_inplace(n, ncol, &A[0], &B_inplace[0]);
+        for (int i = 0; i < n*ncol; ++i) {
+            BOOST_CHECK_CLOSE(B_inplace[i], C_ref[i], 1.0e-12);
+        }
+
+        // Rectangular: B (n-by-ncol) times a vector.
+        std::vector<double> x(ncol);
+        for (int j = 0; j < ncol; ++j) {
+            x[j] = 0.5 - j;
+        }
+        const std::vector<double> y_ref = reference(n, ncol, 1, B, x);
+        std::vector<double> y(n);
+        small_dense_matvec(n, ncol, &B[0], &x[0], &y[0]);
+        for (int i = 0; i < n; ++i) {
+            BOOST_CHECK_CLOSE(y[i], y_ref[i], 1.0e-12);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE (Inverse)
+{
+    for (int n = 1; n <= 3; ++n) {
+        BOOST_CHECK(small_dense_supported(n));
+
+        const std::vector<double> A = testMatrix(n);
+        std::vector<double> Ainv(n*n);
+        BOOST_REQUIRE_EQUAL(small_dense_invert(n, &A[0], &Ainv[0]), 0);
+
+        const std::vector<double> I = reference(n, n, n, A, Ainv);
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                BOOST_CHECK_SMALL(I[i + n*j] - ((i == j) ? 1.0 : 0.0), 1.0e-14);
+            }
+        }
+    }
+
+    BOOST_CHECK(!small_dense_supported(4));
+
+    const double singular[4] = { 1.0, 2.0, 2.0, 4.0 };
+    double inv[4];
+    BOOST_CHECK(small_dense_invert(2, singular, inv) != 0);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
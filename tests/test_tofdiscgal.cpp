@@ -0,0 +1,188 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE TofDiscGalTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/flowdiagnostics/TofDiscGalReorder.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+    // Flow along the x rows of a 6x4x3 grid, from a source at one end
+    // of each row to a sink at the other. Neighbouring rows flow in
+    // opposite directions, so faces are crossed from their first as
+    // well as from their second cell, and each pair of rows is joined
+    // at both ends into a loop which the solver handles as one
+    // multi-cell component.
+    struct RowFlow
+    {
+        enum { nx = 6, ny = 4, nz = 3 };
+
+        RowFlow()
+            : grid(create_grid_cart3d(nx, ny, nz), destroy_grid),
+              flux(grid->number_of_faces, 0.0),
+              porevol(grid->number_of_cells),
+              src(grid->number_of_cells, 0.0)
+        {
+            const double q = 0.5;   // circulation around a pair of rows
+            std::vector<int> heads[2];
+            for (int k = 0; k < nz; ++k) {
+                for (int j = 0; j < ny; ++j) {
+                    const double rate = 1.0 + 0.25*((j + ny*k) % 3);
+                    const bool forward = (j % 2 == 0);
+                    const int first = cell(0, j, k);
+                    const int last  = cell(nx - 1, j, k);
+                    src[forward ? first : last] =  rate;
+                    src[forward ? last : first] = -rate;
+                    heads[j % 2].push_back(forward ? first : last);
+                    for (int i = 0; i + 1 < nx; ++i) {
+                        setFlux(cell(i, j, k), cell(i + 1, j, k),
+                                forward ? rate + q : -(rate + q));
+                    }
+                    if (forward) {
+                        setFlux(cell(nx - 1, j, k), cell(nx - 1, j + 1, k),  q);
+                        setFlux(cell(0, j, k),      cell(0, j + 1, k),      -q);
+                    }
+                }
+            }
+            for (int c = 0; c < grid->number_of_cells; ++c) {
+                porevol[c] = 0.2*grid->cell_volumes[c];
+            }
+            for (int t = 0; t < 2; ++t) {
+                tracerheads.appendRow(heads[t].begin(), heads[t].end());
+            }
+        }
+
+        static int cell(const int i, const int j, const int k)
+        {
+            return i + nx*(j + ny*k);
+        }
+
+        // Flux from cell c1 to its neighbour c2.
+        void setFlux(const int c1, const int c2, const double value)
+        {
+            for (int i = grid->cell_facepos[c1]; i < grid->cell_facepos[c1 + 1]; ++i) {
+                const int f = grid->cell_faces[i];
+                const int* fc = &grid->face_cells[2*f];
+                if (fc[0] == c1 && fc[1] == c2) {
+                    flux[f] = value;
+                } else if (fc[0] == c2 && fc[1] == c1) {
+                    flux[f] = -value;
+                }
+            }
+        }
+
+        struct Solution
+        {
+            std::vector<double> tof;
+            std::vector<double> tof_with_tracer;
+            std::vector<double> tracer;
+        };
+
+        Solution solve(const bool use_cvi, const bool use_tensorial_basis,
+                       const bool use_cache, const bool use_multithreading) const
+        {
+            Opm::parameter::ParameterGroup param;
+            param.insertParameter("dg_degree", "1");
+            param.insertParameter("use_cvi", use_cvi ? "true" : "false");
+            param.insertParameter("use_tensorial_basis", use_tensorial_basis ? "true" : "false");
+            param.insertParameter("use_quadrature_cache", use_cache ? "true" : "false");
+            param.insertParameter("use_multithreading", use_multithreading ? "true" : "false");
+            Opm::TofDiscGalReorder solver(*grid, param);
+
+            Solution s;
+            solver.solveTof(&flux[0], &porevol[0], &src[0], s.tof);
+            solver.solveTofTracer(&flux[0], &porevol[0], &src[0], tracerheads,
+                                  s.tof_with_tracer, s.tracer);
+            return s;
+        }
+
+        std::shared_ptr<UnstructuredGrid> grid;
+        std::vector<double> flux;
+        std::vector<double> porevol;
+        std::vector<double> src;
+        Opm::SparseTable<int> tracerheads;
+    };
+
+    void checkClose(const std::vector<double>& a, const std::vector<double>& ref)
+    {
+        BOOST_REQUIRE_EQUAL(a.size(), ref.size());
+        for (std::size_t i = 0; i < ref.size(); ++i) {
+            BOOST_CHECK_SMALL(a[i] - ref[i], 1.0e-10*(1.0 + std::fabs(ref[i])));
+        }
+    }
+
+    void checkSame(const RowFlow::Solution& a, const RowFlow::Solution& ref)
+    {
+        checkClose(a.tof, ref.tof);
+        checkClose(a.tof_with_tracer, ref.tof_with_tracer);
+        checkClose(a.tracer, ref.tracer);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (QuadratureCacheAndThreadsMatchReference)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    RowFlow problem;
+    for (int use_cvi = 0; use_cvi < 2; ++use_cvi) {
+        for (int tensorial = 0; tensorial < 2; ++tensorial) {
+            BOOST_TEST_MESSAGE("use_cvi = " << use_cvi << ", tensorial basis = " << tensorial);
+            // Uncached quadrature, single thread.
+            const RowFlow::Solution ref = problem.solve(use_cvi, tensorial, false, false);
+            checkSame(problem.solve(use_cvi, tensorial, true,  false), ref);
+            checkSame(problem.solve(use_cvi, tensorial, false, true ), ref);
+            checkSame(problem.solve(use_cvi, tensorial, true,  true ), ref);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
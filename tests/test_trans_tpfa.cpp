@@ -0,0 +1,136 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE TransTpfaTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+
+#include "PressureTestHelpers.hpp"
+
+#include <vector>
+
+namespace
+{
+    // Transmissibilities of a 7x5x3 grid.
+    struct TransProblem : PermeableCartGrid
+    {
+        TransProblem()
+            : PermeableCartGrid(7, 5, 3),
+              nf(grid->number_of_faces),
+              totmob(nc),
+              htrans(grid->cell_facepos[nc]),
+              trans(nf)
+        {
+            for (int c = 0; c < nc; ++c) {
+                totmob[c] = 0.5 + 0.02*c;
+            }
+
+            tpfa_htrans_compute(grid.get(), &perm[0], &htrans[0]);
+            tpfa_trans_compute (grid.get(), &htrans[0], &trans[0]);
+        }
+
+        // Reference: accumulate half-face contributions cell by cell.
+        std::vector<double> serialTrans(const double* mob) const
+        {
+            std::vector<double> t(nf, 0.0);
+            for (int c = 0; c < nc; ++c) {
+                for (int i = grid->cell_facepos[c]; i < grid->cell_facepos[c + 1]; ++i) {
+                    t[grid->cell_faces[i]] += 1.0 / ((mob ? mob[c] : 1.0) * htrans[i]);
+                }
+            }
+            for (int f = 0; f < nf; ++f) {
+                t[f] = 1.0 / t[f];
+            }
+            return t;
+        }
+
+        int nf;
+        std::vector<double> totmob;
+        std::vector<double> htrans;
+        std::vector<double> trans;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (TransMatchesHalfFaceSum)
+{
+    TransProblem s;
+
+    const std::vector<double> ref = s.serialTrans(0);
+    for (int f = 0; f < s.nf; ++f) {
+        BOOST_CHECK_EQUAL(s.trans[f], ref[f]);
+    }
+
+    std::vector<double> eff(s.nf);
+    tpfa_eff_trans_compute(s.grid.get(), &s.totmob[0], &s.htrans[0], &eff[0]);
+
+    const std::vector<double> eff_ref = s.serialTrans(&s.totmob[0]);
+    for (int f = 0; f < s.nf; ++f) {
+        BOOST_CHECK_EQUAL(eff[f], eff_ref[f]);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE (UpdateMatchesRecompute)
+{
+    TransProblem s;
+
+    // Change the permeability of a few scattered cells.
+    const int cells[] = { 0, 17, 52, s.nc - 1 };
+    const int ncells  = sizeof cells / sizeof cells[0];
+    for (int k = 0; k < ncells; ++k) {
+        for (int j = 0; j < 9; j += 4) {
+            s.perm[9*cells[k] + j] *= 10.0;
+        }
+    }
+
+    tpfa_htrans_update(s.grid.get(), &s.perm[0], ncells, cells, &s.htrans[0]);
+    tpfa_trans_update (s.grid.get(), &s.htrans[0], ncells, cells, &s.trans[0]);
+
+    std::vector<double> htrans(s.htrans.size()), trans(s.nf);
+    tpfa_htrans_compute(s.grid.get(), &s.perm[0], &htrans[0]);
+    tpfa_trans_compute (s.grid.get(), &htrans[0], &trans[0]);
+
+    for (std::size_t i = 0; i < htrans.size(); ++i) {
+        BOOST_CHECK_EQUAL(s.htrans[i], htrans[i]);
+    }
+    for (int f = 0; f < s.nf; ++f) {
+        BOOST_CHECK_EQUAL(s.trans[f], trans[f]);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
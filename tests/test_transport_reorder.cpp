@@ -0,0 +1,210 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE TransportReorderTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+/* --- our own headers --- */
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/props/IncompPropertiesInterface.hpp>
+#include <opm/core/simulator/TwophaseState.hpp>
+#include <opm/core/transport/reorder/TransportSolverTwophaseReorder.hpp>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Saturations at which setTabulatedFractionalFlow() samples the
+    // relative permeability curves to group cells.
+    const int num_samples = 11;
+    const double sample_sat[num_samples] = { 0.0, 0.013, 0.1, 0.2, 0.31, 0.5,
+                                             0.63, 0.8, 0.9, 0.987, 1.0 };
+
+    // Two saturation regions, split at cell 'split'.  Region 0 has
+    // quadratic curves, region 1 multiplies the water curve by
+    // (1 + a*P(s)) where P vanishes at all the sample saturations, so
+    // the two regions are indistinguishable from the samples alone.
+    class TwoRegionProps : public Opm::IncompPropertiesInterface
+    {
+    public:
+        TwoRegionProps(const int num_cells, const int split)
+            : num_cells_(num_cells), split_(split), a_(1.0)
+        {
+            visc_[0] = 1.0;
+            visc_[1] = 5.0;
+            double pmax = 0.0;
+            for (int i = 0; i <= 1000; ++i) {
+                pmax = std::max(pmax, std::fabs(poly(i/1000.0)));
+            }
+            a_ = 0.3/pmax;
+        }
+
+        int numDimensions() const { return 2; }
+        int numCells() const { return num_cells_; }
+        const double* porosity() const { return 0; }
+        const double* permeability() const { return 0; }
+        int numPhases() const { return 2; }
+        const double* viscosity() const { return visc_; }
+        const double* density() const { return 0; }
+        const double* surfaceDensity() const { return 0; }
+
+        void relperm(const int n, const double* s, const int* cells,
+                     double* kr, double* dkrds) const
+        {
+            for (int i = 0; i < n; ++i) {
+                const double sw = s[2*i];
+                const double so = s[2*i + 1];
+                double m = 1.0, dm = 0.0;
+                if (cells[i] >= split_) {
+                    m  = 1.0 + a_*poly(sw);
+                    dm = a_*dpoly(sw);
+                }
+                kr[2*i]     = sw*sw*m;
+                kr[2*i + 1] = so*so;
+                if (dkrds) {
+                    dkrds[4*i + 0] = 2.0*sw*m + sw*sw*dm;
+                    dkrds[4*i + 1] = 0.0;
+                    dkrds[4*i + 2] = 0.0;
+                    dkrds[4*i + 3] = 2.0*so;
+                }
+            }
+        }
+
+        void capPress(const int n, const double*, const int*,
+                      double* pc, double* dpcds) const
+        {
+            for (int i = 0; i < 2*n; ++i) {
+                pc[i] = 0.0;
+            }
+            if (dpcds) {
+                for (int i = 0; i < 4*n; ++i) {
+                    dpcds[i] = 0.0;
+                }
+            }
+        }
+
+        void satRange(const int n, const int*, double* smin, double* smax) const
+        {
+            for (int i = 0; i < 2*n; ++i) {
+                smin[i] = 0.0;
+                smax[i] = 1.0;
+            }
+        }
+
+    private:
+        static double poly(const double s)
+        {
+            double p = 1.0;
+            for (int k = 0; k < num_samples; ++k) {
+                p *= s - sample_sat[k];
+            }
+            return p;
+        }
+
+        static double dpoly(const double s)
+        {
+            double dp = 0.0;
+            for (int k = 0; k < num_samples; ++k) {
+                double t = 1.0;
+                for (int j = 0; j < num_samples; ++j) {
+                    if (j != k) {
+                        t *= s - sample_sat[j];
+                    }
+                }
+                dp += t;
+            }
+            return dp;
+        }
+
+        int num_cells_;
+        int split_;
+        double a_;
+        double visc_[2];
+    };
+
+    // One step of water injection through a row of cells, with or
+    // without tabulated fractional flow.
+    std::vector<double> injectionStep(const int num_points)
+    {
+        const int nx = 40;
+        std::shared_ptr<UnstructuredGrid> grid(create_grid_cart2d(nx, 1, 1.0, 1.0),
+                                               destroy_grid);
+        TwoRegionProps props(nx, nx/2);
+
+        Opm::TransportSolverTwophaseReorder solver(*grid, props, 0, 1.0e-10, 30);
+        if (num_points > 0) {
+            solver.setTabulatedFractionalFlow(num_points, 1.0e-2);
+        }
+
+        Opm::TwophaseState state(grid->number_of_cells, grid->number_of_faces);
+        std::vector<double>& sat  = state.saturation();
+        std::vector<double>& flux = state.faceflux();
+        for (int c = 0; c < nx; ++c) {
+            sat[2*c]     = 0.1;
+            sat[2*c + 1] = 0.9;
+        }
+        for (int f = 0; f < grid->number_of_faces; ++f) {
+            const int* fc = &grid->face_cells[2*f];
+            const bool x_face = grid->face_normals[2*f] != 0.0;
+            flux[f] = (x_face && fc[0] >= 0 && fc[1] >= 0) ? 1.0 : 0.0;
+        }
+        std::vector<double> pv(nx, 1.0), src(nx, 0.0);
+        src[0]      =  1.0;
+        src[nx - 1] = -1.0;
+
+        solver.solve(&pv[0], &src[0], 10.0, state);
+
+        return sat;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+
+BOOST_AUTO_TEST_CASE (TabulationChecksEveryCell)
+{
+    const std::vector<double> exact     = injectionStep(0);
+    const std::vector<double> tabulated = injectionStep(2001);
+
+    // Cells of both regions share a group, so the region 1 cells must
+    // fail the accuracy check and be evaluated exactly.
+    BOOST_REQUIRE_EQUAL(exact.size(), tabulated.size());
+    for (std::size_t i = 0; i < exact.size(); ++i) {
+        BOOST_CHECK_SMALL(tabulated[i] - exact[i], 1.0e-5);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()